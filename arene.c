@@ -0,0 +1,125 @@
+#include "arene.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define TAILLE_BLOC_DEFAUT ((size_t)64 << 10)
+
+// un bloc projeté : l'entete est au début, les données suivent.
+typedef struct Bloc {
+    struct Bloc *suivant;
+    size_t taille;       // taille projetée, entete compris
+    size_t utilise;      // premier octet libre (depuis le début du bloc)
+} Bloc;
+
+struct Arene {
+    Bloc *blocs;          // bloc partagé courant en tete, puis tous les autres
+    size_t tailleBloc;
+    size_t utilises;
+    size_t reserves;
+};
+
+static size_t taillePage(void) {
+    static size_t page = 0;
+    if (page == 0) {
+        long p = sysconf(_SC_PAGESIZE);
+        page = p > 0 ? (size_t)p : 4096;
+    }
+    return page;
+}
+
+static Bloc *nouveauBloc(size_t taille, int peupler) {
+    size_t page = taillePage();
+    taille = (taille + page - 1) & ~(page - 1);
+    void *m = mmap(NULL, taille, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | (peupler ? MAP_POPULATE : 0), -1, 0);
+    if (m == MAP_FAILED) {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+    Bloc *b = m;
+    b->suivant = NULL;
+    b->taille = taille;
+    b->utilise = sizeof(Bloc);
+    return b;
+}
+
+Arene *creerArene(size_t tailleBloc) {
+    if (tailleBloc == 0) tailleBloc = TAILLE_BLOC_DEFAUT;
+    // l'arène elle meme est la premiere alocation de son premier bloc.
+    Bloc *b = nouveauBloc(tailleBloc, 0);
+    Arene *a = (Arene *)((char *)b + b->utilise);
+    b->utilise += sizeof(Arene);
+    a->blocs = b;
+    a->tailleBloc = b->taille;
+    a->utilises = 0;
+    a->reserves = b->taille;
+    return a;
+}
+
+// place dans le bloc b, ou NULL si il est trop plein.
+static void *prendre(Bloc *b, size_t taille, size_t alignement) {
+    uintptr_t debut = (uintptr_t)b + b->utilise;
+    debut = (debut + alignement - 1) & ~(uintptr_t)(alignement - 1);
+    if (debut + taille > (uintptr_t)b + b->taille) return NULL;
+    b->utilise = debut + taille - (uintptr_t)b;
+    return (void *)debut;
+}
+
+void *allouerArene(Arene *a, size_t taille, size_t alignement) {
+    if (alignement == 0) alignement = sizeof(void *);
+    a->utilises += taille;
+    void *p = prendre(a->blocs, taille, alignement);
+    if (p) return p;
+    size_t besoin = sizeof(Bloc) + alignement + taille;
+    if (besoin > a->tailleBloc / 4) {
+        // grosse demande : un bloc pour elle seule, placé derriere le bloc courant. ses pages
+        // sont chargées d'un coup (elles seront toutes écrites) plutot qu'une faute à la fois.
+        Bloc *b = nouveauBloc(besoin, 1);
+        a->reserves += b->taille;
+        b->suivant = a->blocs->suivant;
+        a->blocs->suivant = b;
+        return prendre(b, taille, alignement);
+    }
+    Bloc *b = nouveauBloc(a->tailleBloc, 0);
+    a->reserves += b->taille;
+    b->suivant = a->blocs;
+    a->blocs = b;
+    return prendre(b, taille, alignement);
+}
+
+char *copierChaineArene(Arene *a, const char *debut, size_t n) {
+    char *s = allouerArene(a, n + 1, 1);
+    memcpy(s, debut, n);
+    s[n] = '\0';
+    return s;
+}
+
+int dansArene(const Arene *a, const void *p) {
+    if (a == NULL || p == NULL) return 0;
+    for (const Bloc *b = a->blocs; b; b = b->suivant) {
+        if ((const char *)p >= (const char *)b && (const char *)p < (const char *)b + b->taille) return 1;
+    }
+    return 0;
+}
+
+size_t octetsUtilisesArene(const Arene *a) {
+    return a ? a->utilises : 0;
+}
+
+size_t octetsReservesArene(const Arene *a) {
+    return a ? a->reserves : 0;
+}
+
+void libererArene(Arene *a) {
+    if (a == NULL) return;
+    Bloc *b = a->blocs;
+    // a est dans un des blocs : on ne la lit plus apres le premier munmap.
+    while (b) {
+        Bloc *suivant = b->suivant;
+        munmap(b, b->taille);
+        b = suivant;
+    }
+}
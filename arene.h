@@ -0,0 +1,28 @@
+#ifndef ARENE_H_
+#define ARENE_H_
+
+#include <stddef.h>
+
+// arène (alocation par incrément) : tout ce qui vit aussi longtemps qu'un dataset est pris
+// dans de grands blocs projetés en mémoire, et libéré d'un coup avec libererArene.
+// une demande est un simple déplacement de pointeur ; la mémoire rendue est à zéro (les
+// blocs ne sont jamais réutilisés). les grosses demandes (matrice, index) ont leur propre
+// bloc, rendu au systeme à la libération : rien ne reste dans le tas de malloc.
+// pas de libération individuelle, et pas de partage entre threads sans verrou.
+typedef struct Arene Arene;
+
+// tailleBloc : taille des blocs partagés par les petites demandes (0 = 64 Ko).
+Arene *creerArene(size_t tailleBloc);
+// taille octets alignés sur alignement (puissance de 2, au plus 4096), arrete le
+// programme si la mémoire manque.
+void *allouerArene(Arene *a, size_t taille, size_t alignement);
+// copie de [debut, debut + n) terminée par \0.
+char *copierChaineArene(Arene *a, const char *debut, size_t n);
+// 1 si p a été donné par cette arène (a peut etre NULL).
+int dansArene(const Arene *a, const void *p);
+// octets demandés / réservés auprès du systeme.
+size_t octetsUtilisesArene(const Arene *a);
+size_t octetsReservesArene(const Arene *a);
+void libererArene(Arene *a);
+
+#endif //ARENE_H_
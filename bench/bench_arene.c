@@ -0,0 +1,112 @@
+// cycles de rechargement comme dans le menu (options 13 et 14) : le nouveau dataset est lu
+// avant de libérer l'ancien, en alternant deux fichiers de tailles différentes. mesure le
+// temps de lecture, de split et de libération, la mémoire résidente et l'espace libre
+// resté dans le tas (fragmentation) après chaque cycle.
+// usage : bench_arene [lignes] [colones] [cycles]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "dataSet.h"
+#include "parallele.h"
+
+// mémoire résidente du processus en Mo.
+static double memoireResidente(void) {
+    long pages = 0, residentes = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    if (fscanf(f, "%ld %ld", &pages, &residentes) != 2) residentes = 0;
+    fclose(f);
+    return (double)residentes * (double)sysconf(_SC_PAGESIZE) / 1e6;
+}
+
+// octets libres gardés dans le tas par malloc (0 si inconnu).
+static double tasLibre(void) {
+#ifdef __GLIBC__
+    struct mallinfo2 m = mallinfo2();
+    return (double)m.fordblks / 1e6;
+#else
+    return 0;
+#endif
+}
+
+static void genererCSV(const char *chemin, int n, int d) {
+    FILE *f = fopen(chemin, "w");
+    if (!f) {
+        fprintf(stderr, "impossible d'ecrire %s\n", chemin);
+        exit(1);
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+    for (int j = 0; j < d; j++) fprintf(f, "mesure_%d_%s,", j, j % 2 ? "longueur" : "l");
+    fprintf(f, "classe\n");
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < d; j++) fprintf(f, "%.3f,", (double)(rand() % 10000) / 1000.0);
+        fprintf(f, "espece_%d\n", rand() % 7);
+    }
+    fclose(f);
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 20000;
+    int d = argc > 2 ? atoi(argv[2]) : 400;
+    int cycles = argc > 3 ? atoi(argv[3]) : 20;
+    if (n < 10 || d < 1 || cycles < 1) {
+        fprintf(stderr, "usage : bench_arene [lignes] [colones] [cycles]\n");
+        return 1;
+    }
+    char chemins[2][32] = { "/tmp/bench_arene_a_XXXXXX", "/tmp/bench_arene_b_XXXXXX" };
+    for (int k = 0; k < 2; k++) {
+        int fd = mkstemp(chemins[k]);
+        if (fd < 0) {
+            fprintf(stderr, "impossible de creer un fichier temporaire\n");
+            return 1;
+        }
+        close(fd);
+    }
+    srand(2026);
+    genererCSV(chemins[0], n, d);
+    genererCSV(chemins[1], n / 2 + 1, d + d / 3);
+
+    // les messages de chargement ne nous intéressent pas.
+    fflush(stdout);
+    FILE *sortie = fdopen(dup(STDOUT_FILENO), "w");
+    if (!sortie || !freopen("/dev/null", "w", stdout)) return 1;
+
+    fprintf(sortie, "%d x %d puis %d x %d, %d cycles\n", n, d, n / 2 + 1, d + d / 3, cycles);
+    fprintf(sortie, "%6s | %10s | %10s | %10s | %10s | %10s\n", "cycle", "lecture ms", "split ms", "liberer ms",
+            "rss Mo", "tas libre");
+    double totalLecture = 0, totalSplit = 0, totalLiberer = 0;
+    DataSet *courant = NULL;
+    for (int c = 0; c < cycles; c++) {
+        double t0 = maintenant();
+        DataSet *nouveau = createDataSet(chemins[c % 2]);
+        double t1 = maintenant();
+        for (int r = 0; r < 3; r++) melanger(nouveau);
+        double t2 = maintenant();
+        libererDataSet(courant);
+        double t3 = maintenant();
+        courant = nouveau;
+        totalLecture += t1 - t0;
+        totalSplit += t2 - t1;
+        totalLiberer += t3 - t2;
+        if (c < 4 || c == cycles - 1) {
+            fprintf(sortie, "%6d | %10.3f | %10.3f | %10.3f | %10.1f | %10.2f\n", c, (t1 - t0) * 1e3,
+                    (t2 - t1) * 1e3, (t3 - t2) * 1e3, memoireResidente(), tasLibre());
+        }
+    }
+    double t0 = maintenant();
+    libererDataSet(courant);
+    double dernier = maintenant() - t0;
+    fprintf(sortie, "moyenne | lecture %.3f ms | split %.3f ms | liberer %.3f ms | rss final %.1f Mo | tas libre %.2f Mo\n",
+            totalLecture * 1e3 / cycles, totalSplit * 1e3 / cycles, (totalLiberer + dernier) * 1e3 / cycles,
+            memoireResidente(), tasLibre());
+    fclose(sortie);
+    unlink(chemins[0]);
+    unlink(chemins[1]);
+    return 0;
+}
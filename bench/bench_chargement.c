@@ -0,0 +1,42 @@
+// mesure le débit du chargement csv (lignes/s et Mo/s) de 1 à N threads.
+// usage : bench_chargement [lignes] [colones] [threadsMax]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "dataSet.h"
+#include "parallele.h"
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int d = argc > 2 ? atoi(argv[2]) : 8;
+    int threadsMax = argc > 3 ? atoi(argv[3]) : nbThreadsParDefaut();
+    char chemin[] = "/tmp/bench_chargementXXXXXX";
+    int fd = mkstemp(chemin);
+    if (fd < 0) { perror("mkstemp"); return 1; }
+    FILE *f = fdopen(fd, "w");
+    srand(7);
+    for (int j = 0; j < d; j++) fprintf(f, "x%d,", j);
+    fprintf(f, "label\n");
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < d; j++) fprintf(f, "%.6f,", (double)rand() / RAND_MAX * 20.0 - 10.0);
+        fprintf(f, "classe%d\n", rand() % 5);
+    }
+    long octets = ftell(f);
+    fclose(f);
+
+    printf("%d lignes, %d colones, %.1f Mo\n", n, d, (double)octets / 1e6);
+    double reference = 0;
+    for (int t = 1; t <= threadsMax; t *= 2) {
+        double t0 = maintenant();
+        DataSet *ds = createDataSetParallele(chemin, t);
+        double duree = maintenant() - t0;
+        if (t == 1) reference = duree;
+        printf("threads %2d : %7.3fs | %10.0f lignes/s | %7.1f Mo/s | x%.2f\n", t, duree,
+               (double)ds->n / duree, (double)octets / 1e6 / duree, reference / duree);
+        libererDataSet(ds);
+    }
+    unlink(chemin);
+    return 0;
+}
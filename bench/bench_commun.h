@@ -0,0 +1,49 @@
+#ifndef BENCH_COMMUN_H_
+#define BENCH_COMMUN_H_
+
+// outils communs aux benchs : squelette de dataset dense et jeu de données synthétique.
+// l'horloge (maintenant) vient de parallele.h.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dataSet.h"
+#include "parallele.h"
+
+// dataset dense de n lignes et d colones, à zéro, sans split ni noms de colones :
+// donnees et etiquettes à remplir.
+static inline DataSet *creerDataSetBench(int n, int d) {
+    DataSet *ds = calloc(1, sizeof(DataSet));
+    ds->n = n;
+    ds->nbColonne = d;
+    ds->stride = calculerStride(d);
+    ds->donnees = allocMatrice(n, ds->stride);
+    ds->tab_Data = creerVuesLignes(ds->donnees, n, ds->stride);
+    ds->etiquettes = calloc((size_t)(n > 0 ? n : 1), sizeof(int));
+    ds->nom = strdup("synthetique");
+    return ds;
+}
+
+// valeurs uniformes dans [-1, 1], label = signe d'une frontiere linéaire cachée (plus
+// biais), puis bruit % de labels inversés. le dataset est mélangé et splitté.
+static inline DataSet *genererDataSet(int n, int d, double biais, int bruit) {
+    DataSet *ds = creerDataSetBench(n, d);
+    double *vrai = malloc(sizeof(double) * (size_t)d);
+    for (int j = 0; j < d; j++) vrai[j] = (double)rand() / RAND_MAX - 0.5;
+    for (int i = 0; i < n; i++) {
+        double *ligne = ligneData(ds, i);
+        double s = biais;
+        for (int j = 0; j < d; j++) {
+            ligne[j] = (double)rand() / RAND_MAX * 2.0 - 1.0;
+            s += vrai[j] * ligne[j];
+        }
+        int label = s >= 0;
+        if (rand() % 100 < bruit) label = !label;
+        ds->etiquettes[i] = label;
+    }
+    free(vrai);
+    melanger(ds);
+    return ds;
+}
+
+#endif //BENCH_COMMUN_H_
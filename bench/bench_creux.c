@@ -0,0 +1,134 @@
+// stockage creux contre dense : lecture d'un fichier libsvm, entrainement en ligne et
+// prédiction. le dense n'est mesuré que si la matrice n x colones tient en mémoire.
+// usage : bench_creux [lignes] [colones] [non nuls par ligne] [epoques]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dataSet.h"
+#include "perceptron.h"
+#include "bench_commun.h"
+
+// au dela, la version dense n'est pas construite (en octets).
+#define DENSE_MAX ((size_t)1 << 31)
+
+// nnz colones tirées au hasard par ligne, label = signe d'un modele caché.
+static void genererLibsvm(const char *chemin, int n, int d, int nnz) {
+    FILE *f = fopen(chemin, "w");
+    if (!f) {
+        fprintf(stderr, "impossible d'ecrire %s\n", chemin);
+        exit(1);
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+    double *vrai = malloc(sizeof(double) * (size_t)d);
+    for (int j = 0; j < d; j++) vrai[j] = (double)rand() / RAND_MAX - 0.5;
+    int *colonnes = malloc(sizeof(int) * (size_t)nnz);
+    double *valeurs = malloc(sizeof(double) * (size_t)nnz);
+    for (int i = 0; i < n; i++) {
+        // colones croissantes : un pas aléatoire autour de d / nnz.
+        double s = 0;
+        int c = 0;
+        int k = 0;
+        for (; k < nnz; k++) {
+            c += 1 + rand() % (2 * (d / nnz) > 1 ? 2 * (d / nnz) - 1 : 1);
+            if (c > d) break;
+            colonnes[k] = c;
+            valeurs[k] = (double)(rand() % 1000 + 1) / 1000.0;
+            s += vrai[c - 1] * valeurs[k];
+        }
+        fprintf(f, "%d", s >= 0);
+        for (int r = 0; r < k; r++) fprintf(f, " %d:%.3f", colonnes[r], valeurs[r]);
+        fputc('\n', f);
+    }
+    free(vrai);
+    free(colonnes);
+    free(valeurs);
+    fclose(f);
+}
+
+// meme dataset en matrice dense, avec le meme split.
+static DataSet *versDense(const DataSet *creux) {
+    DataSet *ds = creerDataSetBench(creux->n, creux->nbColonne);
+    for (int i = 0; i < ds->n; i++) {
+        const int *colonnes;
+        const double *valeurs;
+        int nnz = ligneCreuse(creux, i, &colonnes, &valeurs);
+        double *ligne = ligneData(ds, i);
+        for (int k = 0; k < nnz; k++) ligne[colonnes[k]] = valeurs[k];
+        ds->etiquettes[i] = creux->etiquettes[i];
+    }
+    return ds;
+}
+
+static void mesurer(const char *nom, DataSet *ds, int epoques) {
+    srand(7);
+    Perceptron *p = createPerceptron(ds->nbColonne, epoques);
+    p->pasApprentissage = 0.01;
+    double t0 = maintenant();
+    entrainerPerceptron(ds, p);
+    double duree = maintenant() - t0;
+    int *predictions = malloc(sizeof(int) * (size_t)ds->n);
+    t0 = maintenant();
+    predireDataSet(&p, 1, ds, NULL, ds->n, predictions);
+    double dureePrediction = maintenant() - t0;
+    double acc = accuracy(p, ds);
+    printf("%-6s | entrainement %8.3fs (%8.1f ns/ligne) | prediction %7.3fs (%7.1f ns/ligne) | accuracy %6.2f%%\n",
+           nom, duree, duree * 1e9 / ((double)ds->nTrain * epoques), dureePrediction,
+           dureePrediction * 1e9 / ds->n, acc * 100.0);
+    free(predictions);
+    libererPerceptron(p);
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    int d = argc > 2 ? atoi(argv[2]) : 1000000;
+    int nnz = argc > 3 ? atoi(argv[3]) : 50;
+    int epoques = argc > 4 ? atoi(argv[4]) : 5;
+    if (n < 10 || d < 1 || nnz < 1) {
+        fprintf(stderr, "usage : bench_creux [lignes] [colones] [non nuls par ligne] [epoques]\n");
+        return 1;
+    }
+    if (nnz > d) nnz = d;
+    char chemin[] = "/tmp/bench_creux_XXXXXX";
+    int fd = mkstemp(chemin);
+    if (fd < 0) {
+        fprintf(stderr, "impossible de creer un fichier temporaire\n");
+        return 1;
+    }
+    close(fd);
+    srand(2026);
+    genererLibsvm(chemin, n, d, nnz);
+
+    double t0 = maintenant();
+    DataSet *creux = createDataSetLibsvm(chemin);
+    double dureeLecture = maintenant() - t0;
+    unlink(chemin);
+    srand(1);
+    melanger(creux);
+    printf("%d lignes, %d colones, %zu non nuls (%.1f par ligne), %d epoques\n", creux->n, creux->nbColonne,
+           creux->creux->nnz, (double)creux->creux->nnz / creux->n, epoques);
+    printf("lecture libsvm : %.3fs | memoire creuse %.1f Mo, dense %.1f Mo\n", dureeLecture,
+           (double)creux->creux->nnz * (sizeof(int) + sizeof(double)) / 1e6,
+           (double)creux->n * calculerStride(creux->nbColonne) * sizeof(double) / 1e6);
+
+    mesurer("creux", creux, epoques);
+    if ((size_t)creux->n * (size_t)calculerStride(creux->nbColonne) * sizeof(double) <= DENSE_MAX) {
+        DataSet *dense = versDense(creux);
+        dense->indexSplit = malloc(sizeof(int) * (size_t)dense->n);
+        memcpy(dense->indexSplit, creux->indexSplit, sizeof(int) * (size_t)dense->n);
+        dense->nTrain = creux->nTrain;
+        dense->nTest = creux->nTest;
+        dense->sortieAttendue_train = malloc(sizeof(int) * (size_t)dense->nTrain);
+        dense->sortieAttendue_Teste = malloc(sizeof(int) * (size_t)dense->nTest);
+        memcpy(dense->sortieAttendue_train, creux->sortieAttendue_train, sizeof(int) * (size_t)dense->nTrain);
+        memcpy(dense->sortieAttendue_Teste, creux->sortieAttendue_Teste, sizeof(int) * (size_t)dense->nTest);
+        mesurer("dense", dense, epoques);
+        libererDataSet(dense);
+    } else {
+        printf("dense  | non mesure : la matrice depasserait %zu Mo\n", DENSE_MAX >> 20);
+    }
+    libererDataSet(creux);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// dictionnaire des classes : cout d'un label (recherche d'une classe connue) selon le
+// nombre de classes, lecture d'un csv à beaucoup de classes, et ajouts concurrents depuis
+// plusieurs threads (chaque nom doit recevoir un seul numéro, le meme pour tous).
+// usage : bench_labels [lignes] [threads]
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dataSet.h"
+#include "labels.h"
+#include "parallele.h"
+
+#define NB_NOMS_CONCURRENTS 20000
+
+static void nomClasse(char *nom, size_t taille, int k) {
+    snprintf(nom, taille, "espece_%d_%s", k, k % 3 ? "sauvage" : "b");
+}
+
+// ns par label pour n labels tirés parmi K classes déjà connues.
+static double mesurerRecherche(int K, int n) {
+    DictionnaireLabels d;
+    memset(&d, 0, sizeof(d));
+    char nom[64];
+    for (int k = 0; k < K; k++) {
+        nomClasse(nom, sizeof(nom), k);
+        ajouterLabel(&d, nom);
+    }
+    char (*noms)[64] = malloc(sizeof(*noms) * (size_t)n);
+    for (int i = 0; i < n; i++) nomClasse(noms[i], sizeof(noms[i]), rand() % K);
+    long somme = 0;
+    double t0 = maintenant();
+    for (int i = 0; i < n; i++) somme += ajouterLabel(&d, noms[i]);
+    double t = maintenant() - t0;
+    if (somme < 0 || d.nb != K) printf("erreur : %d classes au lieu de %d\n", d.nb, K);
+    free(noms);
+    libererDictionnaire(&d);
+    return t * 1e9 / n;
+}
+
+typedef struct {
+    DictionnaireLabels *d;
+    int graine;
+    int *numeros;
+} ContexteAjout;
+
+// chaque thread ajoute tous les noms, dans son propre ordre.
+static void *ajouterTous(void *arg) {
+    ContexteAjout *c = arg;
+    char nom[64];
+    unsigned int graine = (unsigned int)c->graine;
+    for (int i = 0; i < NB_NOMS_CONCURRENTS; i++) {
+        int k = (int)(rand_r(&graine) % NB_NOMS_CONCURRENTS);
+        nomClasse(nom, sizeof(nom), k);
+        c->numeros[k] = ajouterLabel(c->d, nom);
+    }
+    for (int k = 0; k < NB_NOMS_CONCURRENTS; k++) {
+        nomClasse(nom, sizeof(nom), k);
+        c->numeros[k] = ajouterLabel(c->d, nom);
+    }
+    return NULL;
+}
+
+static int verifierConcurrence(int nbThreads, double *duree) {
+    DictionnaireLabels d;
+    memset(&d, 0, sizeof(d));
+    pthread_t threads[64];
+    ContexteAjout contextes[64];
+    double t0 = maintenant();
+    for (int t = 0; t < nbThreads; t++) {
+        contextes[t].d = &d;
+        contextes[t].graine = 1000 + t;
+        contextes[t].numeros = malloc(sizeof(int) * NB_NOMS_CONCURRENTS);
+        pthread_create(&threads[t], NULL, ajouterTous, &contextes[t]);
+    }
+    for (int t = 0; t < nbThreads; t++) pthread_join(threads[t], NULL);
+    *duree = maintenant() - t0;
+    int ok = d.nb == NB_NOMS_CONCURRENTS;
+    char nom[64];
+    for (int k = 0; k < NB_NOMS_CONCURRENTS && ok; k++) {
+        int numero = contextes[0].numeros[k];
+        nomClasse(nom, sizeof(nom), k);
+        ok = numero >= 0 && numero < d.nb && strcmp(d.noms[numero], nom) == 0 && chercherLabel(&d, nom) == numero;
+        for (int t = 1; t < nbThreads && ok; t++) ok = contextes[t].numeros[k] == numero;
+    }
+    for (int t = 0; t < nbThreads; t++) free(contextes[t].numeros);
+    libererDictionnaire(&d);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 200000;
+    int nbThreads = argc > 2 ? atoi(argv[2]) : 4;
+    if (n < 1 || nbThreads < 1 || nbThreads > 64) {
+        fprintf(stderr, "usage : bench_labels [lignes] [threads]\n");
+        return 1;
+    }
+    srand(2026);
+    static const int classes[] = { 3, 10, 100, 1000, 10000 };
+    printf("%8s | %s\n", "classes", "ns par label");
+    for (size_t c = 0; c < sizeof(classes) / sizeof(classes[0]); c++)
+        printf("%8d | %10.1f\n", classes[c], mesurerRecherche(classes[c], n));
+
+    // csv de n lignes à 5000 classes.
+    char chemin[] = "/tmp/bench_labels_XXXXXX";
+    int fd = mkstemp(chemin);
+    if (fd < 0) return 1;
+    FILE *f = fdopen(fd, "w");
+    fprintf(f, "x,y,classe\n");
+    char nom[64];
+    for (int i = 0; i < n; i++) {
+        nomClasse(nom, sizeof(nom), rand() % 5000);
+        fprintf(f, "%.3f,%.3f,%s\n", (double)rand() / RAND_MAX, (double)rand() / RAND_MAX, nom);
+    }
+    fclose(f);
+    fflush(stdout);
+    FILE *sortie = fdopen(dup(STDOUT_FILENO), "w");
+    if (!sortie || !freopen("/dev/null", "w", stdout)) return 1;
+    double t0 = maintenant();
+    DataSet *ds = createDataSetParallele(chemin, nbThreads);
+    double lecture = maintenant() - t0;
+    fprintf(sortie, "csv %d lignes, %d classes : lecture %.1f ms (%d threads)\n", ds->n, ds->nomsClasses.nb,
+            lecture * 1e3, nbThreads);
+    libererDataSet(ds);
+    unlink(chemin);
+
+    double duree;
+    int ok = verifierConcurrence(nbThreads, &duree);
+    fprintf(sortie, "ajouts concurrents : %d threads x %d noms en %.1f ms, numeros coherents : %s\n", nbThreads,
+            2 * NB_NOMS_CONCURRENTS, duree * 1e3, ok ? "oui" : "NON");
+    fclose(sortie);
+    return ok ? 0 : 1;
+}
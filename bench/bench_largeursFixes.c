@@ -0,0 +1,102 @@
+// produits déroulés pour 2, 4, 8 et 16 colones contre la variante simd générique :
+// predire ligne par ligne (comme l'entrainement en ligne), predireBatch, et
+// predireMultiBatch à 3 experts. vérifie que les prédictions sont identiques.
+// usage : bench_largeursFixes [lignes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dataSet.h"
+#include "noyau.h"
+#include "perceptron.h"
+#include "parallele.h"
+
+#define NB_EXPERTS 3
+
+// meilleur de 3 passages de predire sur toutes les lignes.
+static double mesurerLigneParLigne(Perceptron *p, const double *lignes, int stride, int n, int *sortie) {
+    double meilleur = 1e30;
+    for (int r = 0; r < 3; r++) {
+        double t0 = maintenant();
+        for (int i = 0; i < n; i++) sortie[i] = predire(p, lignes + (size_t)i * stride);
+        double t = maintenant() - t0;
+        if (t < meilleur) meilleur = t;
+    }
+    return meilleur;
+}
+
+static double mesurerBatch(Perceptron *p, const double *lignes, int stride, int n, int *sortie) {
+    double meilleur = 1e30;
+    for (int r = 0; r < 3; r++) {
+        double t0 = maintenant();
+        predireBatch(p, lignes, stride, NULL, n, sortie);
+        double t = maintenant() - t0;
+        if (t < meilleur) meilleur = t;
+    }
+    return meilleur;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 200000;
+    if (n < 1) {
+        fprintf(stderr, "usage : bench_largeursFixes [lignes]\n");
+        return 1;
+    }
+    static const int largeurs[] = { 2, 4, 8, 16 };
+    FonctionProduit generique = noyauProduitScalaire(nomNoyauActif());
+    srand(2026);
+    printf("noyau actif : %s, %d lignes (ns par ligne)\n", nomNoyauActif(), n);
+    printf("%4s | %-23s | %-23s | %-23s | identique\n", "d", "predire fixe / simd", "predireBatch fixe / simd",
+           "multi lot / par ligne");
+
+    for (size_t l = 0; l < sizeof(largeurs) / sizeof(largeurs[0]); l++) {
+        int d = largeurs[l];
+        int stride = calculerStride(d);
+        double *lignes = allocMatrice(n, stride);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < d; j++) lignes[(size_t)i * stride + j] = (double)rand() / RAND_MAX - 0.5;
+        }
+        Perceptron *experts[NB_EXPERTS];
+        for (int k = 0; k < NB_EXPERTS; k++) experts[k] = createPerceptron(d, 1);
+        Perceptron *p = experts[0];
+        int *a = malloc(sizeof(int) * (size_t)n);
+        int *b = malloc(sizeof(int) * (size_t)n);
+        int identique = 1;
+
+        // un passage à blanc : pages et fréquence du cpu en place avant de mesurer.
+        mesurerLigneParLigne(p, lignes, stride, n, a);
+        double ligneFixe = mesurerLigneParLigne(p, lignes, stride, n, a);
+        p->produit = generique;
+        double ligneSimd = mesurerLigneParLigne(p, lignes, stride, n, b);
+        if (memcmp(a, b, sizeof(int) * (size_t)n) != 0) identique = 0;
+
+        double batchSimd = mesurerBatch(p, lignes, stride, n, b);
+        p->produit = choisirProduit(d);
+        double batchFixe = mesurerBatch(p, lignes, stride, n, a);
+        if (memcmp(a, b, sizeof(int) * (size_t)n) != 0) identique = 0;
+
+        // lot multi-classe (noyau à 3 experts déroulé) contre predireMulti ligne par ligne.
+        double multiLot = 1e30;
+        for (int r = 0; r < 3; r++) {
+            double t0 = maintenant();
+            predireMultiBatch(experts, NB_EXPERTS, lignes, stride, NULL, n, a);
+            double t = maintenant() - t0;
+            if (t < multiLot) multiLot = t;
+        }
+        for (int k = 0; k < NB_EXPERTS; k++) experts[k]->produit = generique;
+        double t0 = maintenant();
+        for (int i = 0; i < n; i++) b[i] = predireMulti(experts, NB_EXPERTS, lignes + (size_t)i * stride);
+        double multiLigne = maintenant() - t0;
+        if (memcmp(a, b, sizeof(int) * (size_t)n) != 0) identique = 0;
+
+        printf("%4d | %10.2f / %10.2f | %10.2f / %10.2f | %10.2f / %10.2f | %s\n", d, ligneFixe * 1e9 / n,
+               ligneSimd * 1e9 / n, batchFixe * 1e9 / n, batchSimd * 1e9 / n, multiLot * 1e9 / n,
+               multiLigne * 1e9 / n, identique ? "oui" : "NON");
+        for (int k = 0; k < NB_EXPERTS; k++) libererPerceptron(experts[k]);
+        free(a);
+        free(b);
+        free(lignes);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+// compare la convergence de l'apprentissage en ligne et du mode mini-batch
+// multi-thread : accuracy sur le teste en fonction du temps d'entrainement écoulé.
+// usage : bench_miniBatch [lignes] [colones] [epoques] [tailleBatch]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dataSet.h"
+#include "perceptron.h"
+#include "bench_commun.h"
+
+static void mesurer(const char *nom, DataSet *ds, int epoques, int tailleBatch, int nbThreads) {
+    srand(99);
+    Perceptron *p = createPerceptron(ds->nbColonne, 1);
+    p->pasApprentissage = 0.01;
+    p->tailleBatch = tailleBatch;
+    p->nbThreads = nbThreads;
+    double total = 0;
+    printf("%-22s", nom);
+    for (int e = 1; e <= epoques; e++) {
+        double t0 = maintenant();
+        entrainerPerceptron(ds, p);
+        total += maintenant() - t0;
+        if (e == 1 || e == epoques || (e & (e - 1)) == 0) {
+            printf(" | ep %3d %7.3fs %5.1f%%", e, total, accuracy(p, ds) * 100.0);
+        }
+    }
+    printf(" | %.0f lignes/s\n", (double)ds->nTrain * epoques / total);
+    libererPerceptron(p);
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 400000;
+    int d = argc > 2 ? atoi(argv[2]) : 32;
+    int epoques = argc > 3 ? atoi(argv[3]) : 16;
+    int tailleBatch = argc > 4 ? atoi(argv[4]) : 4096;
+    srand(2026);
+    DataSet *ds = genererDataSet(n, d, 0.1, 5);
+    printf("%d lignes, %d colones, %d epoques, batch %d, %d coeurs\n",
+           n, d, epoques, tailleBatch, nbThreadsParDefaut());
+
+    mesurer("en ligne", ds, epoques, 0, 1);
+    for (int t = 1; t <= nbThreadsParDefaut(); t *= 2) {
+        char nom[64];
+        snprintf(nom, sizeof(nom), "mini-batch %d thr", t);
+        mesurer(nom, ds, epoques, tailleBatch, t);
+    }
+    libererDataSet(ds);
+    return 0;
+}
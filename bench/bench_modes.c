@@ -0,0 +1,50 @@
+// compare les regles d'apprentissage classique, pocket et moyenne sur des données
+// non séparables : accuracy sur le teste et temps d'entrainement, en ligne et en mini-batch.
+// usage : bench_modes [lignes] [colones] [epoques] [bruit %] [tailleBatch]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dataSet.h"
+#include "perceptron.h"
+#include "bench_commun.h"
+
+static double mesurer(const char *nom, DataSet *ds, int mode, int epoques, int tailleBatch, double reference) {
+    srand(99);
+    Perceptron *p = createPerceptron(ds->nbColonne, epoques);
+    p->pasApprentissage = 0.01;
+    p->tailleBatch = tailleBatch;
+    p->modeApprentissage = mode;
+    double t0 = maintenant();
+    entrainerPerceptron(ds, p);
+    double duree = maintenant() - t0;
+    double acc = accuracy(p, ds);
+    printf("%-10s %-9s | accuracy %6.2f%% | %7.3fs", nom, tailleBatch > 1 ? "batch" : "en ligne", acc * 100.0, duree);
+    if (reference > 0) printf(" (x%.2f)", duree / reference);
+    printf(" | %.0f lignes/s\n", (double)ds->nTrain * epoques / duree);
+    libererPerceptron(p);
+    return duree;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    int d = argc > 2 ? atoi(argv[2]) : 16;
+    int epoques = argc > 3 ? atoi(argv[3]) : 20;
+    int bruit = argc > 4 ? atoi(argv[4]) : 10;
+    int tailleBatch = argc > 5 ? atoi(argv[5]) : 1024;
+    srand(2026);
+    DataSet *ds = genererDataSet(n, d, 0.1, bruit);
+    printf("%d lignes, %d colones, %d epoques, %d%% de labels inverses, batch %d\n", n, d, epoques, bruit, tailleBatch);
+
+    const char *noms[] = { "classique", "pocket", "moyenne" };
+    for (int b = 0; b < 2; b++) {
+        int taille = b ? tailleBatch : 0;
+        double reference = 0;
+        for (int mode = MODE_CLASSIQUE; mode <= MODE_MOYENNE; mode++) {
+            double duree = mesurer(noms[mode], ds, mode, epoques, taille, reference);
+            if (mode == MODE_CLASSIQUE) reference = duree;
+        }
+    }
+    libererDataSet(ds);
+    return 0;
+}
@@ -0,0 +1,67 @@
+// compare la convergence sur données brutes et normalisées (standard, min-max) :
+// accuracy sur le teste époque par époque, et première époque qui atteint la cible.
+// les colones ont des échelles et des décalages très diférents, comme dans un vrai csv.
+// usage : bench_normalisation [lignes] [colones] [epoques] [cible]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dataSet.h"
+#include "normalisation.h"
+#include "perceptron.h"
+#include "bench_commun.h"
+
+// frontiere linéaire (3% de bruit sur les labels) dans un espace réduit, puis la colone j
+// est multipliée par 10^(j % 5 - 2) et décalée de 3 fois son échelle.
+static DataSet *genererDataSetEchelles(int n, int d) {
+    DataSet *ds = genererDataSet(n, d, 0.05, 3);
+    for (int i = 0; i < n; i++) {
+        double *ligne = ligneData(ds, i);
+        for (int j = 0; j < d; j++) ligne[j] = (ligne[j] + 3.0) * pow(10.0, j % 5 - 2);
+    }
+    return ds;
+}
+
+static void mesurer(const char *nom, int type, int n, int d, int epoques, double cible) {
+    srand(2026);
+    DataSet *ds = genererDataSetEchelles(n, d);
+    double t0 = maintenant();
+    if (type != NORMALISATION_AUCUNE) normaliserDataSet(ds, type, 0);
+    double tempsNormalisation = maintenant() - t0;
+
+    srand(99);
+    Perceptron *p = createPerceptron(ds->nbColonne, 1);
+    p->pasApprentissage = 0.01;
+    double total = 0, meilleure = 0;
+    int atteinte = -1;
+    printf("%-9s", nom);
+    for (int e = 1; e <= epoques; e++) {
+        t0 = maintenant();
+        entrainerPerceptron(ds, p);
+        total += maintenant() - t0;
+        double acc = accuracy(p, ds);
+        if (acc > meilleure) meilleure = acc;
+        if (atteinte < 0 && acc >= cible) atteinte = e;
+        if (e == 1 || e == epoques || (e & (e - 1)) == 0) printf(" | ep %3d %5.1f%%", e, acc * 100.0);
+    }
+    if (atteinte > 0) printf(" | cible a l'epoque %d", atteinte);
+    else printf(" | cible non atteinte");
+    printf(" | meilleure %5.1f%% | normalisation %.4fs, entrainement %.3fs\n",
+           meilleure * 100.0, tempsNormalisation, total);
+    libererPerceptron(p);
+    libererDataSet(ds);
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 50000;
+    int d = argc > 2 ? atoi(argv[2]) : 16;
+    int epoques = argc > 3 ? atoi(argv[3]) : 32;
+    double cible = argc > 4 ? atof(argv[4]) : 0.85;
+    printf("%d lignes, %d colones, %d epoques, cible %.1f%%\n", n, d, epoques, cible * 100.0);
+
+    mesurer("brut", NORMALISATION_AUCUNE, n, d, epoques, cible);
+    mesurer("standard", NORMALISATION_STANDARD, n, d, epoques, cible);
+    mesurer("minmax", NORMALISATION_MINMAX, n, d, epoques, cible);
+    return 0;
+}
@@ -0,0 +1,163 @@
+// inférence en double, float et int8 : égalité au bit près des variantes simd des noyaux
+// float / int8 (une ligne, 4 lignes, conversion et quantification des lignes), puis débit
+// de prédiction d'un modele multi-classe et écart de ses prédictions avec le double.
+// usage : bench_precision [lignes] [colones] [classes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dataSet.h"
+#include "noyau.h"
+#include "perceptron.h"
+#include "precision.h"
+#include "bench_commun.h"
+
+static double aleatoire(void) {
+    return (double)rand() / RAND_MAX - 0.5;
+}
+
+static void verifierNoyaux(void) {
+    static const int largeurs[] = { 4, 7, 16, 33, 100, 256, 1000, 4096, 70000 };
+    static const char *variantes[] = { "scalaire", "sse2", "avx2", "avx512" };
+    printf("noyau actif : %s\n", nomNoyauActif());
+    printf("%6s | %-8s | %-8s | %-8s | %-10s\n", "n", "float", "int8", "4 lignes", "conversion");
+    for (size_t k = 0; k < sizeof(largeurs) / sizeof(largeurs[0]); k++) {
+        int n = largeurs[k];
+        float *fa = malloc(sizeof(float) * (size_t)n);
+        float *fb = malloc(sizeof(float) * (size_t)n * 4);
+        int8_t *qa = malloc((size_t)n);
+        int8_t *qb = malloc((size_t)n * 4);
+        double *x = malloc(sizeof(double) * (size_t)n);
+        float *fx = malloc(sizeof(float) * (size_t)n * 2);
+        int8_t *qx = malloc((size_t)n * 2);
+        for (int i = 0; i < n; i++) {
+            fa[i] = (float)aleatoire();
+            // valeurs extremes comprises, pour vérifier l'extension de signe.
+            qa[i] = (int8_t)(rand() % 255 - 127);
+            x[i] = aleatoire() * 8.0;
+        }
+        for (int i = 0; i < n * 4; i++) {
+            fb[i] = (float)(aleatoire() * 10.0);
+            qb[i] = (int8_t)(rand() % 255 - 127);
+        }
+        // les 4 lignes d'un paquet, comparées ligne par ligne à la version scalaire une ligne.
+        const float *lignesFloat[4] = { fb, fb + n, fb + 2 * n, fb + 3 * n };
+        const int8_t *lignesInt8[4] = { qb, qb + n, qb + 2 * n, qb + 3 * n };
+        float refFloat[4];
+        int32_t refInt8[4];
+        for (int r = 0; r < 4; r++) {
+            refFloat[r] = noyauProduitFloat("scalaire")(fa, lignesFloat[r], n);
+            refInt8[r] = noyauProduitInt8("scalaire")(qa, lignesInt8[r], n);
+        }
+        noyauConversionFloat("scalaire")(x, n, fx);
+        float refEchelle = noyauQuantifierInt8("scalaire")(x, n, qx);
+        int identiqueFloat = 1, identiqueInt8 = 1, identique4 = 1, identiqueConversion = 1;
+        for (size_t v = 0; v < sizeof(variantes) / sizeof(variantes[0]); v++) {
+            FonctionProduitFloat f = noyauProduitFloat(variantes[v]);
+            FonctionProduitInt8 q = noyauProduitInt8(variantes[v]);
+            FonctionProduit4Float f4 = noyauProduit4Float(variantes[v]);
+            FonctionProduit4Int8 q4 = noyauProduit4Int8(variantes[v]);
+            FonctionConversionFloat conversion = noyauConversionFloat(variantes[v]);
+            FonctionQuantifier quantifier = noyauQuantifierInt8(variantes[v]);
+            if (f) {
+                float r = f(fa, fb, n);
+                if (memcmp(&r, &refFloat[0], sizeof(float)) != 0) identiqueFloat = 0;
+            }
+            if (q && q(qa, qb, n) != refInt8[0]) identiqueInt8 = 0;
+            if (f4) {
+                float s[4];
+                f4(fa, lignesFloat, n, s);
+                if (memcmp(s, refFloat, sizeof(s)) != 0) identique4 = 0;
+            }
+            if (q4) {
+                int32_t s[4];
+                q4(qa, lignesInt8, n, s);
+                if (memcmp(s, refInt8, sizeof(s)) != 0) identique4 = 0;
+            }
+            if (conversion) {
+                conversion(x, n, fx + n);
+                if (memcmp(fx, fx + n, sizeof(float) * (size_t)n) != 0) identiqueConversion = 0;
+            }
+            if (quantifier) {
+                float echelle = quantifier(x, n, qx + n);
+                if (echelle != refEchelle || memcmp(qx, qx + n, (size_t)n) != 0) identiqueConversion = 0;
+            }
+        }
+        printf("%6d | %-8s | %-8s | %-8s | %-10s\n", n, identiqueFloat ? "oui" : "NON", identiqueInt8 ? "oui" : "NON",
+               identique4 ? "oui" : "NON", identiqueConversion ? "oui" : "NON");
+        free(fa);
+        free(fb);
+        free(qa);
+        free(qb);
+        free(x);
+        free(fx);
+        free(qx);
+    }
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    int d = argc > 2 ? atoi(argv[2]) : 256;
+    int nbClasses = argc > 3 ? atoi(argv[3]) : 10;
+    if (n < 1 || d < 1 || nbClasses < 2) {
+        fprintf(stderr, "usage : bench_precision [lignes] [colones] [classes]\n");
+        return 1;
+    }
+    srand(2026);
+    verifierNoyaux();
+
+    // modele caché : les labels sont sa prédiction, les experts en sont une copie bruitée.
+    const int nbExperts = nbClasses == 2 ? 1 : nbClasses;
+    Modele *m = calloc(1, sizeof(Modele));
+    m->nbExperts = nbExperts;
+    m->nPoids = d;
+    m->experts = malloc(sizeof(Perceptron *) * (size_t)nbExperts);
+    for (int k = 0; k < nbExperts; k++) {
+        m->experts[k] = createPerceptron(d, 1);
+        for (int j = 0; j < d; j++) m->experts[k]->poids[j] = aleatoire();
+        m->experts[k]->biais = aleatoire() * 0.1;
+    }
+
+    DataSet *ds = creerDataSetBench(n, d);
+    for (int i = 0; i < n; i++) {
+        double *ligne = ligneData(ds, i);
+        for (int j = 0; j < d; j++) ligne[j] = aleatoire() * 4.0;
+    }
+    predireDataSet(m->experts, nbExperts, ds, NULL, n, ds->etiquettes);
+    for (int k = 0; k < nbExperts; k++) {
+        for (int j = 0; j < d; j++) m->experts[k]->poids[j] += aleatoire() * 0.1;
+    }
+
+    printf("\n%d lignes, %d colones, %d expert(s)\n", n, d, nbExperts);
+    int *reference = malloc(sizeof(int) * (size_t)n);
+    int *predictions = malloc(sizeof(int) * (size_t)n);
+    double dureeDouble = 0;
+    for (int precision = PRECISION_DOUBLE; precision <= PRECISION_INT8; precision++) {
+        choisirPrecisionModele(m, precision);
+        int *sortie = precision == PRECISION_DOUBLE ? reference : predictions;
+        // meilleur de 3 passages.
+        double duree = 1e30;
+        for (int r = 0; r < 3; r++) {
+            double t0 = maintenant();
+            predireModele(m, ds, NULL, n, sortie);
+            double t = maintenant() - t0;
+            if (t < duree) duree = t;
+        }
+        if (precision == PRECISION_DOUBLE) dureeDouble = duree;
+        int accords = 0, succes = 0;
+        for (int i = 0; i < n; i++) {
+            if (sortie[i] == reference[i]) accords++;
+            if (sortie[i] == ds->etiquettes[i]) succes++;
+        }
+        printf("%-6s | %8.4fs (%7.1f ns/ligne, x%.2f) | accord avec double %.4f | accuracy %.4f\n",
+               nomPrecision(precision), duree, duree * 1e9 / n, duree > 0 ? dureeDouble / duree : 0.0,
+               (double)accords / n, (double)succes / n);
+    }
+
+    free(reference);
+    free(predictions);
+    libererModele(m);
+    libererDataSet(ds);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// micro-benchmark du produit scalaire : compare chaque variante simd à la
+// version scalaire (temps par appel et égalité au bit près) pour des largeurs
+// de 4 à 4096 colones, et affiche la variante retenue par le dispatch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "noyau.h"
+#include "parallele.h"
+
+int main(void) {
+    static const int largeurs[] = { 4, 7, 8, 16, 31, 64, 100, 256, 512, 1024, 2048, 4096 };
+    static const char *variantes[] = { "scalaire", "sse2", "avx2", "avx512" };
+    const int nbVariantes = (int)(sizeof(variantes) / sizeof(variantes[0]));
+    srand(12345);
+
+    printf("noyau actif : %s\n", nomNoyauActif());
+    printf("%6s", "n");
+    for (int v = 0; v < nbVariantes; v++) printf(" | %10s ns", variantes[v]);
+    printf(" | identique | choisi\n");
+
+    for (size_t k = 0; k < sizeof(largeurs) / sizeof(largeurs[0]); k++) {
+        int n = largeurs[k];
+        double *a = malloc((size_t)n * sizeof(double));
+        double *b = malloc((size_t)n * sizeof(double));
+        for (int i = 0; i < n; i++) {
+            a[i] = (double)rand() / RAND_MAX - 0.5;
+            b[i] = (double)rand() / RAND_MAX * 10.0;
+        }
+        // environ 2^26 multiplications par mesure quelle que soit la largeur.
+        long iterations = (1L << 26) / n;
+        double reference = noyauProduitScalaire("scalaire")(a, b, n);
+        int identique = 1;
+
+        printf("%6d", n);
+        for (int v = 0; v < nbVariantes; v++) {
+            FonctionProduit f = noyauProduitScalaire(variantes[v]);
+            if (!f) {
+                printf(" | %13s", "-");
+                continue;
+            }
+            volatile double puits = 0;
+            double t0 = maintenant();
+            for (long it = 0; it < iterations; it++) {
+                puits = puits + f(a, b, n);
+            }
+            double t1 = maintenant();
+            double r = f(a, b, n);
+            if (memcmp(&r, &reference, sizeof(double)) != 0) identique = 0;
+            printf(" | %13.2f", (t1 - t0) * 1e9 / (double)iterations);
+        }
+        printf(" | %-9s | %s\n", identique ? "oui" : "NON", nomNoyauPourLargeur(n));
+        free(a);
+        free(b);
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+// image des zones de décision contre la prédiction réele : chaque pixel de
+// rasteriserDecision doit porter la classe que predire / predireMulti donnent au point
+// corespondant (autres colones au centre), y compris loin des données où les scores sont
+// grands. seuls les pixels où deux experts sont à égalité aux arrondis près peuvent différer
+// (score affine contre produit scalaire). affiche aussi le débit des deux chemins.
+// usage : bench_raster [largeur] [hauteur]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dataSet.h"
+#include "perceptron.h"
+#include "raster.h"
+#include "bench_commun.h"
+
+#define NB_COLONNES 4
+#define COL_X 0
+#define COL_Y 2
+
+static double score(Perceptron *p, const double *ligne) {
+    return p->produit(p->poids, ligne, p->nPoids) + p->biais;
+}
+
+int main(int argc, char **argv) {
+    int largeur = argc > 1 ? atoi(argv[1]) : 400;
+    int hauteur = argc > 2 ? atoi(argv[2]) : 300;
+    if (largeur < 1 || hauteur < 1) {
+        fprintf(stderr, "usage : bench_raster [largeur] [hauteur]\n");
+        return 1;
+    }
+    static const int nbExperts[] = { 1, 3, 6 };
+    // échelle 100 : scores de plusieurs centaines, toutes les sigmoïdes valent 1.0.
+    static const double echelles[] = { 1.0, 100.0 };
+    srand(2026);
+    DataSet *ds = creerDataSetBench(2000, NB_COLONNES);
+    for (int i = 0; i < ds->n; i++) {
+        double *ligne = ligneData(ds, i);
+        for (int j = 0; j < NB_COLONNES; j++) ligne[j] = (double)rand() / RAND_MAX * 4.0 - 2.0;
+    }
+    double centre[NB_COLONNES], minX, maxX, minY, maxY;
+    cadrerDecision(ds, COL_X, COL_Y, centre, &minX, &maxX, &minY, &maxY);
+    // vue dézoomée : 20 fois le cadre des données.
+    minX *= 20;
+    maxX *= 20;
+    minY *= 20;
+    maxY *= 20;
+    ImageDecision *img = creerImageDecision(largeur, hauteur);
+    double ligne[NB_COLONNES];
+    int echec = 0;
+
+    printf("%dx%d pixels (ns par pixel)\n", largeur, hauteur);
+    printf("%7s | %7s | %10s | %10s | %-17s | identique\n", "experts", "echelle", "image", "predire",
+           "desaccords/arrondi");
+    for (size_t a = 0; a < sizeof(nbExperts) / sizeof(nbExperts[0]); a++) {
+        for (size_t b = 0; b < sizeof(echelles) / sizeof(echelles[0]); b++) {
+            int K = nbExperts[a];
+            Perceptron *experts[6];
+            for (int k = 0; k < K; k++) {
+                experts[k] = createPerceptron(NB_COLONNES, 1);
+                for (int j = 0; j < NB_COLONNES; j++) {
+                    experts[k]->poids[j] = ((double)rand() / RAND_MAX - 0.5) * echelles[b];
+                }
+                experts[k]->biais = ((double)rand() / RAND_MAX - 0.5) * echelles[b];
+            }
+
+            double t0 = maintenant();
+            rasteriserDecision(img, experts, K, COL_X, COL_Y, centre, minX, maxX, minY, maxY, 0);
+            double dureeImage = maintenant() - t0;
+
+            // meme point que le pixel : x et y calculés comme dans rasteriserDecision.
+            int desaccords = 0, arrondis = 0;
+            t0 = maintenant();
+            for (int j = 0; j < NB_COLONNES; j++) ligne[j] = centre[j];
+            for (int py = 0; py < hauteur; py++) {
+                ligne[COL_Y] = maxY - (maxY - minY) * py / hauteur;
+                for (int px = 0; px < largeur; px++) {
+                    ligne[COL_X] = img->xs[px];
+                    int attendu = K == 1 ? predire(experts[0], ligne) : predireMulti(experts, K, ligne);
+                    int obtenu = img->labels[(size_t)py * largeur + px];
+                    if (attendu == obtenu) continue;
+                    desaccords++;
+                    // égalité aux arrondis près : deux experts (ou le score et 0) quasi égaux.
+                    double sa = K == 1 ? 0.0 : score(experts[attendu], ligne);
+                    double so = score(experts[K == 1 ? 0 : obtenu], ligne);
+                    if (fabs(sa - so) <= 1e-9 * (1.0 + fabs(sa) + fabs(so))) arrondis++;
+                }
+            }
+            double dureePredire = maintenant() - t0;
+            int identique = desaccords == arrondis;
+            if (!identique) echec = 1;
+
+            double nbPixels = (double)largeur * hauteur;
+            printf("%7d | %7.0f | %10.2f | %10.2f | %8d/%-8d | %s\n", K, echelles[b], dureeImage * 1e9 / nbPixels,
+                   dureePredire * 1e9 / nbPixels, desaccords, arrondis, identique ? "oui" : "NON");
+            for (int k = 0; k < K; k++) libererPerceptron(experts[k]);
+        }
+    }
+
+    libererImageDecision(img);
+    libererDataSet(ds);
+    return echec;
+}
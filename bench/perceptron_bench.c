@@ -0,0 +1,316 @@
+// suite de benchmarks des chemins critiques sur des données synthétiques :
+// chargement, split, statistiques, entrainement, prédiction, rendu et sauvegardes.
+// sortie JSON sur stdout (les messages de la bibliothèque partent sur stderr).
+// chaque scenario tourne dans un processus fils : la bibliothèque fait exit(1) sur une
+// erreur, un scenario qui échoue est alors noté en erreur sans couper le JSON.
+// usage : perceptron_bench                      (suite par défaut)
+//         perceptron_bench lignes colones classes [epoques] [threads]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "dataSet.h"
+#include "perceptron.h"
+#include "parallele.h"
+#include "raster.h"
+#include "statistiques.h"
+
+typedef struct {
+    int lignes;
+    int colonnes;
+    int classes;
+    int epoques;
+    int threads;
+} Scenario;
+
+static FILE *json;
+
+static long rssPicKo(void) {
+    struct rusage r;
+    getrusage(RUSAGE_SELF, &r);
+    return r.ru_maxrss;
+}
+
+// les champs portent le nom de l'unité mesurée : "lignes" / "lignes_par_s" / "ns_par_ligne"
+// pour les lignes, "experts" / "experts_par_s" / "ns_par_expert" pour les modeles, etc.
+static void ecrireMesure(int *premier, const char *operation, double secondes, double quantite,
+                         const char *unites, const char *unite) {
+    fprintf(json, "%s\n      {\"operation\": \"%s\", \"secondes\": %.6f, \"%s\": %.0f, "
+                  "\"%s_par_s\": %.1f, \"ns_par_%s\": %.3f, \"rss_pic_ko\": %ld}",
+            *premier ? "" : ",", operation, secondes, unites, quantite, unites,
+            secondes > 0 ? quantite / secondes : 0.0, unite, quantite > 0 ? secondes * 1e9 / quantite : 0.0,
+            rssPicKo());
+    *premier = 0;
+}
+
+#define mesureLignes(premier, operation, secondes, n) \
+    ecrireMesure(premier, operation, secondes, n, "lignes", "ligne")
+
+// fichiers écrits par un scenario dans le dossier temporaire.
+#define FICHIER_CSV "synthetique.csv"
+#define FICHIER_SCENARIO "scenario.json"
+#define FICHIER_DATASET "DataSet/bench.bin"
+#define FICHIER_MODELE "Perceptron/bench.bin"
+
+// csv synthétique : un centre par classe, bruit uniforme autour. retourne 0 en cas d'échec.
+static int genererCSV(const char *chemin, const Scenario *s) {
+    FILE *f = fopen(chemin, "w");
+    if (!f) {
+        fprintf(stderr, "impossible d'ecrire %s\n", chemin);
+        return 0;
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+    for (int j = 0; j < s->colonnes; j++) fprintf(f, "x%d,", j);
+    fprintf(f, "label\n");
+    double *centres = malloc(sizeof(double) * (size_t)s->classes * (size_t)s->colonnes);
+    for (size_t k = 0; k < (size_t)s->classes * (size_t)s->colonnes; k++)
+        centres[k] = (double)rand() / RAND_MAX * 2.0 - 1.0;
+    for (int i = 0; i < s->lignes; i++) {
+        int c = rand() % s->classes;
+        const double *centre = centres + (size_t)c * (size_t)s->colonnes;
+        for (int j = 0; j < s->colonnes; j++)
+            fprintf(f, "%.5f,", centre[j] + ((double)rand() / RAND_MAX - 0.5));
+        fprintf(f, "c%d\n", c);
+    }
+    free(centres);
+    return fclose(f) == 0;
+}
+
+static void entete(FILE *f, const Scenario *s) {
+    fprintf(f, "\n  {\"lignes\": %d, \"colonnes\": %d, \"classes\": %d, \"epoques\": %d, \"threads\": %d, ",
+            s->lignes, s->colonnes, s->classes, s->epoques, s->threads);
+}
+
+// écrit l'objet JSON du scenario dans json. retourne 0 en cas d'échec.
+static int executerScenario(const Scenario *s) {
+    const char *csv = FICHIER_CSV;
+    srand(1234);
+    if (!genererCSV(csv, s)) return 0;
+
+    entete(json, s);
+    fprintf(json, "\"mesures\": [");
+    int premier = 1;
+    double t0;
+
+    t0 = maintenant();
+    DataSet *ds = createDataSet(csv);
+    if (!ds) return 0;
+    mesureLignes(&premier, "createDataSet", maintenant() - t0, ds->n);
+
+    if (s->threads != 1) {
+        t0 = maintenant();
+        DataSet *dsPar = createDataSetParallele(csv, s->threads);
+        if (!dsPar) return 0;
+        mesureLignes(&premier, "createDataSetParallele", maintenant() - t0, dsPar->n);
+        libererDataSet(dsPar);
+    }
+    unlink(csv);
+
+    srand(42);
+    t0 = maintenant();
+    melanger(ds);
+    mesureLignes(&premier, "melanger", maintenant() - t0, ds->n);
+
+    // statistiques : une mesure = toutes les colones. le premier apel remplit le cache.
+    volatile double puits = 0;
+    t0 = maintenant();
+    puits += statistiquesDataSet(ds, s->threads)->colonnes[0].mediane;
+    mesureLignes(&premier, "statistiquesDataSet", maintenant() - t0, ds->n);
+    t0 = maintenant();
+    for (int j = 0; j < ds->nbColonne; j++) puits += moyenne(ds, j) + ecartType(ds, j) + mediane(ds, j);
+    mesureLignes(&premier, "statistiquesEnCache", maintenant() - t0, ds->n);
+
+    // entrainement : une ligne = une ligne du train parcourue pendant une époque.
+    Perceptron *p = createPerceptron(ds->nbColonne, s->epoques);
+    p->pasApprentissage = 0.01;
+    t0 = maintenant();
+    entrainerPerceptron(ds, p);
+    mesureLignes(&premier, "entrainerPerceptron", maintenant() - t0, (double)ds->nTrain * s->epoques);
+
+    int K = compterClasses(ds);
+    Perceptron **experts = malloc(sizeof(Perceptron *) * (size_t)K);
+    for (int k = 0; k < K; k++) {
+        experts[k] = createPerceptron(ds->nbColonne, s->epoques);
+        experts[k]->pasApprentissage = 0.01;
+    }
+    t0 = maintenant();
+    entrainerMultiClasse(experts, K, ds);
+    mesureLignes(&premier, "entrainerMultiClasse", maintenant() - t0, (double)ds->nTrain * s->epoques);
+
+    if (s->threads != 1) {
+        Perceptron **expertsPar = malloc(sizeof(Perceptron *) * (size_t)K);
+        for (int k = 0; k < K; k++) {
+            expertsPar[k] = createPerceptron(ds->nbColonne, s->epoques);
+            expertsPar[k]->pasApprentissage = 0.01;
+        }
+        t0 = maintenant();
+        entrainerMultiClasseParallele(expertsPar, K, ds, s->threads);
+        mesureLignes(&premier, "entrainerMultiClasseParallele", maintenant() - t0,
+                     (double)ds->nTrain * s->epoques);
+        for (int k = 0; k < K; k++) libererPerceptron(expertsPar[k]);
+        free(expertsPar);
+    }
+
+    t0 = maintenant();
+    puits += accuracy(p, ds);
+    mesureLignes(&premier, "accuracy", maintenant() - t0, ds->nTest);
+    t0 = maintenant();
+    puits += accuracyMulti(experts, K, ds);
+    mesureLignes(&premier, "accuracyMulti", maintenant() - t0, ds->nTest);
+
+    int *predictions = malloc(sizeof(int) * (size_t)ds->n);
+    t0 = maintenant();
+    for (int i = 0; i < ds->n; i++) predictions[i] = predireMulti(experts, K, ligneData(ds, i));
+    mesureLignes(&premier, "predireMulti", maintenant() - t0, ds->n);
+    t0 = maintenant();
+    predireMultiBatch(experts, K, ds->donnees, ds->stride, NULL, ds->n, predictions);
+    mesureLignes(&premier, "predireMultiBatch", maintenant() - t0, ds->n);
+    free(predictions);
+
+    // rendu des zones de décision 1000x700 sur les deux premieres colones.
+    if (ds->nbColonne >= 2) {
+        ImageDecision *img = creerImageDecision(1000, 700);
+        double *centre = malloc(sizeof(double) * (size_t)ds->nbColonne);
+        double minX, maxX, minY, maxY;
+        cadrerDecision(ds, 0, 1, centre, &minX, &maxX, &minY, &maxY);
+        t0 = maintenant();
+        rasteriserDecision(img, experts, K, 0, 1, centre, minX, maxX, minY, maxY, s->threads);
+        ecrireMesure(&premier, "rasteriserDecision", maintenant() - t0, (double)img->largeur * img->hauteur,
+                     "pixels", "pixel");
+        free(centre);
+        libererImageDecision(img);
+    }
+
+    // allers-retours disque (dans le dossier temporaire courant).
+    t0 = maintenant();
+    sauvegarderDataSetSpecial(ds, "bench.bin");
+    mesureLignes(&premier, "sauvegarderDataSetSpecial", maintenant() - t0, ds->n);
+    t0 = maintenant();
+    DataSet *relu = chargerDataSetSpecial("bench.bin");
+    if (!relu) return 0;
+    mesureLignes(&premier, "chargerDataSetSpecial", maintenant() - t0, relu->n);
+    libererDataSet(relu);
+    unlink(FICHIER_DATASET);
+
+    // le modele ne contient que les poids : l'unité est l'expert, pas la ligne.
+    t0 = maintenant();
+    sauvegarderModele(experts, K, ds, "bench.bin");
+    ecrireMesure(&premier, "sauvegarderModele", maintenant() - t0, K, "experts", "expert");
+    t0 = maintenant();
+    Modele *m = chargerModele("bench.bin");
+    if (!m) return 0;
+    ecrireMesure(&premier, "chargerModele", maintenant() - t0, K, "experts", "expert");
+    libererModele(m);
+    unlink(FICHIER_MODELE);
+
+    fprintf(json, "\n    ]}");
+
+    for (int k = 0; k < K; k++) libererPerceptron(experts[k]);
+    free(experts);
+    libererPerceptron(p);
+    libererDataSet(ds);
+    return 1;
+}
+
+// lance le scenario dans un fils qui écrit son objet JSON dans FICHIER_SCENARIO ; le pere
+// le recopie si le fils a réussi, sinon écrit un objet {"erreur": ...}. les fichiers
+// temporaires sont supprimés dans les deux cas. retourne 0 si le scenario a échoué.
+static int lancerScenario(const Scenario *s, FILE *sortie, int premierScenario) {
+    fprintf(stderr, "scenario : %d lignes, %d colones, %d classes\n", s->lignes, s->colonnes, s->classes);
+    fflush(stdout);
+    fflush(sortie);
+    int statut = -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        json = fopen(FICHIER_SCENARIO, "w");
+        int ok = json && executerScenario(s);
+        if (json && fclose(json) != 0) ok = 0;
+        exit(ok ? 0 : 1);
+    }
+    if (pid > 0) waitpid(pid, &statut, 0);
+    int reussi = pid > 0 && WIFEXITED(statut) && WEXITSTATUS(statut) == 0;
+
+    fprintf(sortie, "%s", premierScenario ? "" : ",");
+    FILE *f = reussi ? fopen(FICHIER_SCENARIO, "r") : NULL;
+    if (f) {
+        char tampon[4096];
+        size_t lu;
+        while ((lu = fread(tampon, 1, sizeof(tampon), f)) > 0) fwrite(tampon, 1, lu, sortie);
+        fclose(f);
+    } else {
+        reussi = 0;
+        entete(sortie, s);
+        if (pid > 0 && WIFSIGNALED(statut))
+            fprintf(sortie, "\"erreur\": \"signal %d\"}", WTERMSIG(statut));
+        else
+            fprintf(sortie, "\"erreur\": \"code %d\"}", pid > 0 && WIFEXITED(statut) ? WEXITSTATUS(statut) : -1);
+        fprintf(stderr, "scenario en echec, on passe au suivant.\n");
+    }
+    fflush(sortie);
+    unlink(FICHIER_SCENARIO);
+    unlink(FICHIER_CSV);
+    unlink(FICHIER_DATASET);
+    unlink(FICHIER_MODELE);
+    return reussi;
+}
+
+int main(int argc, char **argv) {
+    // stdout ne garde que le JSON : les printf de la bibliothèque vont sur stderr.
+    fflush(stdout);
+    int fdJson = dup(STDOUT_FILENO);
+    json = fdJson >= 0 ? fdopen(fdJson, "w") : NULL;
+    if (json == NULL || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) return 1;
+
+    Scenario suite[] = {
+        { 1000, 2, 2, 20, 0 },
+        { 100000, 8, 3, 5, 0 },
+        { 1000000, 16, 10, 2, 0 },
+        { 2000, 4096, 2, 2, 0 },
+        { 100000, 32, 100, 2, 0 },
+    };
+    int nbScenarios = (int)(sizeof(suite) / sizeof(suite[0]));
+    if (argc >= 4) {
+        suite[0].lignes = atoi(argv[1]);
+        suite[0].colonnes = atoi(argv[2]);
+        suite[0].classes = atoi(argv[3]);
+        suite[0].epoques = argc > 4 ? atoi(argv[4]) : 5;
+        suite[0].threads = argc > 5 ? atoi(argv[5]) : 0;
+        nbScenarios = 1;
+    } else if (argc != 1) {
+        fprintf(stderr, "usage : perceptron_bench [lignes colones classes [epoques] [threads]]\n");
+        return 1;
+    }
+    for (int s = 0; s < nbScenarios; s++) {
+        if (suite[s].lignes < 10 || suite[s].colonnes < 1 || suite[s].classes < 2) {
+            fprintf(stderr, "parametres invalides : il faut au moins 10 lignes, 1 colone et 2 classes.\n");
+            return 1;
+        }
+        if (suite[s].threads <= 0) suite[s].threads = nbThreadsParDefaut();
+    }
+
+    // les sauvegardes écrivent dans DataSet/ et Perceptron/ : on travaille dans un dossier temporaire.
+    char dossier[] = "/tmp/perceptron_bench_XXXXXX";
+    if (!mkdtemp(dossier) || chdir(dossier) != 0) {
+        fprintf(stderr, "impossible de creer un dossier temporaire\n");
+        return 1;
+    }
+    mkdir("DataSet", 0755);
+    mkdir("Perceptron", 0755);
+
+    FILE *sortie = json;
+    int echecs = 0;
+    fprintf(sortie, "{\"benchmark\": \"perceptron\", \"threads_max\": %d, \"scenarios\": [", nbThreadsParDefaut());
+    for (int s = 0; s < nbScenarios; s++) echecs += !lancerScenario(&suite[s], sortie, s == 0);
+    fprintf(sortie, "\n]}\n");
+    fclose(sortie);
+
+    rmdir("DataSet");
+    rmdir("Perceptron");
+    if (chdir("/") == 0) rmdir(dossier);
+    return echecs != 0;
+}
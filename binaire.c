@@ -0,0 +1,39 @@
+#include "binaire.h"
+#include <string.h>
+
+uint64_t aligner64(uint64_t x) {
+    return (x + 63) & ~(uint64_t)63;
+}
+
+uint64_t ecrireChaine(FILE *f, const char *s) {
+    uint32_t n = (uint32_t)strlen(s);
+    fwrite(&n, sizeof(n), 1, f);
+    fwrite(s, 1, n, f);
+    return sizeof(n) + (uint64_t)n;
+}
+
+void completerJusqua(FILE *f, uint64_t *position, uint64_t cible) {
+    static const char zeros[64] = {0};
+    while (*position < cible) {
+        uint64_t n = cible - *position < 64 ? cible - *position : 64;
+        fwrite(zeros, 1, (size_t)n, f);
+        *position += n;
+    }
+}
+
+const char *lireChaine(const char **p, const char *fin, uint32_t *longueur) {
+    uint32_t n;
+    if (*p > fin || (size_t)(fin - *p) < sizeof(n)) return NULL;
+    memcpy(&n, *p, sizeof(n));
+    *p += sizeof(n);
+    if ((size_t)(fin - *p) < n) return NULL;
+    const char *debut = *p;
+    *p += n;
+    *longueur = n;
+    return debut;
+}
+
+int tableauDansFichier(uint64_t offset, uint64_t nb, uint64_t taille, uint64_t tailleFichier) {
+    if (offset % 8 != 0 || offset > tailleFichier) return 0;
+    return nb <= (tailleFichier - offset) / taille;
+}
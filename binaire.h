@@ -0,0 +1,25 @@
+#ifndef BINAIRE_H_
+#define BINAIRE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+// outils communs aux formats binaires projetés en mémoire (datasets et modeles).
+
+// arrondi au multiple de 64 supérieur (début des tableaux dans un fichier).
+uint64_t aligner64(uint64_t x);
+
+// chaine en longueur (uint32) + octets. retourne le nombre d'octets écrits.
+uint64_t ecrireChaine(FILE *f, const char *s);
+// écrit des zéros de *position jusqu'à cible.
+void completerJusqua(FILE *f, uint64_t *position, uint64_t cible);
+
+// lit une chaine écrite par ecrireChaine dans [*p, fin) : retourne le début de ses octets
+// (non terminés par \0) et sa longueur, ou NULL si elle dépasse fin. avance *p.
+const char *lireChaine(const char **p, const char *fin, uint32_t *longueur);
+
+// vrai si nb éléments de taille octets à partir de offset tiennent dans tailleFichier
+// octets (sans débordement des calculs) et si offset est aligné sur 8 octets.
+int tableauDansFichier(uint64_t offset, uint64_t nb, uint64_t taille, uint64_t tailleFichier);
+
+#endif //BINAIRE_H_
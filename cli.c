@@ -0,0 +1,453 @@
+#include "cli.h"
+#include "dataSet.h"
+#include "normalisation.h"
+#include "perceptron.h"
+#include "parallele.h"
+#include "precision.h"
+#include "raster.h"
+#include "suivi.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    const char *commande;
+    const char *data;
+    const char *model;
+    int epoques;
+    double pasApprentissage;
+    int nbThreads;
+    int tailleBatch;
+    unsigned int graine;
+    int normalisation;
+    int modeApprentissage;
+    int patience;
+    double partValidation;
+    double budgetSecondes;
+    int precision;
+    const char *image;
+    int colX, colY;
+    int largeur, hauteur;
+} OptionsCLI;
+
+// temps et débit d'une étape, sur stderr pour laisser stdout aux résultats.
+// lignes <= 0 : étape sans débit (lecture ou écriture du modele).
+static void afficherEtapeUnite(const char *nom, double duree, double lignes, const char *unite) {
+    if (lignes <= 0) {
+        fprintf(stderr, "[temps] %-12s : %8.3fs\n", nom, duree);
+        return;
+    }
+    fprintf(stderr, "[temps] %-12s : %8.3fs | %12.0f %s/s\n", nom, duree, duree > 0 ? lignes / duree : 0.0, unite);
+}
+
+static void afficherEtape(const char *nom, double duree, double lignes) {
+    afficherEtapeUnite(nom, duree, lignes, "lignes");
+}
+
+static void afficherUsage(void) {
+    fprintf(stderr,
+            "usage :\n"
+            "  peceptron train   --data fichier.csv --model nom [--epochs N] [--lr x] [--threads T]\n"
+            "                    [--batch B] [--seed S] [--normalize standard|minmax]\n"
+            "                    [--patience P] [--validation part] [--budget secondes]\n"
+            "                    [--mode classique|pocket|moyenne] [--precision double|float|int8]\n"
+            "  peceptron eval    --data fichier.csv --model nom [--threads T] [--precision P]\n"
+            "  peceptron predict --data fichier.csv --model nom [--threads T] [--precision P]\n"
+            "  peceptron render  --data fichier.csv --model nom --out image.ppm [--cols X,Y]\n"
+            "                    [--width W] [--height H] [--threads T]\n"
+            "le modele est lu / ecrit dans Perceptron/<nom>. --threads 0 = un par coeur.\n"
+            "un fichier .svm ou .libsvm est lu au format libsvm (lignes creuses).\n");
+}
+
+static int lireOptions(int argc, char **argv, OptionsCLI *o) {
+    o->commande = argv[1];
+    o->data = NULL;
+    o->model = NULL;
+    o->epoques = 1000;
+    o->pasApprentissage = 0.01;
+    o->nbThreads = 0;
+    o->tailleBatch = 0;
+    o->graine = 42;
+    o->normalisation = NORMALISATION_AUCUNE;
+    o->modeApprentissage = MODE_CLASSIQUE;
+    o->patience = 0;
+    o->partValidation = 0;
+    o->budgetSecondes = 0;
+    o->precision = -1;
+    o->image = NULL;
+    o->colX = 0;
+    o->colY = 1;
+    o->largeur = 1000;
+    o->hauteur = 700;
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "[!] valeur manquante pour %s\n", argv[i]);
+            return 0;
+        }
+        const char *cle = argv[i];
+        const char *valeur = argv[++i];
+        if (strcmp(cle, "--data") == 0) o->data = valeur;
+        else if (strcmp(cle, "--model") == 0) o->model = valeur;
+        else if (strcmp(cle, "--epochs") == 0) o->epoques = atoi(valeur);
+        else if (strcmp(cle, "--lr") == 0) o->pasApprentissage = atof(valeur);
+        else if (strcmp(cle, "--threads") == 0) o->nbThreads = atoi(valeur);
+        else if (strcmp(cle, "--batch") == 0) o->tailleBatch = atoi(valeur);
+        else if (strcmp(cle, "--seed") == 0) o->graine = (unsigned int)strtoul(valeur, NULL, 10);
+        else if (strcmp(cle, "--normalize") == 0) {
+            o->normalisation = typeNormalisationDepuisNom(valeur);
+            if (o->normalisation < 0) {
+                fprintf(stderr, "[!] --normalize attend aucune, standard ou minmax\n");
+                return 0;
+            }
+        }
+        else if (strcmp(cle, "--mode") == 0) {
+            if (strcmp(valeur, "classique") == 0) o->modeApprentissage = MODE_CLASSIQUE;
+            else if (strcmp(valeur, "pocket") == 0) o->modeApprentissage = MODE_POCKET;
+            else if (strcmp(valeur, "moyenne") == 0) o->modeApprentissage = MODE_MOYENNE;
+            else {
+                fprintf(stderr, "[!] --mode attend classique, pocket ou moyenne\n");
+                return 0;
+            }
+        }
+        else if (strcmp(cle, "--precision") == 0) {
+            o->precision = precisionDepuisNom(valeur);
+            if (o->precision < 0) {
+                fprintf(stderr, "[!] --precision attend double, float ou int8\n");
+                return 0;
+            }
+        }
+        else if (strcmp(cle, "--patience") == 0) o->patience = atoi(valeur);
+        else if (strcmp(cle, "--validation") == 0) o->partValidation = atof(valeur);
+        else if (strcmp(cle, "--budget") == 0) o->budgetSecondes = atof(valeur);
+        else if (strcmp(cle, "--out") == 0) o->image = valeur;
+        else if (strcmp(cle, "--width") == 0) o->largeur = atoi(valeur);
+        else if (strcmp(cle, "--height") == 0) o->hauteur = atoi(valeur);
+        else if (strcmp(cle, "--cols") == 0) {
+            if (sscanf(valeur, "%d,%d", &o->colX, &o->colY) != 2) {
+                fprintf(stderr, "[!] --cols attend deux numeros de colone : X,Y\n");
+                return 0;
+            }
+        }
+        else {
+            fprintf(stderr, "[!] option inconnue : %s\n", cle);
+            return 0;
+        }
+    }
+    if (o->data == NULL || o->model == NULL) {
+        fprintf(stderr, "[!] --data et --model sont obligatoires.\n");
+        return 0;
+    }
+    return 1;
+}
+
+// numéro de classe du modele pour chaque label du dataset (-1 si le modele ne la connait pas).
+// un modele sans noms de classes (ancien format) garde les numéros du dataset.
+static int *correspondanceClasses(const Modele *m, const DataSet *ds, int nbClassesData) {
+    int *corresp = malloc(sizeof(int) * (size_t)(nbClassesData > 0 ? nbClassesData : 1));
+    for (int c = 0; c < nbClassesData; c++) {
+        corresp[c] = c;
+        if (m->classes.nb == 0 || c >= ds->nomsClasses.nb) continue;
+        corresp[c] = chercherLabel(&m->classes, ds->nomsClasses.noms[c]);
+    }
+    return corresp;
+}
+
+// prédit toutes les lignes du dataset (pas de split) avec le modele chargé, dans sa precision.
+static void predireTout(const Modele *m, const DataSet *ds, int *sortie) {
+    predireModele(m, ds, NULL, ds->n, sortie);
+}
+
+// charge le modele, choisit la precision (celle du fichier sans --precision) et aplique
+// sa normalisation aux données brutes.
+static Modele *chargerModeleCompatible(const OptionsCLI *o, DataSet *ds) {
+    double t0 = maintenant();
+    Modele *m = chargerModele(o->model);
+    if (m == NULL) return NULL;
+    if (o->precision >= 0) choisirPrecisionModele(m, o->precision);
+    afficherEtape("modele", maintenant() - t0, 0);
+    if (m->precision != PRECISION_DOUBLE) fprintf(stderr, "[precision] poids en %s\n", nomPrecision(m->precision));
+    // un fichier libsvm n'a pas forcément de valeur dans les dernieres colones du modele.
+    if (ds->creux && ds->nbColonne < m->nPoids) elargirDataSetCreux(ds, m->nPoids);
+    if (m->nPoids != ds->nbColonne) {
+        fprintf(stderr, "[!] Le modele attend %d colonnes, le dataset en a %d.\n", m->nPoids, ds->nbColonne);
+        libererModele(m);
+        return NULL;
+    }
+    if (m->normalisation.type != NORMALISATION_AUCUNE) {
+        t0 = maintenant();
+        if (!appliquerNormalisation(ds, &m->normalisation, o->nbThreads)) {
+            libererModele(m);
+            return NULL;
+        }
+        afficherEtape("normalisation", maintenant() - t0, (double)ds->n);
+    }
+    return m;
+}
+
+static DataSet *chargerDonnees(const OptionsCLI *o) {
+    double t0 = maintenant();
+    DataSet *ds = createDataSetParallele(o->data, o->nbThreads);
+    afficherEtape("chargement", maintenant() - t0, (double)ds->n);
+    return ds;
+}
+
+// progression de l'entrainement, affichée par un thread à part qui lit l'historique
+// du suivi : la boucle d'entrainement n'écrit que dans l'anneau.
+typedef struct {
+    const SuiviEntrainement *suivi;
+    pthread_mutex_t verrou;
+    pthread_cond_t fin;
+    int termine;
+} Progression;
+
+static void *afficherProgression(void *arg) {
+    Progression *pr = arg;
+    int dernier = 0;
+    pthread_mutex_lock(&pr->verrou);
+    while (!pr->termine) {
+        struct timespec echeance;
+        clock_gettime(CLOCK_REALTIME, &echeance);
+        echeance.tv_sec += 1;
+        pthread_cond_timedwait(&pr->fin, &pr->verrou, &echeance);
+        int train, validation, premiere;
+        if (pr->termine || lireHistorique(pr->suivi, &train, &validation, 1, &premiere) == 0 || premiere < dernier)
+            continue;
+        dernier = premiere + 1;
+        if (validation >= 0) fprintf(stderr, "[epoque %6d] erreurs train %d | validation %d\n", dernier, train, validation);
+        else fprintf(stderr, "[epoque %6d] erreurs train %d\n", dernier, train);
+    }
+    pthread_mutex_unlock(&pr->verrou);
+    return NULL;
+}
+
+static int commandeTrain(const OptionsCLI *o) {
+    DataSet *ds = chargerDonnees(o);
+
+    double t0 = maintenant();
+    srand(o->graine);
+    melanger(ds);
+    afficherEtape("split", maintenant() - t0, (double)ds->n);
+
+    // paramètres calculés sur le train seulement, puis enregistrés avec le modele.
+    if (o->normalisation != NORMALISATION_AUCUNE) {
+        t0 = maintenant();
+        normaliserDataSet(ds, o->normalisation, o->nbThreads);
+        afficherEtape("normalisation", maintenant() - t0, (double)ds->n);
+    }
+
+    int nbClasses = compterClasses(ds);
+    int nbExperts = nbClasses <= 2 ? 1 : nbClasses;
+    Perceptron **experts = malloc(sizeof(Perceptron *) * (size_t)nbExperts);
+    for (int k = 0; k < nbExperts; k++) {
+        experts[k] = createPerceptron(ds->nbColonne, o->epoques);
+        experts[k]->pasApprentissage = o->pasApprentissage;
+        experts[k]->tailleBatch = o->tailleBatch;
+        experts[k]->nbThreads = o->nbThreads;
+        experts[k]->modeApprentissage = o->modeApprentissage;
+    }
+
+    SuiviEntrainement *suivi = creerSuivi(1024);
+    suivi->patience = o->patience;
+    suivi->partValidation = o->partValidation;
+    suivi->budgetSecondes = o->budgetSecondes;
+    Progression pr = { suivi, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+    pthread_t thread;
+    int avecProgression = pthread_create(&thread, NULL, afficherProgression, &pr) == 0;
+
+    t0 = maintenant();
+    if (nbExperts == 1) entrainerPerceptronSuivi(ds, experts[0], suivi);
+    else entrainerMultiClasseSuivi(experts, nbExperts, ds, o->nbThreads, suivi);
+    double duree = maintenant() - t0;
+
+    if (avecProgression) {
+        pthread_mutex_lock(&pr.verrou);
+        pr.termine = 1;
+        pthread_cond_signal(&pr.fin);
+        pthread_mutex_unlock(&pr.verrou);
+        pthread_join(thread, NULL);
+    }
+    int epoquesFaites = epoquesTerminees(suivi);
+    afficherEtape("entrainement", duree, (double)(ds->nTrain - suivi->nValidation) * epoquesFaites);
+    fprintf(stderr, "[suivi] %d epoque(s), arret : %s | meilleure epoque %d : %d erreur(s) %s\n",
+            epoquesFaites, nomArret(suivi->raisonArret), suivi->meilleureEpoque + 1, suivi->meilleuresErreurs,
+            suivi->nValidation > 0 ? "en validation" : "sur le train");
+
+    t0 = maintenant();
+    double acc = nbExperts == 1 ? accuracy(experts[0], ds) : accuracyMulti(experts, nbExperts, ds);
+    afficherEtape("evaluation", maintenant() - t0, (double)ds->nTest);
+    for (int k = 0; k < nbExperts; k++) experts[k]->accuracy = acc;
+
+    t0 = maintenant();
+    int ok = sauvegarderModelePrecision(experts, nbExperts, ds, o->model,
+                                        o->precision < 0 ? PRECISION_DOUBLE : o->precision);
+    afficherEtape("sauvegarde", maintenant() - t0, 0);
+
+    printf("classes %d | train %d | teste %d | accuracy %.4f\n", nbClasses, ds->nTrain, ds->nTest, acc);
+
+    libererSuivi(suivi);
+    for (int k = 0; k < nbExperts; k++) libererPerceptron(experts[k]);
+    free(experts);
+    libererDataSet(ds);
+    return ok ? 0 : 1;
+}
+
+static int commandeEval(const OptionsCLI *o) {
+    DataSet *ds = chargerDonnees(o);
+    Modele *m = chargerModeleCompatible(o, ds);
+    if (m == NULL) {
+        libererDataSet(ds);
+        return 1;
+    }
+
+    int nbClassesData = compterClasses(ds);
+    int *corresp = correspondanceClasses(m, ds, nbClassesData);
+    int *predictions = malloc(sizeof(int) * (size_t)ds->n);
+    double t0 = maintenant();
+    predireTout(m, ds, predictions);
+    double duree = maintenant() - t0;
+    afficherEtape("prediction", duree, (double)ds->n);
+
+    int succes = 0;
+    for (int i = 0; i < ds->n; i++) {
+        if (predictions[i] == corresp[ds->etiquettes[i]]) succes++;
+    }
+    printf("lignes %d | correctes %d | accuracy %.4f\n", ds->n, succes, (double)succes / ds->n);
+
+    // en float / int8 : écart avec les poids double du meme fichier.
+    if (m->precision != PRECISION_DOUBLE && !ds->creux) {
+        int *reference = malloc(sizeof(int) * (size_t)ds->n);
+        t0 = maintenant();
+        predireDataSet(m->experts, m->nbExperts, ds, NULL, ds->n, reference);
+        double dureeDouble = maintenant() - t0;
+        afficherEtape("double", dureeDouble, (double)ds->n);
+        int accords = 0, succesDouble = 0;
+        for (int i = 0; i < ds->n; i++) {
+            if (predictions[i] == reference[i]) accords++;
+            if (reference[i] == corresp[ds->etiquettes[i]]) succesDouble++;
+        }
+        printf("precision %s | accord avec double %.4f | accuracy double %.4f (ecart %+.4f) | vitesse x%.2f\n",
+               nomPrecision(m->precision), (double)accords / ds->n, (double)succesDouble / ds->n,
+               (double)(succes - succesDouble) / ds->n, duree > 0 ? dureeDouble / duree : 0.0);
+        free(reference);
+    }
+
+    free(predictions);
+    free(corresp);
+    libererModele(m);
+    libererDataSet(ds);
+    return 0;
+}
+
+static int commandePredict(const OptionsCLI *o) {
+    // stdout ne doit contenir que les prédictions : on garde un descripteur vers la vraie
+    // sortie et les messages du chargement (printf) partent sur stderr.
+    fflush(stdout);
+    int fdSortie = dup(STDOUT_FILENO);
+    FILE *sortie = fdSortie >= 0 ? fdopen(fdSortie, "w") : NULL;
+    if (sortie == NULL || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+        fprintf(stderr, "[!] impossible de preparer la sortie standard.\n");
+        return 1;
+    }
+    setvbuf(sortie, NULL, _IOFBF, 1 << 20);
+
+    DataSet *ds = chargerDonnees(o);
+    Modele *m = chargerModeleCompatible(o, ds);
+    if (m == NULL) {
+        libererDataSet(ds);
+        fclose(sortie);
+        return 1;
+    }
+
+    int *predictions = malloc(sizeof(int) * (size_t)ds->n);
+    double t0 = maintenant();
+    predireTout(m, ds, predictions);
+    afficherEtape("prediction", maintenant() - t0, (double)ds->n);
+
+    // une ligne par ligne du fichier : le nom de la classe si le modele le connait.
+    t0 = maintenant();
+    char numero[16];
+    for (int i = 0; i < ds->n; i++) {
+        int c = predictions[i];
+        if (c >= 0 && c < m->classes.nb) {
+            fputs(m->classes.noms[c], sortie);
+        } else {
+            snprintf(numero, sizeof(numero), "%d", c);
+            fputs(numero, sortie);
+        }
+        fputc('\n', sortie);
+    }
+    int ok = fclose(sortie) == 0;
+    afficherEtape("ecriture", maintenant() - t0, (double)ds->n);
+
+    free(predictions);
+    libererModele(m);
+    libererDataSet(ds);
+    return ok ? 0 : 1;
+}
+
+// zones de décision du modele sur les colones colX / colY, exportées en ppm.
+static int commandeRender(const OptionsCLI *o) {
+    if (o->image == NULL) {
+        fprintf(stderr, "[!] --out est obligatoire pour render.\n");
+        return 2;
+    }
+    DataSet *ds = chargerDonnees(o);
+    if (ds->creux) {
+        fprintf(stderr, "[!] render attend un csv : pas de projection sur deux colones d'un dataset creux.\n");
+        libererDataSet(ds);
+        return 1;
+    }
+    Modele *m = chargerModeleCompatible(o, ds);
+    if (m == NULL) {
+        libererDataSet(ds);
+        return 1;
+    }
+    int ok = 0;
+    ImageDecision *img = creerImageDecision(o->largeur, o->hauteur);
+    if (o->colX < 0 || o->colX >= ds->nbColonne || o->colY < 0 || o->colY >= ds->nbColonne || o->colX == o->colY) {
+        fprintf(stderr, "[!] colones invalides : %d,%d (le dataset en a %d).\n", o->colX, o->colY, ds->nbColonne);
+    } else if (img == NULL) {
+        fprintf(stderr, "[!] taille d'image invalide : %dx%d.\n", o->largeur, o->hauteur);
+    } else {
+        double *centre = malloc(sizeof(double) * (size_t)ds->nbColonne);
+        double minX, maxX, minY, maxY;
+        cadrerDecision(ds, o->colX, o->colY, centre, &minX, &maxX, &minY, &maxY);
+
+        double t0 = maintenant();
+        rasteriserDecision(img, m->experts, m->nbExperts, o->colX, o->colY, centre, minX, maxX, minY, maxY,
+                           o->nbThreads);
+        afficherEtapeUnite("rendu", maintenant() - t0, (double)o->largeur * o->hauteur, "pixels");
+
+        t0 = maintenant();
+        ok = exporterPPM(img, o->image);
+        afficherEtapeUnite("ecriture", maintenant() - t0, (double)o->largeur * o->hauteur, "pixels");
+        if (ok) printf("image %dx%d ecrite : %s\n", o->largeur, o->hauteur, o->image);
+        free(centre);
+    }
+
+    libererImageDecision(img);
+    libererModele(m);
+    libererDataSet(ds);
+    return ok ? 0 : 1;
+}
+
+int executerCLI(int argc, char **argv) {
+    OptionsCLI o;
+    if (argc < 2 || !lireOptions(argc, argv, &o)) {
+        afficherUsage();
+        return 2;
+    }
+    if (o.nbThreads > 0) definirNbThreadsParDefaut(o.nbThreads);
+
+    if (strcmp(o.commande, "train") == 0) return commandeTrain(&o);
+    if (strcmp(o.commande, "eval") == 0) return commandeEval(&o);
+    if (strcmp(o.commande, "predict") == 0) return commandePredict(&o);
+    if (strcmp(o.commande, "render") == 0) return commandeRender(&o);
+
+    fprintf(stderr, "[!] commande inconnue : %s\n", o.commande);
+    afficherUsage();
+    return 2;
+}
@@ -0,0 +1,22 @@
+#ifndef CLI_H_
+#define CLI_H_
+
+// mode ligne de commande (sans menu ni raylib) :
+//   peceptron train   --data fichier.csv --model nom [--epochs N] [--lr x] [--threads T] [--batch B] [--seed S]
+//                     [--normalize standard|minmax] [--patience P] [--validation part] [--budget secondes]
+//                     [--mode classique|pocket|moyenne] [--precision double|float|int8]
+//   peceptron eval    --data fichier.csv --model nom [--threads T] [--precision P]
+//   peceptron predict --data fichier.csv --model nom [--threads T] [--precision P]
+//   peceptron render  --data fichier.csv --model nom --out image.ppm [--cols X,Y] [--width W] [--height H]
+// --data accepte aussi un fichier libsvm (.svm ou .libsvm), gardé creux : l'entrainement et
+// la prédiction ne coûtent que le nombre de valeurs non nulles (render reste réservé aux csv).
+// le modele est lu / écrit dans Perceptron/<nom>, avec sa normalisation : eval, predict et
+// render l'apliquent d'eux memes aux données brutes. train affiche sa progression sur stderr
+// et s'arrete plus tot avec --patience (époques sans amélioration), --validation (part du
+// train mise de coté, les meilleurs poids sont gardés) ou --budget.
+// --precision : train enregistre aussi les poids en float ou en int8, eval et predict
+// prédisent avec eux (ou avec la precision demandée) ; eval compare alors au double.
+// retourne le code de sortie du programme.
+int executerCLI(int argc, char **argv);
+
+#endif //CLI_H_
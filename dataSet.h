@@ -2,32 +2,124 @@
 #define DATASET_H_
 
 #include <stddef.h>
+#include "labels.h"
+
+// normalisation des colones : x' = (x - decalage[j]) * echelle[j].
+// les paramètres viennent du train et sont gardés avec le modele.
+#define NORMALISATION_AUCUNE 0
+#define NORMALISATION_STANDARD 1
+#define NORMALISATION_MINMAX 2
+
+typedef struct Normalisation {
+    int type;
+    int nbColonne;
+    double *decalage;
+    double *echelle;
+} Normalisation;
+
+// stockage creux (csr) : les valeurs non nulles de la ligne i sont
+// valeurs[debutLigne[i] .. debutLigne[i + 1]), aux colones colonnes[...] (croissantes).
+typedef struct MatriceCreuse {
+    size_t *debutLigne;
+    int *colonnes;
+    double *valeurs;
+    size_t nnz;
+} MatriceCreuse;
 
 typedef struct DataSet {
     char *nom;
+    // matrice contiguë ligne par ligne (alignée sur 64 octets).
+    // la ligne i commence à donnees + i * stride.
+    double *donnees;
+    int stride;
+    // labels de toutes les lignes de donnees, et les noms de classe corespondants.
+    int *etiquettes;
+    DictionnaireLabels nomsClasses;
+    // permutation des lignes : les nTrain premiers indices forment le train,
+    // les nTest suivants le teste. aucune ligne n'est recopiée au split.
+    int *indexSplit;
+    // vues sur les lignes de donnees (compatibilité double**).
     double **tab_Data;
     double **tab_Teste;
     double **tab_Train;
     int nTrain;
     int nTest;
+    // labels du teste et du train dans l'ordre de indexSplit.
     int *sortieAttendue_Teste;
     int *sortieAttendue_train;
     int n;
     int nbColonne;
     char **nomColonne;
+    // fichier binaire projeté en mémoire (chargerDataSetSpecial) : donnees, etiquettes,
+    // indexSplit et les labels du split pointent directement dedans.
+    void *mmapBase;
+    size_t mmapTaille;
+    // statistiques des colones (statistiques.h), calculées à la demande. NULL si pas encore
+    // calculées ou si les données ont changé depuis.
+    struct StatistiquesDataSet *stats;
+    // normalisation déjà apliquée à donnees (type NORMALISATION_AUCUNE si données brutes).
+    Normalisation normalisation;
+    // dataset creux (fichier libsvm) : les lignes sont dans creux, donnees et les vues
+    // tab_* restent NULL. NULL pour un dataset dense.
+    MatriceCreuse *creux;
+    // arène (arene.h) qui porte le dataset lui meme, la matrice, les labels, les noms et les
+    // tampons du split : libererDataSet la rend au systeme d'un coup. un dataset construit à
+    // la main n'en a pas (ses tableaux sont libérés un par un) avant son premier melanger.
+    struct Arene *arene;
 } DataSet;
 
+// acces direct à une ligne sans passer par les tableaux de pointeurs.
+static inline double *ligneData(const DataSet *ds, int i) {
+    return ds->donnees + (size_t)i * (size_t)ds->stride;
+}
+
+// la i-ème ligne du train / du teste passe par l'index du split.
+static inline double *ligneTrain(const DataSet *ds, int i) {
+    return ligneData(ds, ds->indexSplit[i]);
+}
+
+static inline double *ligneTeste(const DataSet *ds, int i) {
+    return ligneData(ds, ds->indexSplit[ds->nTrain + i]);
+}
+
+// ligne i d'un dataset creux : retourne son nombre de valeurs non nulles.
+static inline int ligneCreuse(const DataSet *ds, int i, const int **colonnes, const double **valeurs) {
+    size_t debut = ds->creux->debutLigne[i];
+    *colonnes = ds->creux->colonnes + debut;
+    *valeurs = ds->creux->valeurs + debut;
+    return (int)(ds->creux->debutLigne[i + 1] - debut);
+}
+
+// lit un csv, ou un fichier libsvm (extension .svm ou .libsvm) en dataset creux.
 DataSet* createDataSet(const char *fichier);
-void melanger(const DataSet *data);
+DataSet* createDataSetParallele(const char *fichier, int nbThreads);
+// format libsvm : une ligne par exemple, "label colone:valeur colone:valeur ...", colones
+// numérotées à partir de 1 et absentes = 0. les commentaires (#) et "qid:" sont ignorés.
+DataSet* createDataSetLibsvm(const char *fichier);
+// valeur (ligne, colone) quel que soit le stockage.
+double valeurDataSet(const DataSet *ds, int ligne, int colonne);
+// un fichier creux ne connait que les colones qu'il utilise : on l'étend à nbColonne
+// colones (les nouvelles sont nulles) pour l'utiliser avec un modele plus large.
+// retourne 0 si le dataset est dense ou a déjà plus de colones.
+int elargirDataSetCreux(DataSet *ds, int nbColonne);
+void melanger(DataSet *ds);
 void libererDataSet(DataSet *data);
 
+// lisent les statistiques gardées dans le dataset (calculées au premier apel).
 double moyenne(DataSet *d, int colIndex);
 double ecartType(DataSet *d, int colIndex);
 double mediane(DataSet *d, int colIndex);
 
+int calculerStride(int nbColonne);
+double *allocMatrice(int n, int stride);
+double **creerVuesLignes(double *matrice, int n, int stride);
+
 void afficherDonnees(const DataSet *ds);
 void sauvegarderSplit(const DataSet *ds, const char *nomDataset);
 void sauvegarderDataSetSpecial(const DataSet *ds, const char *nomFichier);
 DataSet* chargerDataSetSpecial(const char *nomFichier);
+void listerFichiersDataSet();
+
+int compterClasses(const DataSet *ds);
 
-#endif
\ No newline at end of file
+#endif
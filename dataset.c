@@ -1,10 +1,21 @@
 #include "dataSet.h"
+#include "arene.h"
+#include "binaire.h"
+#include "parallele.h"
+#include "statistiques.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <time.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <limits.h>
+#include <dirent.h>
 
 /* ================= UTILITAIRES INTERNES ================= */
 
@@ -22,240 +33,712 @@ static void *xcalloc(size_t n, size_t s){
     return p;
 }
 
-// copie une chaine de caractere dans un nouvel espace mémoire aloué.
-static char *xstrdup(const char *s){
-    char *d = (char*)xmalloc(strlen(s)+1);
-    strcpy(d, s);
-    return d;
+// avance debut / recule fin pour enlever les espaces autour de [debut, fin).
+static void trimIntervalle(const char **debut, const char **fin){
+    while(*debut < *fin && isspace((unsigned char)**debut)) (*debut)++;
+    while(*fin > *debut && isspace((unsigned char)(*fin)[-1])) (*fin)--;
 }
 
-// retire les retours à la ligne \n et \r à la fin d'une chaine.
-static void rstrip(char *s){
-    int n = (int)strlen(s);
-    while( n>0 && (s[n-1] == '\n' || s[n-1] == '\r')){ s[n-1] = '\0'; n-- ; }
+// dataset vide dont la structure est la premiere alocation de sa propre arène.
+static DataSet *nouveauDataSet(void){
+    Arene *arene = creerArene(0);
+    DataSet *ds = allouerArene(arene, sizeof(DataSet), 0);
+    ds->arene = arene;
+    return ds;
 }
 
-// enlève les espaces au début et à la fin d'un texte.
-static char *trim(char *s){
-    while(isspace((unsigned char)*s)) s++;
-    if(*s == 0) return s;
-    char *end = s + strlen(s) - 1;
-    while(end > s && isspace((unsigned char)*end)) end--;
-    end[1] = '\0';
-    return s;
+// alocation qui vit aussi longtemps que le dataset (mémoire à zéro). un dataset construit à
+// la main reçoit son arène au premier apel.
+static void *allouerDataSet(DataSet *ds, size_t taille, size_t alignement){
+    if(!ds->arene) ds->arene = creerArene(0);
+    return allouerArene(ds->arene, taille > 0 ? taille : 1, alignement);
 }
 
-// compte le nombre de virgules pour savoir combien il y a de colones.
-static int countTokens(const char *l){
-    int c = 1;
-    for(int i = 0; l[i] ; i++ ) if(l[i] == ',') c++;
-    return c;
+// copie [debut, fin) dans l'arène du dataset.
+static char *copierChaineDataSet(DataSet *ds, const char *debut, const char *fin){
+    if(!ds->arene) ds->arene = creerArene(0);
+    return copierChaineArene(ds->arene, debut, (size_t)(fin - debut));
 }
 
-// découpe une ligne csv en plusieur morceaux en utilisant la virgule.
-static int splitCSV(char *line, char **tokens, int max){
-    int k = 0;
-    char *save = NULL;
-    char *tok = strtok_r(line, ",", &save);
-    while(tok && k < max){
-        tokens[k++] = trim(tok);
-        tok = strtok_r(NULL, ",", &save);
+// lit un nombre décimal dans [debut, fin) sans recopier le texte.
+// cas courant (au plus 2^53 pour la mantisse et 10^22 pour l'exposant) : le résultat est
+// calculé directement et arrondi exactement comme strtod. sinon on se rabat sur strtod.
+// retourne 0 si le texte entier n'est pas un nombre valide.
+static int lireNombre(const char *debut, const char *fin, double *valeur){
+    static const double puissances[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char *p = debut;
+    int negatif = 0;
+    if(p < fin && (*p == '-' || *p == '+')){ negatif = (*p == '-'); p++; }
+    unsigned long long mantisse = 0;
+    int chiffres = 0, exposant = 0, trop = 0;
+    const char *debutChiffres = p;
+    while(p < fin && *p >= '0' && *p <= '9'){
+        if(mantisse < 100000000000000000ULL) mantisse = mantisse * 10 + (unsigned)(*p - '0');
+        else { trop = 1; exposant++; }
+        chiffres++; p++;
+    }
+    if(p < fin && *p == '.'){
+        p++;
+        while(p < fin && *p >= '0' && *p <= '9'){
+            if(mantisse < 100000000000000000ULL){ mantisse = mantisse * 10 + (unsigned)(*p - '0'); exposant--; }
+            else trop = 1;
+            chiffres++; p++;
+        }
+    }
+    if(chiffres > 0 && p < fin && (*p == 'e' || *p == 'E')){
+        const char *q = p + 1;
+        int signeExp = 1, e = 0, chiffresExp = 0;
+        if(q < fin && (*q == '-' || *q == '+')){ signeExp = (*q == '-') ? -1 : 1; q++; }
+        while(q < fin && *q >= '0' && *q <= '9'){
+            if(e < 100000) e = e * 10 + (*q - '0');
+            chiffresExp++; q++;
+        }
+        if(chiffresExp > 0){ exposant += signeExp * e; p = q; }
+    }
+    if(chiffres > 0 && p == fin && !trop && mantisse <= (1ULL << 53) && exposant >= -22 && exposant <= 22){
+        double v = (double)mantisse;
+        v = exposant < 0 ? v / puissances[-exposant] : v * puissances[exposant];
+        *valeur = negatif ? -v : v;
+        return 1;
     }
-    return k;
+    if(chiffres == 0 && debutChiffres == p && p < fin && *p != 'i' && *p != 'I' && *p != 'n' && *p != 'N')
+        return 0;
+    // cas rare (beaucoup de chiffres, grands exposants, inf, nan...) : strtod sur une copie.
+    char local[64];
+    size_t n = (size_t)(fin - debut);
+    char *tmp = n < sizeof(local) ? local : xmalloc(n + 1);
+    memcpy(tmp, debut, n);
+    tmp[n] = '\0';
+    char *ptr_erreur;
+    *valeur = strtod(tmp, &ptr_erreur);
+    int ok = (n > 0 && ptr_erreur == tmp + n);
+    if(tmp != local) free(tmp);
+    return ok;
 }
 
-// aloue une matrice de double (tableau de tableaux).
-static double **allocMat(int n, int m){
-    double **t = xmalloc(sizeof(double*)*n);
-    for(int i = 0;i < n;i++)
-        t[i] = xcalloc((size_t)m, sizeof(double));
-    return t;
+// fichier texte lu d'un bloc : projeté en mémoire (mmap) si possible, sinon lu dans un buffer.
+typedef struct {
+    const char *debut;
+    const char *fin;
+    size_t taille;
+    int mappe;
+} FichierTexte;
+
+static int ouvrirFichierTexte(const char *chemin, FichierTexte *f){
+    memset(f, 0, sizeof(*f));
+    int fd = open(chemin, O_RDONLY);
+    if(fd < 0) return 0;
+    struct stat st;
+    if(fstat(fd, &st) != 0){ close(fd); return 0; }
+    f->taille = (size_t)st.st_size;
+    if(f->taille > 0){
+        void *m = mmap(NULL, f->taille, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(m != MAP_FAILED){
+            madvise(m, f->taille, MADV_SEQUENTIAL);
+            f->debut = m;
+            f->mappe = 1;
+        } else {
+            char *buf = xmalloc(f->taille);
+            size_t lu = 0;
+            while(lu < f->taille){
+                ssize_t r = read(fd, buf + lu, f->taille - lu);
+                if(r <= 0) break;
+                lu += (size_t)r;
+            }
+            f->taille = lu;
+            f->debut = buf;
+        }
+    }
+    f->fin = f->debut + f->taille;
+    close(fd);
+    return 1;
 }
 
-// libere la mémoire d'une matrice de double.
-static void freeMat(double **t, int n){
-    if(!t) return;
-    for(int i = 0;i<n;i++) free(t[i]);
-    free(t);
+static void fermerFichierTexte(FichierTexte *f){
+    if(!f->debut) return;
+    if(f->mappe) munmap((void*)f->debut, f->taille);
+    else free((void*)f->debut);
+    f->debut = f->fin = NULL;
 }
 
-// transforme un label texte en nombre entier unique pour le perceptron.
-static int label_to_int(const char *s) {
-    if (!s || !*s) return 0;
-    char cleanS[256];
+// calcule le pas (en doubles) entre deux lignes consécutives.
+// au dela de 8 colones on arrondit au multiple de 4 pour que chaque ligne
+// commence sur une frontière de 32 octets (un registre avx).
+int calculerStride(int nbColonne){
+    if(nbColonne < 8) return nbColonne;
+    return (nbColonne + 3) & ~3;
+}
+
+// aloue une matrice n x stride contiguë, alignée sur 64 octets et mise à zéro.
+double *allocMatrice(int n, int stride){
+    size_t taille = (size_t)n * (size_t)stride * sizeof(double);
+    taille = (taille + 63) & ~(size_t)63;
+    if(taille == 0) taille = 64;
+    double *m = aligned_alloc(64, taille);
+    if(!m){ perror("aligned_alloc"); exit(EXIT_FAILURE); }
+    memset(m, 0, taille);
+    return m;
+}
+
+// construit le tableau de pointeurs vers chaque ligne d'une matrice contiguë.
+// garde la compatibilité avec le code qui utilise encore tab_Data[i][j].
+double **creerVuesLignes(double *matrice, int n, int stride){
+    double **vues = xmalloc(sizeof(double*) * (size_t)(n > 0 ? n : 1));
+    for(int i = 0; i < n; i++) vues[i] = matrice + (size_t)i * (size_t)stride;
+    return vues;
+}
+
+// meme chose pour tab_Data, dans l'arène du dataset.
+static void creerVuesDataSet(DataSet *ds){
+    ds->tab_Data = allouerDataSet(ds, sizeof(double*) * (size_t)ds->n, 0);
+    for(int i = 0; i < ds->n; i++) ds->tab_Data[i] = ligneData(ds, i);
+}
+
+// ==================== DICTIONNAIRE DES LABELS ====================
+
+// nettoie un label (retire tous les espaces, 255 caractères max) dans propre.
+static int nettoyerLabel(const char *s, size_t longueur, char propre[256]) {
     int j = 0;
-    for (int i = 0; s[i] != '\0' && j < 255; i++) {
+    for (size_t i = 0; i < longueur && j < 255; i++) {
         if (!isspace((unsigned char)s[i])) {
-            cleanS[j++] = s[i];
+            propre[j++] = s[i];
         }
     }
-    cleanS[j] = '\0';
-    if (j == 0) return 0;
-    static char nomsClasses[10][256];
-    static int nbClassesEnregistrees = 0;
-    for (int i = 0; i < nbClassesEnregistrees; i++) {
-        if (strcmp(cleanS, nomsClasses[i]) == 0) return i;
+    propre[j] = '\0';
+    return j;
+}
+
+// transforme un label texte en nombre entier unique pour le perceptron.
+// les numéros sont donnés dans l'ordre d'apparition, propre à chaque dictionnaire.
+static int label_to_int(DictionnaireLabels *d, const char *s, size_t longueur) {
+    if (!s || longueur == 0) return 0;
+    char cleanS[256];
+    if (nettoyerLabel(s, longueur, cleanS) == 0) return 0;
+    return ajouterLabel(d, cleanS);
+}
+
+// ==================== LECTURE CSV ====================
+
+enum { CSV_OK, CSV_MANQUE_COLONNES, CSV_NOMBRE_INVALIDE };
+
+// un morceau de fichier (lignes complètes) et ce qu'on en a tiré.
+// chaque worker remplit le sien sans rien partager avec les autres : ses lignes vont
+// directement à leur place dans la matrice du dataset (à partir de premiereLigne).
+typedef struct {
+    const char *debut;
+    const char *fin;
+    int nbColonne;
+    int stride;
+    // nombre de lignes du texte : une borne sur le nombre de lignes de données.
+    int capacite;
+    int premiereLigne;
+    double *donnees;
+    int *etiquettes;
+    int n;
+    DictionnaireLabels dict;
+    int erreur;
+    int colonneErreur;
+    const char *ligneErreur;
+} MorceauCSV;
+
+// compte les lignes de texte d'un morceau (la derniere peut ne pas finir par \n).
+static void tacheCompterLignes(void *ctx, int debut, int fin){
+    MorceauCSV *morceaux = ctx;
+    for(int k = debut; k < fin; k++){
+        MorceauCSV *m = &morceaux[k];
+        size_t lignes = 0;
+        const char *p = m->debut;
+        while(p < m->fin){
+            const char *eol = memchr(p, '\n', (size_t)(m->fin - p));
+            lignes++;
+            if(!eol) break;
+            p = eol + 1;
+        }
+        m->capacite = lignes > INT_MAX ? INT_MAX : (int)lignes;
     }
-    if (nbClassesEnregistrees < 10) {
-        strncpy(nomsClasses[nbClassesEnregistrees], cleanS, 255);
-        return nbClassesEnregistrees++;
+}
+
+// parse toutes les lignes de [debut, fin) sans copie par ligne : les champs sont
+// repérés directement dans le buffer et convertis avec lireNombre.
+// s'arrete à la premiere ligne invalide en notant l'erreur dans le morceau.
+static void parserMorceau(MorceauCSV *m){
+    const char *p = m->debut;
+    m->n = 0;
+    while(p < m->fin){
+        const char *eol = memchr(p, '\n', (size_t)(m->fin - p));
+        if(!eol) eol = m->fin;
+        const char *debutLigne = p;
+        const char *a = p, *b = eol;
+        p = eol + 1;
+        trimIntervalle(&a, &b);
+        if(a == b) continue;
+        // au plus une ligne de données par ligne de texte : la place est déjà réservée.
+        double *ligne = m->donnees + (size_t)m->n * (size_t)m->stride;
+        for (int j = 0; j < m->nbColonne; j++) {
+            const char *virgule = memchr(a, ',', (size_t)(b - a));
+            if(!virgule){
+                m->erreur = CSV_MANQUE_COLONNES;
+                m->ligneErreur = debutLigne;
+                return;
+            }
+            const char *c0 = a, *c1 = virgule;
+            trimIntervalle(&c0, &c1);
+            if(!lireNombre(c0, c1, &ligne[j])){
+                m->erreur = CSV_NOMBRE_INVALIDE;
+                m->colonneErreur = j;
+                m->ligneErreur = debutLigne;
+                return;
+            }
+            a = virgule + 1;
+        }
+        // le label s'arrete à la virgule suivante s'il y a des colones en trop.
+        const char *virgule = memchr(a, ',', (size_t)(b - a));
+        const char *l0 = a, *l1 = virgule ? virgule : b;
+        trimIntervalle(&l0, &l1);
+        if(l0 == l1){
+            m->erreur = CSV_MANQUE_COLONNES;
+            m->ligneErreur = debutLigne;
+            return;
+        }
+        m->etiquettes[m->n] = label_to_int(&m->dict, l0, (size_t)(l1 - l0));
+        m->n++;
+    }
+}
+
+static void tacheMorceau(void *ctx, int debut, int fin){
+    MorceauCSV *morceaux = ctx;
+    for(int k = debut; k < fin; k++) parserMorceau(&morceaux[k]);
+}
+
+// affiche l'erreur d'un morceau avec le vrai numéro de ligne dans le fichier.
+static void signalerErreurCSV(const FichierTexte *f, const MorceauCSV *m){
+    int numeroLigne = 1;
+    for(const char *q = f->debut; q < m->ligneErreur; q++) if(*q == '\n') numeroLigne++;
+    if(m->erreur == CSV_MANQUE_COLONNES)
+        printf("ERREUR Ligne %d : Manque de colonnes.\n", numeroLigne);
+    else
+        printf("ERREUR Ligne %d, Col %d : pas un nombre valide.\n", numeroLigne, m->colonneErreur);
+    exit(1);
+}
+
+// extension .svm ou .libsvm : le fichier est lu par createDataSetLibsvm.
+static int estFichierLibsvm(const char *fichier){
+    const char *point = strrchr(fichier, '.');
+    return point && (strcmp(point, ".svm") == 0 || strcmp(point, ".libsvm") == 0);
+}
+
+// lit l'entete (noms des colones) et retourne le début des données.
+static const char *lireEntete(DataSet *ds, const FichierTexte *f){
+    const char *p = f->debut;
+    const char *eol = memchr(p, '\n', (size_t)(f->fin - p));
+    if(!eol) eol = f->fin;
+    int totalCols = 1;
+    for(const char *q = p; q < eol; q++) if(*q == ',') totalCols++;
+    if (totalCols < 2) {
+        printf("ERREUR Header corrompu : %d colonnes detectees.\n", totalCols);
+        exit(1);
+    }
+    ds->nbColonne = totalCols - 1;
+    ds->nomColonne = allouerDataSet(ds, sizeof(char*) * (size_t)ds->nbColonne, 0);
+    const char *champ = p;
+    for(int j = 0; j < ds->nbColonne; j++){
+        const char *virgule = memchr(champ, ',', (size_t)(eol - champ));
+        const char *a = champ, *b = virgule;
+        trimIntervalle(&a, &b);
+        ds->nomColonne[j] = copierChaineDataSet(ds, a, b);
+        champ = virgule + 1;
+    }
+    return eol < f->fin ? eol + 1 : f->fin;
+}
+
+typedef struct {
+    MorceauCSV *morceaux;
+    int **correspondance;
+} ContexteRenumerotation;
+
+// passe les labels d'un morceau de son dictionnaire local au dictionnaire du dataset.
+static void tacheRenumerotation(void *ctx, int debut, int fin){
+    ContexteRenumerotation *c = ctx;
+    for(int k = debut; k < fin; k++){
+        const MorceauCSV *m = &c->morceaux[k];
+        for(int i = 0; i < m->n; i++) m->etiquettes[i] = c->correspondance[k][m->etiquettes[i]];
     }
-    return 0;
 }
 
 // lit un fichier csv et crée l'objet dataset avec toute les données.
 // il gère les erreurs si le fichier est vide ou mal formater.
-DataSet* createDataSet(const char *fichier){
-    FILE *f = fopen(fichier, "r");
-    if(!f){
+// le nombre de lignes du texte borne celui des lignes de données : la matrice et les labels
+// sont réservés une fois dans l'arène du dataset, et chaque morceau (avec nbThreads > 1 le
+// fichier est découpé aux fins de ligne) est parsé directement à sa place. les lignes vides
+// laissent des trous, rebouchés à la fin. les labels sont renumérotés dans l'ordre de
+// premiere apparition : le résultat est le meme qu'avec un seul thread.
+DataSet* createDataSetParallele(const char *fichier, int nbThreads){
+    if(estFichierLibsvm(fichier)) return createDataSetLibsvm(fichier);
+    FichierTexte f;
+    if(!ouvrirFichierTexte(fichier, &f)){
         printf("ERREUR Impossible d'ouvrir le fichier : %s\n", fichier);
         exit(1);
     }
-    fseek(f, 0, SEEK_END);
-    if (ftell(f) == 0) {
+    if (f.taille == 0) {
         printf("ERREUR Le fichier '%s' est vide.\n", fichier);
-        fclose(f);
         exit(1);
     }
-    rewind(f);
-    DataSet *ds = xcalloc(1, sizeof(DataSet));
-    ds->nom = xstrdup(fichier);
-    char line[4096];
-    if(!fgets(line, 4096, f)) {
-        printf("ERREUR Impossible de lire la premiere ligne (header).\n");
-        exit(1);
+    DataSet *ds = nouveauDataSet();
+    ds->nom = copierChaineDataSet(ds, fichier, fichier + strlen(fichier));
+    const char *donnees = lireEntete(ds, &f);
+    ds->stride = calculerStride(ds->nbColonne);
+
+    // découpage en morceaux d'au moins 1 Mo, coupés juste après un \n.
+    if(nbThreads <= 0) nbThreads = nbThreadsParDefaut();
+    size_t tailleDonnees = (size_t)(f.fin - donnees);
+    int nbMorceaux = nbThreads == 1 ? 1 : nbThreads * 4;
+    if((size_t)nbMorceaux > tailleDonnees / (1 << 20) + 1) nbMorceaux = (int)(tailleDonnees / (1 << 20)) + 1;
+    MorceauCSV *morceaux = xcalloc((size_t)nbMorceaux, sizeof(MorceauCSV));
+    const char *debut = donnees;
+    for(int k = 0; k < nbMorceaux; k++){
+        const char *fin = f.fin;
+        if(k < nbMorceaux - 1){
+            fin = donnees + tailleDonnees / (size_t)nbMorceaux * (size_t)(k + 1);
+            if(fin < debut) fin = debut;
+            const char *eol = memchr(fin, '\n', (size_t)(f.fin - fin));
+            fin = eol ? eol + 1 : f.fin;
+        }
+        morceaux[k].debut = debut;
+        morceaux[k].fin = fin;
+        morceaux[k].nbColonne = ds->nbColonne;
+        morceaux[k].stride = ds->stride;
+        debut = fin;
     }
-    rstrip(line);
-    int totalCols = countTokens(line);
-    if (totalCols < 2) {
-        printf("ERREUR Header corrompu : %d colonnes detectees.\n", totalCols);
-        exit(1);
+    // une place par ligne de texte (les lignes vides ne laissent que des trous à la fin).
+    executerParallele(nbThreads, nbMorceaux, 2, tacheCompterLignes, morceaux);
+    size_t capacite = 0;
+    for(int k = 0; k < nbMorceaux; k++){
+        morceaux[k].premiereLigne = (int)capacite;
+        capacite += (size_t)morceaux[k].capacite;
+        if(capacite > INT_MAX){
+            printf("ERREUR Trop de lignes dans %s.\n", fichier);
+            exit(1);
+        }
     }
-    ds->nbColonne = totalCols - 1;
-    ds->nomColonne = xcalloc((size_t)ds->nbColonne, sizeof(char*));
-    char *tmp = xstrdup(line);
-    char *tok[100];
-    splitCSV(tmp, tok, totalCols);
-    for(int i = 0; i < ds->nbColonne; i++)
-        ds->nomColonne[i] = xstrdup(tok[i]);
-    free(tmp);
+    ds->donnees = allouerDataSet(ds, capacite * (size_t)ds->stride * sizeof(double), 64);
+    ds->etiquettes = allouerDataSet(ds, capacite * sizeof(int), 0);
+    for(int k = 0; k < nbMorceaux; k++){
+        morceaux[k].donnees = ligneData(ds, morceaux[k].premiereLigne);
+        morceaux[k].etiquettes = ds->etiquettes + morceaux[k].premiereLigne;
+    }
+    executerParallele(nbThreads, nbMorceaux, 2, tacheMorceau, morceaux);
+    for(int k = 0; k < nbMorceaux; k++){
+        if(morceaux[k].erreur != CSV_OK) signalerErreurCSV(&f, &morceaux[k]);
+    }
+
+    if(nbMorceaux == 1){
+        // un seul morceau : son dictionnaire est directement celui du dataset.
+        ds->nomsClasses = morceaux[0].dict;
+    } else {
+        // dictionnaire global construit dans l'ordre du fichier, puis renumérotation en parallèle.
+        ContexteRenumerotation c;
+        c.morceaux = morceaux;
+        c.correspondance = xmalloc(sizeof(int*) * (size_t)nbMorceaux);
+        for(int k = 0; k < nbMorceaux; k++){
+            c.correspondance[k] = xmalloc(sizeof(int) * (size_t)(morceaux[k].dict.nb > 0 ? morceaux[k].dict.nb : 1));
+            for(int l = 0; l < morceaux[k].dict.nb; l++)
+                c.correspondance[k][l] = ajouterLabel(&ds->nomsClasses, morceaux[k].dict.noms[l]);
+        }
+        executerParallele(nbThreads, nbMorceaux, 2, tacheRenumerotation, &c);
+        for(int k = 0; k < nbMorceaux; k++){
+            free(c.correspondance[k]);
+            libererDictionnaire(&morceaux[k].dict);
+        }
+        free(c.correspondance);
+    }
+    // les morceaux sont recollés dans l'ordre du fichier (rien à déplacer sans ligne vide).
     ds->n = 0;
-    while(fgets(line, 4096, f)) {
-        if (strlen(trim(line)) > 0) ds->n++;
+    for(int k = 0; k < nbMorceaux; k++){
+        const MorceauCSV *m = &morceaux[k];
+        if(m->premiereLigne != ds->n && m->n > 0){
+            memmove(ligneData(ds, ds->n), m->donnees, (size_t)m->n * (size_t)ds->stride * sizeof(double));
+            memmove(ds->etiquettes + ds->n, m->etiquettes, sizeof(int) * (size_t)m->n);
+        }
+        ds->n += m->n;
     }
+    free(morceaux);
+    fermerFichierTexte(&f);
     if (ds->n == 0) {
         printf("ERREUR Le fichier ne contient aucune ligne de donnees.\n");
         exit(1);
     }
-    ds->tab_Data = allocMat(ds->n, ds->nbColonne);
-    ds->sortieAttendue_train = (int*)xmalloc(sizeof(int) * (size_t)ds->n);
-    rewind(f);
-    fgets(line, 4096, f);
-    int i = 0;
-    while(fgets(line, 4096, f)) {
-        char *l = trim(line);
-        if (strlen(l) == 0) continue;
-        tmp = xstrdup(l);
-        int lues = splitCSV(tmp, tok, totalCols);
-        if (lues < totalCols) {
-            printf("ERREUR Ligne %d : Manque de colonnes.\n", i + 2);
-            exit(1);
+    creerVuesDataSet(ds);
+    printf("[OK] Chargement robuste termine : %d lignes valides.\n", ds->n);
+    return ds;
+}
+
+// lit un fichier csv sur un seul thread (voir createDataSetParallele).
+DataSet* createDataSet(const char *fichier){
+    return createDataSetParallele(fichier, 1);
+}
+
+// ==================== LECTURE LIBSVM ====================
+
+// double la capacité d'un tableau de taille éléments.
+static void *agrandirTableau(void *t, size_t *capacite, size_t taille){
+    *capacite *= 2;
+    void *nouveau = realloc(t, *capacite * taille);
+    if(!nouveau){ perror("realloc"); exit(EXIT_FAILURE); }
+    return nouveau;
+}
+
+// numéro de colone libsvm (entier >= 1) dans [debut, fin).
+static int lireColonne(const char *debut, const char *fin, int *colonne){
+    long long v = 0;
+    if(debut == fin) return 0;
+    for(const char *q = debut; q < fin; q++){
+        if(*q < '0' || *q > '9') return 0;
+        v = v * 10 + (*q - '0');
+        if(v > INT_MAX) return 0;
+    }
+    if(v < 1) return 0;
+    *colonne = (int)v;
+    return 1;
+}
+
+// tri par insertion des colones d'une ligne (presque toujours déjà triées).
+// retourne 0 si une colone apparait deux fois.
+static int trierLigneCreuse(int *colonnes, double *valeurs, int nnz){
+    for(int i = 1; i < nnz; i++){
+        int c = colonnes[i];
+        double v = valeurs[i];
+        int j = i - 1;
+        while(j >= 0 && colonnes[j] > c){
+            colonnes[j + 1] = colonnes[j];
+            valeurs[j + 1] = valeurs[j];
+            j--;
         }
-        for (int j = 0; j < ds->nbColonne; j++) {
-            char *ptr_erreur;
-            ds->tab_Data[i][j] = strtod(tok[j], &ptr_erreur);
-            if (tok[j] == ptr_erreur || *ptr_erreur != '\0') {
-                printf("ERREUR Ligne %d, Col %d : pas un nombre valide.\n", i+2, j);
+        colonnes[j + 1] = c;
+        valeurs[j + 1] = v;
+    }
+    for(int i = 1; i < nnz; i++) if(colonnes[i] == colonnes[i - 1]) return 0;
+    return 1;
+}
+
+// lit un fichier libsvm dans un dataset creux : seules les valeurs non nulles sont gardées,
+// la mémoire grandit avec leur nombre et pas avec celui des colones.
+DataSet* createDataSetLibsvm(const char *fichier){
+    FichierTexte f;
+    if(!ouvrirFichierTexte(fichier, &f)){
+        printf("ERREUR Impossible d'ouvrir le fichier : %s\n", fichier);
+        exit(1);
+    }
+    if (f.taille == 0) {
+        printf("ERREUR Le fichier '%s' est vide.\n", fichier);
+        exit(1);
+    }
+    DataSet *ds = nouveauDataSet();
+    ds->nom = copierChaineDataSet(ds, fichier, fichier + strlen(fichier));
+    // la structure est dans l'arène, les tableaux csr (qui grandissent) restent dans le tas.
+    MatriceCreuse *m = allouerDataSet(ds, sizeof(MatriceCreuse), 0);
+    ds->creux = m;
+    // environ 8 octets de texte par valeur ("123:0.5 ").
+    size_t capaciteLignes = 1024;
+    size_t capaciteValeurs = f.taille / 8 + 16;
+    m->debutLigne = xmalloc(sizeof(size_t) * capaciteLignes);
+    m->colonnes = xmalloc(sizeof(int) * capaciteValeurs);
+    m->valeurs = xmalloc(sizeof(double) * capaciteValeurs);
+    ds->etiquettes = xmalloc(sizeof(int) * capaciteLignes);
+    m->debutLigne[0] = 0;
+
+    int numeroLigne = 0, maxColonne = 0;
+    const char *p = f.debut;
+    while(p < f.fin){
+        const char *eol = memchr(p, '\n', (size_t)(f.fin - p));
+        if(!eol) eol = f.fin;
+        const char *a = p, *b = eol;
+        p = eol + 1;
+        numeroLigne++;
+        const char *diese = memchr(a, '#', (size_t)(b - a));
+        if(diese) b = diese;
+        trimIntervalle(&a, &b);
+        if(a == b) continue;
+        if((size_t)ds->n + 1 >= capaciteLignes){
+            size_t c = capaciteLignes;
+            m->debutLigne = agrandirTableau(m->debutLigne, &capaciteLignes, sizeof(size_t));
+            ds->etiquettes = agrandirTableau(ds->etiquettes, &c, sizeof(int));
+        }
+        const char *finLabel = a;
+        while(finLabel < b && !isspace((unsigned char)*finLabel)) finLabel++;
+        ds->etiquettes[ds->n] = label_to_int(&ds->nomsClasses, a, (size_t)(finLabel - a));
+
+        size_t debut = m->nnz;
+        int triee = 1;
+        const char *q = finLabel;
+        for(;;){
+            while(q < b && isspace((unsigned char)*q)) q++;
+            if(q == b) break;
+            const char *finChamp = q;
+            while(finChamp < b && !isspace((unsigned char)*finChamp)) finChamp++;
+            const char *deuxPoints = memchr(q, ':', (size_t)(finChamp - q));
+            int colonne;
+            double valeur;
+            if(deuxPoints && deuxPoints - q == 3 && memcmp(q, "qid", 3) == 0){
+                q = finChamp;
+                continue;
+            }
+            if(!deuxPoints || !lireColonne(q, deuxPoints, &colonne) || !lireNombre(deuxPoints + 1, finChamp, &valeur)){
+                printf("ERREUR Ligne %d : champ libsvm invalide (colone:valeur attendu).\n", numeroLigne);
                 exit(1);
             }
+            q = finChamp;
+            if(valeur == 0) continue;
+            if(m->nnz == capaciteValeurs){
+                size_t c = capaciteValeurs;
+                m->colonnes = agrandirTableau(m->colonnes, &capaciteValeurs, sizeof(int));
+                m->valeurs = agrandirTableau(m->valeurs, &c, sizeof(double));
+            }
+            if(m->nnz > debut && colonne - 1 <= m->colonnes[m->nnz - 1]) triee = 0;
+            m->colonnes[m->nnz] = colonne - 1;
+            m->valeurs[m->nnz] = valeur;
+            m->nnz++;
+            if(colonne > maxColonne) maxColonne = colonne;
         }
-        ds->sortieAttendue_train[i] = label_to_int(tok[ds->nbColonne]);
-        free(tmp);
-        i++;
+        if(!triee && !trierLigneCreuse(m->colonnes + debut, m->valeurs + debut, (int)(m->nnz - debut))){
+            printf("ERREUR Ligne %d : colone en double.\n", numeroLigne);
+            exit(1);
+        }
+        if(ds->n == INT_MAX - 1){
+            printf("ERREUR Trop de lignes dans %s.\n", fichier);
+            exit(1);
+        }
+        ds->n++;
+        m->debutLigne[ds->n] = m->nnz;
     }
-    fclose(f);
-    printf("[OK] Chargement robuste termine : %d lignes valides.\n", ds->n);
+    fermerFichierTexte(&f);
+    if (ds->n == 0) {
+        printf("ERREUR Le fichier ne contient aucune ligne de donnees.\n");
+        exit(1);
+    }
+    // on rend la marge des tableaux.
+    if(m->nnz > 0){
+        m->colonnes = realloc(m->colonnes, sizeof(int) * m->nnz);
+        m->valeurs = realloc(m->valeurs, sizeof(double) * m->nnz);
+    }
+    ds->nbColonne = maxColonne;
+    printf("[OK] Chargement libsvm termine : %d lignes, %d colonnes, %zu valeurs non nulles.\n",
+           ds->n, ds->nbColonne, m->nnz);
     return ds;
 }
 
+double valeurDataSet(const DataSet *ds, int ligne, int colonne){
+    if(!ds->creux) return ligneData(ds, ligne)[colonne];
+    const int *colonnes;
+    const double *valeurs;
+    int nnz = ligneCreuse(ds, ligne, &colonnes, &valeurs);
+    int bas = 0, haut = nnz;
+    while(bas < haut){
+        int milieu = (bas + haut) / 2;
+        if(colonnes[milieu] < colonne) bas = milieu + 1;
+        else haut = milieu;
+    }
+    return bas < nnz && colonnes[bas] == colonne ? valeurs[bas] : 0;
+}
+
+int elargirDataSetCreux(DataSet *ds, int nbColonne){
+    if(!ds->creux || nbColonne < ds->nbColonne) return 0;
+    ds->nbColonne = nbColonne;
+    return 1;
+}
+
+// libere un tableau du dataset sauf s'il fait partie du fichier projeté en mémoire ou de
+// l'arène (libérée d'un coup à la fin).
+static void libererSiAlloue(const DataSet *ds, void *ptr){
+    const char *base = ds->mmapBase;
+    if(base && (const char*)ptr >= base && (const char*)ptr < base + ds->mmapTaille) return;
+    if(dansArene(ds->arene, ptr)) return;
+    free(ptr);
+}
+
+static void libererMatriceCreuse(const DataSet *ds, MatriceCreuse *m){
+    if(!m) return;
+    free(m->debutLigne);
+    free(m->colonnes);
+    free(m->valeurs);
+    libererSiAlloue(ds, m);
+}
+
+// reconstruit les vues train/teste et les labels à partir de indexSplit.
+// coûte O(n) : seuls des pointeurs et des entiers sont écrits. les labels (train puis teste)
+// et les vues tiennent chacun dans un tampon de n cases pris dans l'arène au premier split,
+// puis réutilisé par les suivants.
+static void appliquerSplit(DataSet *ds){
+    if(!dansArene(ds->arene, ds->sortieAttendue_train)){
+        libererSiAlloue(ds, ds->sortieAttendue_train); libererSiAlloue(ds, ds->sortieAttendue_Teste);
+        ds->sortieAttendue_train = allouerDataSet(ds, sizeof(int) * (size_t)ds->n, 0);
+    }
+    ds->sortieAttendue_Teste = ds->sortieAttendue_train + ds->nTrain;
+    for(int i = 0; i < ds->nTrain; i++) ds->sortieAttendue_train[i] = ds->etiquettes[ds->indexSplit[i]];
+    for(int i = 0; i < ds->nTest; i++) ds->sortieAttendue_Teste[i] = ds->etiquettes[ds->indexSplit[ds->nTrain + i]];
+    // pas de vues de lignes pour un dataset creux.
+    if(ds->creux) return;
+    if(!dansArene(ds->arene, ds->tab_Train)){
+        libererSiAlloue(ds, ds->tab_Train); libererSiAlloue(ds, ds->tab_Teste);
+        ds->tab_Train = allouerDataSet(ds, sizeof(double*) * (size_t)ds->n, 0);
+    }
+    ds->tab_Teste = ds->tab_Train + ds->nTrain;
+    for(int i = 0; i < ds->nTrain; i++) ds->tab_Train[i] = ligneTrain(ds, i);
+    for(int i = 0; i < ds->nTest; i++) ds->tab_Teste[i] = ligneTeste(ds, i);
+}
+
 // mélange les lignes et sépare les données en 80% train et 20% teste.
-void melanger(const DataSet *data){
-    DataSet *ds = (DataSet*)data;
-    if(ds->tab_Train) freeMat(ds->tab_Train, ds->nTrain);
-    if(ds->tab_Teste) freeMat(ds->tab_Teste, ds->nTest);
+// seul l'index est permuté, les données restent en place dans donnees.
+void melanger(DataSet *ds){
     ds->nTrain = (int)(0.8 * ds->n);
     ds->nTest  = ds->n - ds->nTrain;
-    ds->tab_Train = allocMat(ds->nTrain, ds->nbColonne);
-    ds->tab_Teste = allocMat(ds->nTest,  ds->nbColonne);
-    int *labels_all = xmalloc(sizeof(int) * ds->n);
-    for(int i=0; i<ds->n; i++) labels_all[i] = ds->sortieAttendue_train[i];
-    free(ds->sortieAttendue_train);
-    ds->sortieAttendue_train = xmalloc(sizeof(int) * ds->nTrain);
-    ds->sortieAttendue_Teste = xmalloc(sizeof(int) * ds->nTest);
-    int *idx = xmalloc(ds->n * sizeof(int));
+    if(!ds->indexSplit) ds->indexSplit = allouerDataSet(ds, sizeof(int) * (size_t)ds->n, 0);
+    int *idx = ds->indexSplit;
     for(int i = 0; i < ds->n; i++) idx[i] = i;
     for(int i = ds->n - 1; i > 0; i--){
         int j = rand() % (i + 1);
         int tmp = idx[i]; idx[i] = idx[j]; idx[j] = tmp;
     }
-    for(int i = 0; i < ds->nTrain; i++){
-        for(int j = 0; j < ds->nbColonne; j++)
-            ds->tab_Train[i][j] = ds->tab_Data[idx[i]][j];
-        ds->sortieAttendue_train[i] = labels_all[idx[i]];
-    }
-    for(int i = 0; i < ds->nTest; i++){
-        for(int j = 0; j < ds->nbColonne; j++)
-            ds->tab_Teste[i][j] = ds->tab_Data[idx[i + ds->nTrain]][j];
-        ds->sortieAttendue_Teste[i] = labels_all[idx[i + ds->nTrain]];
-    }
-    free(labels_all); free(idx);
+    appliquerSplit(ds);
 }
 
-// calcule la moyenne arithmétique d'une colone du dataset.
+// moyenne d'une colone.
 double moyenne(DataSet *d, int colIndex){
     if(colIndex < 0 || colIndex >= d->nbColonne) return 0;
-    double s = 0;
-    for(int i = 0;i < d->n;i++) s += d->tab_Data[i][colIndex];
-    return s / d->n;
+    const StatistiquesDataSet *s = statistiquesDataSet(d, 0);
+    return s ? s->colonnes[colIndex].moyenne : 0;
 }
 
 // calcule l'écart-type pour voir la dispersion des données.
 double ecartType(DataSet *d, int colIndex){
     if(colIndex < 0 || colIndex >= d->nbColonne) return 0;
-    double m = moyenne(d, colIndex), s=0;
-    for(int i = 0;i < d->n;i++){
-        double x = d->tab_Data[i][colIndex]-m;
-        s += x*x;
-    }
-    return sqrt(s/d->n);
+    const StatistiquesDataSet *s = statistiquesDataSet(d, 0);
+    return s ? s->colonnes[colIndex].ecartType : 0;
 }
 
-// petite fonction de comparaison pour le tri qsort.
-static int cmp(const void *a,const void *b){
-    double x =* (double*)a, y =* (double*)b;
-    return (x>y)-(x<y);
-}
-
-// trouve la valeur médiane d'une colone après avoir trier les données.
+// valeur médiane d'une colone (sélection, sans trier toute la colone).
 double mediane(DataSet *d, int colIndex){
     if(colIndex < 0 || colIndex >= d->nbColonne) return 0;
-    double *t = xmalloc((size_t)d->n * sizeof(double));
-    for(int i = 0;i < d->n;i++) t[i] = d->tab_Data[i][colIndex];
-    qsort(t,(size_t)d->n,sizeof(double),cmp);
-    double m = (d->n%2)? t[d->n/2] : (t[d->n/2-1]+t[d->n/2])/2;
-    free(t);
-    return m;
+    const StatistiquesDataSet *s = statistiquesDataSet(d, 0);
+    return s ? s->colonnes[colIndex].mediane : 0;
 }
 
 // sauvegarde les données de train et de teste dans deux fichiers csv séparer.
 void sauvegarderSplit(const DataSet *ds, const char *nomDataset) {
+    if (ds->creux) {
+        printf("[!] Erreur : split en csv indisponible pour un dataset creux.\n");
+        return;
+    }
     char nTr[300], nTe[300];
     sprintf(nTr, "%s_TRAIN.csv", nomDataset);
     sprintf(nTe, "%s_TEST.csv", nomDataset);
     FILE *f1 = fopen(nTr, "w");
     if(f1) {
         for(int i = 0; i < ds->nTrain; i++) {
-            for(int j = 0; j < ds->nbColonne; j++) fprintf(f1, "%f,", ds->tab_Train[i][j]);
+            const double *ligne = ligneTrain(ds, i);
+            for(int j = 0; j < ds->nbColonne; j++) fprintf(f1, "%f,", ligne[j]);
             fprintf(f1, "%d\n", ds->sortieAttendue_train[i]);
         }
         fclose(f1);
@@ -263,7 +746,8 @@ void sauvegarderSplit(const DataSet *ds, const char *nomDataset) {
     FILE *f2 = fopen(nTe, "w");
     if(f2) {
         for(int i = 0; i < ds->nTest; i++) {
-            for(int j = 0; j < ds->nbColonne; j++) fprintf(f2, "%f,", ds->tab_Teste[i][j]);
+            const double *ligne = ligneTeste(ds, i);
+            for(int j = 0; j < ds->nbColonne; j++) fprintf(f2, "%f,", ligne[j]);
             fprintf(f2, "%d\n", ds->sortieAttendue_Teste[i]);
         }
         fclose(f2);
@@ -274,115 +758,300 @@ void sauvegarderSplit(const DataSet *ds, const char *nomDataset) {
 // afiche un aperçu des données charger dans la console.
 void afficherDonnees(const DataSet *ds) {
     printf("\n--- Apercu : %s ---\n", ds->nom);
+    if(ds->creux) {
+        // seulement les valeurs non nulles, en colone:valeur.
+        for(int i = 0; i < ds->n; i++) {
+            const int *colonnes;
+            const double *valeurs;
+            int nnz = ligneCreuse(ds, i, &colonnes, &valeurs);
+            for(int k = 0; k < nnz; k++) printf("%d:%.2f ", colonnes[k], valeurs[k]);
+            printf("| Label: %d\n", ds->etiquettes[i]);
+        }
+        return;
+    }
     for(int i = 0; i < ds->n; i++) {
-        for(int j = 0; j < ds->nbColonne; j++) printf("%.2f | ", ds->tab_Data[i][j]);
-        printf("Label: %d\n", ds->sortieAttendue_train[i]);
+        const double *ligne = ligneData(ds, i);
+        for(int j = 0; j < ds->nbColonne; j++) printf("%.2f | ", ligne[j]);
+        printf("Label: %d\n", ds->etiquettes[i]);
     }
 }
 
 // libere toute la mémoire utiliser par le dataset pour éviter les fuites.
+// ce qui est dans l'arène (tout, pour un dataset chargé) part avec elle en un seul passage.
 void libererDataSet(DataSet *d){
     if(!d) return;
-    freeMat(d->tab_Data, d->n);
-    if(d->tab_Train) freeMat(d->tab_Train, d->nTrain);
-    if(d->tab_Teste) freeMat(d->tab_Teste, d->nTest);
-    if(d->nom) free(d->nom);
-    if(d->nomColonne) {
+    libererSiAlloue(d, d->tab_Data);
+    libererSiAlloue(d, d->tab_Train);
+    libererSiAlloue(d, d->tab_Teste);
+    libererSiAlloue(d, d->donnees);
+    libererSiAlloue(d, d->etiquettes);
+    libererSiAlloue(d, d->indexSplit);
+    libererSiAlloue(d, d->sortieAttendue_train);
+    libererSiAlloue(d, d->sortieAttendue_Teste);
+    libererSiAlloue(d, d->nom);
+    if(d->nomColonne && !dansArene(d->arene, d->nomColonne)) {
         for(int i=0;i<d->nbColonne;i++) free(d->nomColonne[i]);
         free(d->nomColonne);
     }
-    if(d->sortieAttendue_train) free(d->sortieAttendue_train);
-    if(d->sortieAttendue_Teste) free(d->sortieAttendue_Teste);
-    free(d);
+    libererSiAlloue(d, d->normalisation.decalage);
+    libererSiAlloue(d, d->normalisation.echelle);
+    libererDictionnaire(&d->nomsClasses);
+    libererMatriceCreuse(d, d->creux);
+    invaliderStatistiques(d);
+    if(d->mmapBase) munmap(d->mmapBase, d->mmapTaille);
+    Arene *arene = d->arene;
+    if(!dansArene(arene, d)) free(d);
+    libererArene(arene);
 }
 
-// sauvegarde le dataset complet dans un format spécial pour pouvoir le recharger plus tard.
+// ==================== FORMAT BINAIRE "DATASET SPECIAL" ====================
+// entete fixe, puis les noms (colones puis classes, chacun en longueur + octets),
+// puis les tableaux bruts alignés sur 64 octets : matrice n x stride, labels,
+// index du split, labels du train puis du teste dans l'ordre du split, et pour un
+// dataset normalisé les décalages puis les échelles des colones.
+// le fichier est rechargé par mmap sans aucune copie ni conversion.
+
+#define MAGIE_DATASET "PCPDSET"
+#define VERSION_DATASET 1
+#define ORDRE_OCTETS 0x01020304u
+
+typedef struct {
+    char magie[8];
+    uint32_t version;
+    uint32_t ordreOctets;
+    uint32_t nbColonne;
+    uint32_t stride;
+    uint32_t nbClasses;
+    uint32_t typeNormalisation;   // 0 = données brutes (fichiers plus anciens compris)
+    uint64_t n;
+    uint64_t nTrain;
+    uint64_t nTest;
+    uint64_t offsetNoms;
+    uint64_t offsetDonnees;
+    uint64_t offsetEtiquettes;
+    uint64_t offsetIndex;
+    uint64_t offsetLabelsSplit;
+    uint64_t tailleFichier;
+} EnteteDataSet;
+
+// sauvegarde le dataset complet (données, split, noms) dans le format binaire.
 void sauvegarderDataSetSpecial(const DataSet *ds, const char *nomFichier) {
-    if (ds == NULL || ds->tab_Train == NULL || ds->tab_Teste == NULL) {
+    if (ds == NULL || ds->indexSplit == NULL) {
         printf("[!] Erreur : Dataset incomplet.\n");
         return;
     }
+    if (ds->creux) {
+        printf("[!] Erreur : le format binaire ne prend que des datasets denses.\n");
+        return;
+    }
     char cheminComplet[512];
     snprintf(cheminComplet, sizeof(cheminComplet), "DataSet/%s", nomFichier);
-    FILE *f = fopen(cheminComplet, "w");
+    FILE *f = fopen(cheminComplet, "wb");
     if (f == NULL) {
         printf("[!] Erreur : Impossible de creer le fichier.\n");
         return;
     }
-    fprintf(f, "%d\n", ds->nTest);
-    fprintf(f, "%d\n", ds->nTrain);
-    for (int i = 0; i < ds->nTest; i++) {
-        for (int j = 0; j < ds->nbColonne; j++) {
-            fprintf(f, "%f%s", ds->tab_Teste[i][j], (j == ds->nbColonne - 1) ? "" : ",");
-        }
-        fprintf(f, "\n");
+    EnteteDataSet e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.magie, MAGIE_DATASET, sizeof(MAGIE_DATASET));
+    e.version = VERSION_DATASET;
+    e.ordreOctets = ORDRE_OCTETS;
+    e.nbColonne = (uint32_t)ds->nbColonne;
+    e.stride = (uint32_t)ds->stride;
+    e.nbClasses = (uint32_t)ds->nomsClasses.nb;
+    e.n = (uint64_t)ds->n;
+    e.nTrain = (uint64_t)ds->nTrain;
+    e.nTest = (uint64_t)ds->nTest;
+    e.offsetNoms = sizeof(EnteteDataSet);
+    uint64_t tailleNoms = 0;
+    for (int j = 0; j < ds->nbColonne; j++) tailleNoms += sizeof(uint32_t) + strlen(ds->nomColonne[j]);
+    for (int c = 0; c < ds->nomsClasses.nb; c++) tailleNoms += sizeof(uint32_t) + strlen(ds->nomsClasses.noms[c]);
+    e.offsetDonnees = aligner64(e.offsetNoms + tailleNoms);
+    e.offsetEtiquettes = aligner64(e.offsetDonnees + e.n * e.stride * sizeof(double));
+    e.offsetIndex = aligner64(e.offsetEtiquettes + e.n * sizeof(int32_t));
+    e.offsetLabelsSplit = aligner64(e.offsetIndex + e.n * sizeof(int32_t));
+    e.tailleFichier = e.offsetLabelsSplit + e.n * sizeof(int32_t);
+    const int normalise = ds->normalisation.type != NORMALISATION_AUCUNE;
+    uint64_t offsetNormalisation = aligner64(e.tailleFichier);
+    if (normalise) {
+        e.typeNormalisation = (uint32_t)ds->normalisation.type;
+        e.tailleFichier = offsetNormalisation + 2 * (uint64_t)e.nbColonne * sizeof(double);
     }
-    for (int i = 0; i < ds->nTrain; i++) {
-        for (int j = 0; j < ds->nbColonne; j++) {
-            fprintf(f, "%f%s", ds->tab_Train[i][j], (j == ds->nbColonne - 1) ? "" : ",");
-        }
-        fprintf(f, "\n");
+
+    uint64_t position = 0;
+    fwrite(&e, sizeof(e), 1, f);
+    position += sizeof(e);
+    for (int j = 0; j < ds->nbColonne; j++) position += ecrireChaine(f, ds->nomColonne[j]);
+    for (int c = 0; c < ds->nomsClasses.nb; c++) position += ecrireChaine(f, ds->nomsClasses.noms[c]);
+    completerJusqua(f, &position, e.offsetDonnees);
+    fwrite(ds->donnees, sizeof(double), (size_t)(e.n * e.stride), f);
+    position += e.n * e.stride * sizeof(double);
+    completerJusqua(f, &position, e.offsetEtiquettes);
+    fwrite(ds->etiquettes, sizeof(int32_t), (size_t)e.n, f);
+    position += e.n * sizeof(int32_t);
+    completerJusqua(f, &position, e.offsetIndex);
+    fwrite(ds->indexSplit, sizeof(int32_t), (size_t)e.n, f);
+    position += e.n * sizeof(int32_t);
+    completerJusqua(f, &position, e.offsetLabelsSplit);
+    fwrite(ds->sortieAttendue_train, sizeof(int32_t), (size_t)e.nTrain, f);
+    fwrite(ds->sortieAttendue_Teste, sizeof(int32_t), (size_t)e.nTest, f);
+    position += e.n * sizeof(int32_t);
+    if (normalise) {
+        completerJusqua(f, &position, offsetNormalisation);
+        fwrite(ds->normalisation.decalage, sizeof(double), e.nbColonne, f);
+        fwrite(ds->normalisation.echelle, sizeof(double), e.nbColonne, f);
     }
-    for (int i = 0; i < ds->nTest; i++) fprintf(f, "%d\n", ds->sortieAttendue_Teste[i]);
-    for (int i = 0; i < ds->nTrain; i++) fprintf(f, "%d\n", ds->sortieAttendue_train[i]);
-    for (int j = 0; j < ds->nbColonne; j++) {
-        fprintf(f, "%s%s", ds->nomColonne[j], (j == ds->nbColonne - 1) ? "" : ",");
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+        printf("[!] Erreur : ecriture incomplete de %s\n", cheminComplet);
+        return;
     }
-    fprintf(f, "\n%d\n", ds->nbColonne);
-    fclose(f);
     printf("[OK] Sauvegarde effectuee : %s\n", cheminComplet);
 }
 
-// recharge un dataset sauvegarder avec le format spécial.
+// lit une chaine du bloc des noms en vérifiant les bornes, et la copie dans l'arène du dataset.
+static char *lireNomDataSet(DataSet *ds, const char **p, const char *fin){
+    uint32_t n;
+    const char *debut = lireChaine(p, fin, &n);
+    if (debut == NULL) return NULL;
+    return copierChaineDataSet(ds, debut, debut + n);
+}
+
+// vérifie l'entete avant de construire la moindre vue : chaque tableau dans le fichier,
+// les noms avant les données, les indices du split et les labels dans leurs bornes.
+static int validerEnteteDataSet(const EnteteDataSet *e, const char *octets, size_t taille){
+    if (memcmp(e->magie, MAGIE_DATASET, sizeof(MAGIE_DATASET)) != 0 || e->version != VERSION_DATASET ||
+        e->ordreOctets != ORDRE_OCTETS || e->tailleFichier > taille || e->nTrain + e->nTest != e->n ||
+        e->n > INT32_MAX || e->nTrain > e->n || e->nbColonne > INT32_MAX || e->stride < e->nbColonne ||
+        e->stride > (uint64_t)e->nbColonne + 64)
+        return 0;
+    if (e->offsetNoms < sizeof(EnteteDataSet) || e->offsetNoms > e->offsetDonnees) return 0;
+    if (!tableauDansFichier(e->offsetDonnees, e->n * e->stride, sizeof(double), taille) ||
+        !tableauDansFichier(e->offsetEtiquettes, e->n, sizeof(int32_t), taille) ||
+        !tableauDansFichier(e->offsetIndex, e->n, sizeof(int32_t), taille) ||
+        !tableauDansFichier(e->offsetLabelsSplit, e->n, sizeof(int32_t), taille))
+        return 0;
+    const int32_t *etiquettes = (const int32_t *)(octets + e->offsetEtiquettes);
+    const int32_t *index = (const int32_t *)(octets + e->offsetIndex);
+    const int32_t *labelsSplit = (const int32_t *)(octets + e->offsetLabelsSplit);
+    int64_t maxLabel = e->nbClasses > 0 ? (int64_t)e->nbClasses : INT32_MAX;
+    for (uint64_t i = 0; i < e->n; i++) {
+        if (index[i] < 0 || (uint64_t)index[i] >= e->n) return 0;
+        if (etiquettes[i] < 0 || etiquettes[i] >= maxLabel) return 0;
+        if (labelsSplit[i] < 0 || labelsSplit[i] >= maxLabel) return 0;
+    }
+    return 1;
+}
+
+// recharge un dataset sauvegarder avec le format binaire.
+// le fichier est projeté en mémoire : les tableaux du dataset pointent dedans (copie
+// à l'écriture, le fichier n'est jamais modifié) et seules les pages lues sont chargées.
 DataSet* chargerDataSetSpecial(const char *nomFichier) {
     char cheminComplet[512];
     snprintf(cheminComplet, sizeof(cheminComplet), "DataSet/%s", nomFichier);
-    FILE *f = fopen(cheminComplet, "r");
-    if (!f) {
-        printf("[ERREUR FATALE] Impossible d'ouvrir : %s\n", cheminComplet);
-        exit(1);
+    int fd = open(cheminComplet, O_RDONLY);
+    if (fd < 0) {
+        printf("[!] Erreur : Impossible d'ouvrir : %s\n", cheminComplet);
+        return NULL;
     }
-    DataSet *ds = (DataSet *)calloc(1, sizeof(DataSet));
-    if (!ds) exit(1);
-    if (fscanf(f, "%d %d", &ds->nTest, &ds->nTrain) != 2) exit(1);
-    ds->n = ds->nTest + ds->nTrain;
-    fseek(f, -5, SEEK_END);
-    if (fscanf(f, "%d", &ds->nbColonne) != 1) ds->nbColonne = 2;
-    rewind(f);
-    int dummy;
-    fscanf(f, "%d %d", &dummy, &dummy);
-    ds->tab_Teste = allocMat(ds->nTest, ds->nbColonne);
-    ds->tab_Train = allocMat(ds->nTrain, ds->nbColonne);
-    ds->tab_Data  = allocMat(ds->n, ds->nbColonne);
-    ds->sortieAttendue_Teste = (int *)calloc(ds->nTest, sizeof(int));
-    ds->sortieAttendue_train = (int *)calloc(ds->nTrain, sizeof(int));
-    for (int i = 0; i < ds->nTest; i++) {
-        for (int j = 0; j < ds->nbColonne; j++) {
-            fscanf(f, " %lf ,", &ds->tab_Teste[i][j]);
-            ds->tab_Data[i][j] = ds->tab_Teste[i][j];
-        }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(EnteteDataSet)) {
+        printf("[!] Erreur : %s n'est pas un dataset binaire.\n", cheminComplet);
+        close(fd);
+        return NULL;
+    }
+    size_t taille = (size_t)st.st_size;
+    void *base = mmap(NULL, taille, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+    EnteteDataSet e;
+    memcpy(&e, base, sizeof(e));
+    if (!validerEnteteDataSet(&e, base, taille)) {
+        printf("[!] Erreur : %s n'est pas un dataset binaire valide (version %u).\n", cheminComplet, e.version);
+        munmap(base, taille);
+        return NULL;
     }
-    for (int i = 0; i < ds->nTrain; i++) {
-        for (int j = 0; j < ds->nbColonne; j++) {
-            fscanf(f, " %lf ,", &ds->tab_Train[i][j]);
-            ds->tab_Data[i + ds->nTest][j] = ds->tab_Train[i][j];
+    char *octets = base;
+    DataSet *ds = nouveauDataSet();
+    ds->mmapBase = base;
+    ds->mmapTaille = taille;
+    ds->n = (int)e.n;
+    ds->nTrain = (int)e.nTrain;
+    ds->nTest = (int)e.nTest;
+    ds->nbColonne = (int)e.nbColonne;
+    ds->stride = (int)e.stride;
+    ds->donnees = (double *)(octets + e.offsetDonnees);
+    ds->etiquettes = (int *)(octets + e.offsetEtiquettes);
+    ds->indexSplit = (int *)(octets + e.offsetIndex);
+    ds->sortieAttendue_train = (int *)(octets + e.offsetLabelsSplit);
+    ds->sortieAttendue_Teste = ds->sortieAttendue_train + ds->nTrain;
+    if (e.typeNormalisation != NORMALISATION_AUCUNE) {
+        uint64_t offsetNormalisation = aligner64(e.offsetLabelsSplit + e.n * sizeof(int32_t));
+        if (e.typeNormalisation > NORMALISATION_MINMAX ||
+            !tableauDansFichier(offsetNormalisation, 2 * (uint64_t)e.nbColonne, sizeof(double), taille)) {
+            printf("[!] Erreur : normalisation corrompue dans %s\n", cheminComplet);
+            libererDataSet(ds);
+            return NULL;
         }
+        ds->normalisation.type = (int)e.typeNormalisation;
+        ds->normalisation.nbColonne = ds->nbColonne;
+        ds->normalisation.decalage = (double *)(octets + offsetNormalisation);
+        ds->normalisation.echelle = ds->normalisation.decalage + ds->nbColonne;
+    }
+
+    const char *p = octets + e.offsetNoms;
+    const char *finNoms = octets + e.offsetDonnees;
+    ds->nomColonne = allouerDataSet(ds, sizeof(char*) * (size_t)ds->nbColonne, 0);
+    int ok = 1;
+    for (int j = 0; j < ds->nbColonne && ok; j++) ok = (ds->nomColonne[j] = lireNomDataSet(ds, &p, finNoms)) != NULL;
+    for (uint32_t c = 0; c < e.nbClasses && ok; c++) {
+        const char *nom = lireNomDataSet(ds, &p, finNoms);
+        ok = nom != NULL;
+        if (ok) ajouterLabel(&ds->nomsClasses, nom);
     }
-    int *labels_complets = (int *)calloc(ds->n, sizeof(int));
-    for (int i = 0; i < ds->nTest; i++) {
-        fscanf(f, " %d", &ds->sortieAttendue_Teste[i]);
-        labels_complets[i] = ds->sortieAttendue_Teste[i];
-    }
-    for (int i = 0; i < ds->nTrain; i++) {
-        fscanf(f, " %d", &ds->sortieAttendue_train[i]);
-        labels_complets[i + ds->nTest] = ds->sortieAttendue_train[i];
-    }
-    free(ds->sortieAttendue_train);
-    ds->sortieAttendue_train = labels_complets;
-    ds->nom = strdup(nomFichier);
-    ds->nomColonne = (char**)calloc(ds->nbColonne, sizeof(char*));
-    for(int i=0; i<ds->nbColonne; i++) ds->nomColonne[i] = strdup("Col");
-    fclose(f);
+    if (!ok) {
+        printf("[!] Erreur : noms corrompus dans %s\n", cheminComplet);
+        libererDataSet(ds);
+        return NULL;
+    }
+    ds->nom = copierChaineDataSet(ds, nomFichier, nomFichier + strlen(nomFichier));
+    creerVuesDataSet(ds);
+    ds->tab_Train = allouerDataSet(ds, sizeof(double*) * (size_t)ds->n, 0);
+    ds->tab_Teste = ds->tab_Train + ds->nTrain;
+    for (int i = 0; i < ds->nTrain; i++) ds->tab_Train[i] = ligneTrain(ds, i);
+    for (int i = 0; i < ds->nTest; i++) ds->tab_Teste[i] = ligneTeste(ds, i);
     printf("[OK] Chargement %d lignes.\n", ds->n);
     return ds;
-}
\ No newline at end of file
+}
+
+// nombre de classes du dataset : taille du dictionnaire, sinon plus grand label + 1.
+int compterClasses(const DataSet *ds) {
+    if (ds->nomsClasses.nb > 0) return ds->nomsClasses.nb;
+    int ml = -1;
+    for (int i = 0; i < ds->n; i++) {
+        if (ds->etiquettes[i] > ml) ml = ds->etiquettes[i];
+    }
+    return ml + 1;
+}
+
+void listerFichiersDataSet() {
+    struct dirent *lecture;
+    DIR *rep = opendir("DataSet");
+    printf("\n--- FICHIERS DISPONIBLES DANS /DataSet ---\n");
+    if (rep == NULL) {
+        printf("[!] Dossier 'DataSet' introuvable.\n");
+        return;
+    }
+    int count = 0;
+    while ((lecture = readdir(rep))) {
+        printf(" -> %s\n", lecture->d_name);
+        count++;
+    }
+    if (count == 0) printf(" (Aucun DataSet trouvé)\n");
+    printf("------------------------------------------\n");
+    closedir(rep);
+}
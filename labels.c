@@ -0,0 +1,93 @@
+#include "labels.h"
+#include "arene.h"
+#include <sched.h>
+#include <string.h>
+
+// fnv-1a, replié sur 32 bits.
+static uint32_t empreinteNom(const char *nom) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char *c = (const unsigned char *)nom; *c; c++) {
+        h ^= *c;
+        h *= 1099511628211ULL;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+// cherche nom dans une table publiée. les noms sont lus apres la case : un numéro visible
+// dans la table a toujours son nom dans noms.
+static int chercherDans(const DictionnaireLabels *d, const uint64_t *table, const char *nom, uint32_t empreinte) {
+    if (table == NULL) return -1;
+    uint64_t masque = table[0];
+    for (uint64_t i = empreinte & masque;; i = (i + 1) & masque) {
+        uint64_t c = __atomic_load_n(&table[1 + i], __ATOMIC_ACQUIRE);
+        if (c == 0) return -1;
+        if ((uint32_t)(c >> 32) != empreinte) continue;
+        int numero = (int)(uint32_t)c - 1;
+        char **noms = __atomic_load_n(&d->noms, __ATOMIC_ACQUIRE);
+        if (strcmp(noms[numero], nom) == 0) return numero;
+    }
+}
+
+int chercherLabel(const DictionnaireLabels *d, const char *nom) {
+    const uint64_t *table = __atomic_load_n(&d->table, __ATOMIC_ACQUIRE);
+    return chercherDans(d, table, nom, empreinteNom(nom));
+}
+
+static void placer(uint64_t *table, uint64_t c) {
+    uint64_t masque = table[0];
+    uint64_t i = (c >> 32) & masque;
+    while (table[1 + i] != 0) i = (i + 1) & masque;
+    __atomic_store_n(&table[1 + i], c, __ATOMIC_RELEASE);
+}
+
+// nouvelle table deux fois plus grande, publiée une fois remplie. l'ancienne reste dans
+// l'arène pour les lecteurs qui l'ont encore.
+static void agrandirTable(DictionnaireLabels *d) {
+    uint64_t taille = d->table ? (d->table[0] + 1) * 2 : 16;
+    uint64_t *table = allouerArene(d->arene, sizeof(uint64_t) * (size_t)(taille + 1), 0);
+    table[0] = taille - 1;
+    for (int i = 0; i < d->nb; i++) placer(table, (uint64_t)empreinteNom(d->noms[i]) << 32 | (uint64_t)(i + 1));
+    __atomic_store_n(&d->table, table, __ATOMIC_RELEASE);
+}
+
+static void agrandirNoms(DictionnaireLabels *d) {
+    int capacite = d->capacite ? d->capacite * 2 : 8;
+    char **noms = allouerArene(d->arene, sizeof(char *) * (size_t)capacite, 0);
+    if (d->nb > 0) memcpy(noms, d->noms, sizeof(char *) * (size_t)d->nb);
+    __atomic_store_n(&d->noms, noms, __ATOMIC_RELEASE);
+    d->capacite = capacite;
+}
+
+static void verrouiller(DictionnaireLabels *d) {
+    while (__atomic_exchange_n(&d->verrou, 1, __ATOMIC_ACQUIRE)) sched_yield();
+}
+
+static void deverrouiller(DictionnaireLabels *d) {
+    __atomic_store_n(&d->verrou, 0, __ATOMIC_RELEASE);
+}
+
+int ajouterLabel(DictionnaireLabels *d, const char *nom) {
+    uint32_t empreinte = empreinteNom(nom);
+    int numero = chercherDans(d, __atomic_load_n(&d->table, __ATOMIC_ACQUIRE), nom, empreinte);
+    if (numero >= 0) return numero;
+    verrouiller(d);
+    // un autre thread a pu l'ajouter entre temps.
+    numero = chercherDans(d, d->table, nom, empreinte);
+    if (numero < 0) {
+        if (d->arene == NULL) d->arene = creerArene(0);
+        if (d->nb == d->capacite) agrandirNoms(d);
+        // au plus une case pleine sur deux.
+        if (d->table == NULL || (uint64_t)(d->nb + 1) * 2 > d->table[0] + 1) agrandirTable(d);
+        numero = d->nb;
+        d->noms[numero] = copierChaineArene(d->arene, nom, strlen(nom));
+        placer(d->table, (uint64_t)empreinte << 32 | (uint64_t)(numero + 1));
+        __atomic_store_n(&d->nb, numero + 1, __ATOMIC_RELEASE);
+    }
+    deverrouiller(d);
+    return numero;
+}
+
+void libererDictionnaire(DictionnaireLabels *d) {
+    libererArene(d->arene);
+    memset(d, 0, sizeof(*d));
+}
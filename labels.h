@@ -0,0 +1,29 @@
+#ifndef LABELS_H_
+#define LABELS_H_
+
+#include <stdint.h>
+
+// noms des classes dans l'ordre de leur numéro (propre à chaque dataset ou modele).
+// une table de hachage (adressage ouvert) donne le numéro d'un nom sans parcourir la liste.
+// tout est pris dans une arène privée, créée au premier ajout : une structure mise à zéro
+// est un dictionnaire vide.
+// ajouterLabel peut etre apelé par plusieurs threads à la fois (les ajouts passent par un
+// verrou, les recherches n'en prennent pas) ; chercherLabel aussi, pendant les ajouts.
+typedef struct DictionnaireLabels {
+    // noms[i] = nom de la classe i, pour i < nb.
+    char **noms;
+    int nb;
+    int capacite;
+    // table[0] = masque (taille - 1), puis les cases : empreinte << 32 | (numéro + 1), 0 = vide.
+    uint64_t *table;
+    struct Arene *arene;
+    int verrou;
+} DictionnaireLabels;
+
+// numéro de la classe nom, -1 si elle n'est pas dans le dictionnaire.
+int chercherLabel(const DictionnaireLabels *d, const char *nom);
+// numéro de la classe nom, ajoutée à la fin si elle est nouvelle.
+int ajouterLabel(DictionnaireLabels *d, const char *nom);
+void libererDictionnaire(DictionnaireLabels *d);
+
+#endif //LABELS_H_
@@ -5,7 +5,13 @@
 
 #include "dataSet.h"
 #include "perceptron.h"
+#include "cli.h"
+#include "statistiques.h"
+#include "normalisation.h"
+#include "precision.h"
+#ifdef AVEC_RAYLIB
 #include "visual.h"
+#endif
 
 // afiche un petit graphique en texte dans la console pour voir les points.
 void afficherNuagePoints(DataSet *ds) {
@@ -18,15 +24,20 @@ void afficherNuagePoints(DataSet *ds) {
         grille[i][LARGEUR] = '\0';
     }
 
-    if (!ds || !ds->tab_Train || ds->nTrain <= 0) {
+    if (!ds || !ds->indexSplit || ds->nTrain <= 0) {
         printf("\n[!] Donnees non disponibles. Faites l'option 2 ou 13.\n");
         return;
     }
+    if (ds->creux) {
+        printf("\n[!] Nuage de points indisponible pour un dataset creux.\n");
+        return;
+    }
 
     for (int i = 0; i < ds->nTrain; i++) {
         // on utilise les colones 0 et 1 pour la visualisation par defaut
-        int x = (int)((ds->tab_Train[i][0] / 8.0) * LARGEUR);
-        int y = (int)((ds->tab_Train[i][1] / 5.0) * HAUTEUR);
+        const double *ligne = ligneTrain(ds, i);
+        int x = (int)((ligne[0] / 8.0) * LARGEUR);
+        int y = (int)((ligne[1] / 5.0) * HAUTEUR);
 
         if (x >= 0 && x < LARGEUR && y >= 0 && y < HAUTEUR) {
             char symbole = (ds->sortieAttendue_train[i] == 0) ? 'S' :
@@ -41,7 +52,46 @@ void afficherNuagePoints(DataSet *ds) {
     }
 }
 
-int main(void) {
+// libere le modele courant (binaire ou experts), qu'il vienne d'un entrainement ou d'un fichier.
+static void libererModeleCourant(Perceptron **pBin, Perceptron ***experts, int nbExperts, Modele **modele) {
+    if (*modele) {
+        libererModele(*modele);
+    } else {
+        if (*pBin) libererPerceptron(*pBin);
+        if (*experts) {
+            for (int i = 0; i < nbExperts; i++) if ((*experts)[i]) libererPerceptron((*experts)[i]);
+            free(*experts);
+        }
+    }
+    *modele = NULL;
+    *pBin = NULL;
+    *experts = NULL;
+}
+
+// un modele chargé a été entrainé sur des données normalisées : on aplique la meme transformation.
+static void normaliserCommeModele(DataSet *ds, const Modele *modele, int nbThreads) {
+    if (!modele || modele->normalisation.type == NORMALISATION_AUCUNE || ds->n == 0) return;
+    if (ds->creux || modele->nPoids != ds->nbColonne) return;
+    if (appliquerNormalisation(ds, &modele->normalisation, nbThreads)) {
+        printf("[OK] Normalisation du modele appliquee (%s).\n", nomNormalisation(modele->normalisation.type));
+    }
+}
+
+// vrai si ds est normalisé avec des paramètres calculés sur son propre train (et pas ceux
+// du modele chargé, venus d'autres données).
+static int normaliseSurSonTrain(const DataSet *ds, const Modele *modele) {
+    const Normalisation *n = &ds->normalisation;
+    if (n->type == NORMALISATION_AUCUNE) return 0;
+    if (!modele || modele->normalisation.type != n->type || modele->normalisation.nbColonne != n->nbColonne) return 1;
+    size_t taille = sizeof(double) * (size_t)n->nbColonne;
+    return memcmp(modele->normalisation.decalage, n->decalage, taille) != 0 ||
+           memcmp(modele->normalisation.echelle, n->echelle, taille) != 0;
+}
+
+int main(int argc, char **argv) {
+    // avec des arguments : mode ligne de commande, sans menu ni fenetre.
+    if (argc > 1) return executerCLI(argc, argv);
+
     srand((unsigned int)time(NULL));
 
     DataSet *ds = (DataSet *)calloc(1, sizeof(DataSet));
@@ -50,12 +100,20 @@ int main(void) {
 
     Perceptron *pBin = NULL;
     Perceptron **experts = NULL;
+    Modele *modele = NULL;
     int nbClasses = 0;
+    int nbExperts = 0;
     int choix = 0;
     char nomFichier[256];
 
     int epoques = 1000;
     double pasApprentissage = 0.01;
+    int nbThreads = 1;
+    int tailleBatch = 0;
+    int modeApprentissage = MODE_CLASSIQUE;
+    int typeNormalisation = NORMALISATION_AUCUNE;
+    // réglages d'arret et historique du dernier entrainement (courbe de la visualisation).
+    SuiviEntrainement *suivi = creerSuivi(4096);
 
     while (choix != 16) {
         printf("\n============================================\n");
@@ -66,12 +124,12 @@ int main(void) {
         printf("2.  Melanger & Split (80/20)\n");
         printf("3.  Entrainer le modele (Binaire ou Multi)\n");
         printf("4.  Calculer Accuracy\n");
-        printf("5.  Sauvegarder Perceptron (.txt)\n");
-        printf("6.  Charger Perceptron (.txt)\n");
+        printf("5.  Sauvegarder Modele (binaire)\n");
+        printf("6.  Charger Modele\n");
         printf("7.  Visualisation Raylib (Frontiere 2D)\n");
         printf("8.  Aide & Documentation\n");
         printf("9.  Inspecter Valeur (Ligne/Col)\n");
-        printf("10. Modifier Hyperparametres (Epoques/Pas)\n");
+        printf("10. Modifier Hyperparametres (Epoques/Pas/Threads/Batch/Regle/Arret)\n");
         printf("11. Statistiques (Moyenne/Ecart-Type)\n");
         printf("12. Sauvegarder DataSet Special (/DataSet)\n");
         printf("13. Charger DataSet Special (/DataSet)\n");
@@ -88,88 +146,135 @@ int main(void) {
                 break;
 
             case 2:
-                if (ds->n > 0 && ds->tab_Data != NULL) {
+                if (normaliseSurSonTrain(ds, modele)) {
+                    // les paramètres viennent du train actuel : un nouveau split mettrait des
+                    // lignes de ce train dans le teste.
+                    printf("[!] Donnees normalisees sur le split actuel : recharger le dataset avant un nouveau split.\n");
+                } else if (ds->n > 0 && (ds->donnees != NULL || ds->creux != NULL)) {
                     melanger(ds);
                     printf("[OK] Split effectue.\n");
+                    // paramètres calculés sur ce train, gardés dans le dataset puis dans le modele.
+                    if (typeNormalisation != NORMALISATION_AUCUNE && ds->normalisation.type == NORMALISATION_AUCUNE &&
+                        normaliserDataSet(ds, typeNormalisation, nbThreads)) {
+                        printf("[OK] Donnees normalisees (%s).\n", nomNormalisation(typeNormalisation));
+                    }
                 } else {
                     printf("[!] Dataset vide.\n");
                 }
                 break;
 
             case 3:
-                if (!ds->tab_Train) {
+                if (!ds->indexSplit) {
                     printf("[!] aucune donnee d'entrainement disponible.\n");
                     break;
                 }
-                if (pBin) { libererPerceptron(pBin); pBin = NULL; }
-                if (experts) {
-                    for(int i=0; i<nbClasses; i++) if(experts[i]) libererPerceptron(experts[i]);
-                    free(experts); experts = NULL;
-                }
+                libererModeleCourant(&pBin, &experts, nbExperts, &modele);
 
                 if (nbClasses <= 2) {
                     pBin = createPerceptron(ds->nbColonne, epoques);
                     pBin->pasApprentissage = pasApprentissage;
-                    entrainerPerceptron(ds, pBin);
+                    pBin->tailleBatch = tailleBatch;
+                    pBin->nbThreads = nbThreads;
+                    pBin->modeApprentissage = modeApprentissage;
+                    entrainerPerceptronSuivi(ds, pBin, suivi);
                     printf("[OK] Entrainement binaire fini.\n");
                 } else {
                     printf("[INFO] Mode Multi-classe detecte. Creation de %d experts...\n", nbClasses);
                     experts = malloc(nbClasses * sizeof(Perceptron*));
+                    nbExperts = nbClasses;
                     for (int i = 0; i < nbClasses; i++) {
                         experts[i] = createPerceptron(ds->nbColonne, epoques);
                         experts[i]->pasApprentissage = pasApprentissage;
+                        experts[i]->tailleBatch = tailleBatch;
+                        experts[i]->nbThreads = nbThreads;
+                        experts[i]->modeApprentissage = modeApprentissage;
                     }
-                    entrainerMultiClasse(experts, nbClasses, ds);
+                    entrainerMultiClasseSuivi(experts, nbClasses, ds, nbThreads, suivi);
                     printf("[OK] Entrainement Multi-classe fini.\n");
                 }
+                printf("[INFO] %d epoque(s) en %.2fs, arret : %s. Meilleure epoque %d (%d erreur(s) %s).\n",
+                       epoquesTerminees(suivi), suivi->duree, nomArret(suivi->raisonArret), suivi->meilleureEpoque + 1,
+                       suivi->meilleuresErreurs, suivi->nValidation > 0 ? "en validation" : "sur le train");
                 break;
 
             case 4:
-                if (nbClasses <= 2 && pBin && ds->tab_Teste) {
-                    printf("Accuracy Binaire : %.2f%%\n", accuracy(pBin, ds) * 100.0);
-                } else if (nbClasses > 2 && experts && ds->tab_Teste) {
-                    int succes = 0;
-                    for (int i = 0; i < ds->nTest; i++) {
-                        int pred = predireMulti(experts, nbClasses, ds->tab_Teste[i]);
-                        if (pred == ds->sortieAttendue_Teste[i]) succes++;
-                    }
-                    printf("Accuracy Multi-classe : %.2f%%\n", ((double)succes / ds->nTest) * 100.0);
+                if (nbClasses <= 2 && pBin && ds->indexSplit) {
+                    pBin->accuracy = accuracy(pBin, ds);
+                    printf("Accuracy Binaire : %.2f%%\n", pBin->accuracy * 100.0);
+                } else if (nbClasses > 2 && experts && ds->indexSplit) {
+                    double acc = accuracyMulti(experts, nbClasses, ds);
+                    for (int i = 0; i < nbClasses; i++) experts[i]->accuracy = acc;
+                    printf("Accuracy Multi-classe : %.2f%%\n", acc * 100.0);
                 } else {
                     printf("[!] Modele non entraine ou donnees manquantes.\n");
                 }
                 break;
 
             case 5:
-                if (pBin) {
+                if (pBin || experts) {
+                    int precision = PRECISION_DOUBLE;
                     printf("Nom fichier : "); scanf("%s", nomFichier);
-                    sauvegarderPerceptron(pBin, nomFichier);
+                    printf("Poids en plus pour la prediction (0 aucun, 1 float, 2 int8) : ");
+                    if (scanf("%d", &precision) != 1 || precision < PRECISION_DOUBLE || precision > PRECISION_INT8)
+                        precision = PRECISION_DOUBLE;
+                    int ok = pBin ? sauvegarderModelePrecision(&pBin, 1, ds, nomFichier, precision)
+                                  : sauvegarderModelePrecision(experts, nbClasses, ds, nomFichier, precision);
+                    if (ok) printf("[OK] Modele sauvegarde : Perceptron/%s\n", nomFichier);
+                } else {
+                    printf("[!] Aucun modele a sauvegarder.\n");
                 }
                 break;
 
-            case 6:
+            case 6: {
                 listerFichiersPerceptron();
                 printf("Nom fichier : "); scanf("%s", nomFichier);
-                if (pBin) libererPerceptron(pBin);
-                pBin = chargerPerceptron(nomFichier);
+                Modele *charge = chargerModele(nomFichier);
+                if (!charge) break;
+                if (ds->creux && ds->nbColonne < charge->nPoids) elargirDataSetCreux(ds, charge->nPoids);
+                // un modele qui n'a pas la largeur du dataset est refusé : le modele courant est gardé.
+                if (ds->n > 0 && charge->nPoids != ds->nbColonne) {
+                    printf("[!] Le modele attend %d colonnes, le dataset en a %d.\n", charge->nPoids, ds->nbColonne);
+                    libererModele(charge);
+                    break;
+                }
+                libererModeleCourant(&pBin, &experts, nbExperts, &modele);
+                modele = charge;
+                if (modele->nbExperts == 1) {
+                    pBin = modele->experts[0];
+                    nbClasses = 2;
+                } else {
+                    experts = modele->experts;
+                    nbExperts = nbClasses = modele->nbExperts;
+                }
+                normaliserCommeModele(ds, modele, nbThreads);
+                printf("[OK] Modele charge : %d expert(s), %d poids, precision %s.\n", modele->nbExperts,
+                       modele->nPoids, nomPrecision(modele->precision));
                 break;
+            }
 
             case 7:
-                if (pBin && ds->nbColonne >= 2) {
-                    visual_run_with_model_custom(ds, pBin, 0, 1);
+#ifdef AVEC_RAYLIB
+                if (pBin && ds->nbColonne >= 2 && !ds->creux) {
+                    visual_run_with_model_custom(ds, pBin, 0, 1, epoquesTerminees(suivi) > 0 ? suivi : NULL);
                 } else {
-                    printf("[!] Visu Raylib dispo seulement pour le mode binaire.\n");
+                    printf("[!] Visu Raylib dispo seulement pour le mode binaire sur un csv.\n");
                 }
+#else
+                printf("[!] Programme compile sans raylib : visualisation indisponible.\n");
+#endif
                 break;
             case 8:
                 printf("\n==========================================================\n");
                 printf("                GUIDE D'UTILISATION RAPIDE                \n");
                 printf("==========================================================\n");
                 printf("1. CHARGEMENT : utilise l'option [14] pour un CSV classique\n");
+                printf("   (ou un fichier libsvm .svm, garde en lignes creuses)\n");
                 printf("   ou l'option [13] pour un dataset special deja splitte.\n\n");
                 printf("2. PREPARATION : l'option [2] est OBLIGATOIRE pour melanger\n");
                 printf("   les donnees et creer les sets d'entrainement et de test.\n\n");
                 printf("3. REGLAGES : l'option [10] permet de modifier les epoques\n");
-                printf("   et le pas d'apprentissage (Learning Rate).\n\n");
+                printf("   et le pas d'apprentissage (Learning Rate), ainsi que la\n");
+                printf("   normalisation apliquee au prochain split.\n\n");
                 printf("4. APPRENTISSAGE : l'option [3] entraine le neurone. Elle\n");
                 printf("   bascule toute seule en Multi-Classe si besoin.\n\n");
                 printf("5. EVALUATION : l'option [4] calcul le pourcentage de reussite\n");
@@ -178,7 +283,7 @@ int main(void) {
                 break;
 
                 case 9:
-                if (ds->n > 0 && ds->tab_Data) {
+                if (ds->n > 0 && (ds->donnees || ds->creux)) {
                     int l, c;
                     printf("ligne a inspecter (0-%d) : ", ds->n - 1);
                     scanf("%d", &l);
@@ -188,8 +293,8 @@ int main(void) {
                     // on verifie que l'utilisateur demande pas n'importe quoi
                     if (l >= 0 && l < ds->n && c >= 0 && c < ds->nbColonne) {
                         printf("\n[INSPECTION] Ligne %d | Colone %d (%s) : %f\n",
-                                l, c, ds->nomColonne[c], ds->tab_Data[l][c]);
-                        printf("[LABEL REEL] : %d\n", ds->sortieAttendue_train[l]);
+                                l, c, ds->nomColonne ? ds->nomColonne[c] : "-", valeurDataSet(ds, l, c));
+                        printf("[LABEL REEL] : %d\n", ds->etiquettes[l]);
                     } else {
                         printf("[!] erreur : index hors limite du dataset.\n");
                     }
@@ -201,20 +306,49 @@ int main(void) {
             case 10:
                 printf("Epoques (actuel %d) : ", epoques); scanf("%d", &epoques);
                 printf("Pas d'apprentissage (actuel %f) : ", pasApprentissage); scanf("%lf", &pasApprentissage);
+                printf("Threads, 0 = auto (actuel %d) : ", nbThreads); scanf("%d", &nbThreads);
+                printf("Taille mini-batch, 0 = en ligne (actuel %d) : ", tailleBatch); scanf("%d", &tailleBatch);
+                printf("Normalisation au split, 0 = aucune, 1 = standard, 2 = min-max (actuel %d) : ", typeNormalisation);
+                scanf("%d", &typeNormalisation);
+                if (typeNormalisation < NORMALISATION_AUCUNE || typeNormalisation > NORMALISATION_MINMAX)
+                    typeNormalisation = NORMALISATION_AUCUNE;
+                printf("Regle, 0 = classique, 1 = pocket, 2 = moyenne (actuel %d) : ", modeApprentissage);
+                scanf("%d", &modeApprentissage);
+                if (modeApprentissage < MODE_CLASSIQUE || modeApprentissage > MODE_MOYENNE) modeApprentissage = MODE_CLASSIQUE;
+                printf("Patience en epoques, 0 = aucune (actuel %d) : ", suivi->patience); scanf("%d", &suivi->patience);
+                printf("Part du train en validation, 0 = aucune (actuel %.2f) : ", suivi->partValidation);
+                scanf("%lf", &suivi->partValidation);
+                printf("Budget en secondes, 0 = illimite (actuel %.1f) : ", suivi->budgetSecondes);
+                scanf("%lf", &suivi->budgetSecondes);
                 break;
 
             case 11:
-                if (ds->n > 0) {
+                if (ds->creux) {
+                    printf("[!] Statistiques indisponibles pour un dataset creux.\n");
+                } else if (ds->n > 0) {
+                    const StatistiquesDataSet *st = statistiquesDataSet(ds, nbThreads);
                     for (int j = 0; j < ds->nbColonne; j++) {
-                        printf("[%s] Moy: %.2f | E-T: %.2f\n", ds->nomColonne[j], moyenne(ds, j), ecartType(ds, j));
+                        const StatColonne *c = &st->colonnes[j];
+                        printf("[%s] Moy: %.2f | E-T: %.2f | Min: %.2f | Q1: %.2f | Med: %.2f | Q3: %.2f | Max: %.2f\n",
+                               ds->nomColonne[j], c->moyenne, c->ecartType, c->min, c->q1, c->mediane, c->q3, c->max);
+                    }
+                    // moyenne (écart-type) de chaque colone, classe par classe.
+                    for (int k = 0; k < st->nbClasses; k++) {
+                        const char *nom = k < ds->nomsClasses.nb ? ds->nomsClasses.noms[k] : "?";
+                        printf("  classe %d (%s, %d lignes) :", k, nom, st->effectifClasse[k]);
+                        for (int j = 0; j < ds->nbColonne; j++) {
+                            size_t idx = (size_t)k * ds->nbColonne + j;
+                            printf(" %.2f (%.2f)", st->moyenneClasse[idx], st->ecartTypeClasse[idx]);
+                        }
+                        printf("\n");
                     }
                 }
                 break;
 
             case 12:
                 // sauvgarde de l'etat complet du dataset (train + teste)
-                if (ds->tab_Train && ds->tab_Teste) {
-                    printf("Nom du fichier de sauvegarde (ex: iris_split.txt) : ");
+                if (ds->indexSplit) {
+                    printf("Nom du fichier de sauvegarde (ex: iris_split.bin) : ");
                     scanf("%s", nomFichier);
                     sauvegarderDataSetSpecial(ds, nomFichier);
                 } else {
@@ -229,12 +363,9 @@ int main(void) {
                 if (dsRelu) {
                     libererDataSet(ds);
                     ds = dsRelu;
-                    int ml = -1;
-                    for (int i = 0; i < ds->n; i++) {
-                        if (ds->sortieAttendue_train[i] > ml) ml = ds->sortieAttendue_train[i];
-                    }
-                    nbClasses = ml + 1;
+                    nbClasses = compterClasses(ds);
                     printf("[OK] Dataset charger. Classes detectées : %d\n", nbClasses);
+                    normaliserCommeModele(ds, modele, nbThreads);
                 }
                 break;
 
@@ -244,12 +375,9 @@ int main(void) {
                 if (temp) {
                     libererDataSet(ds);
                     ds = temp;
-                    int ml = -1;
-                    for (int i = 0; i < ds->n; i++) {
-                        if (ds->sortieAttendue_train[i] > ml) ml = ds->sortieAttendue_train[i];
-                    }
-                    nbClasses = ml + 1;
+                    nbClasses = compterClasses(ds);
                     printf("[OK] CSV charger. Classes : %d\n", nbClasses);
+                    normaliserCommeModele(ds, modele, nbThreads);
                 }
                 break;
 
@@ -264,11 +392,8 @@ int main(void) {
         }
     }
 
-    if (pBin) libererPerceptron(pBin);
-    if (experts) {
-        for(int i=0; i<nbClasses; i++) if(experts[i]) libererPerceptron(experts[i]);
-        free(experts);
-    }
+    libererModeleCourant(&pBin, &experts, nbExperts, &modele);
+    libererSuivi(suivi);
     libererDataSet(ds);
     return 0;
 }
\ No newline at end of file
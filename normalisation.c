@@ -0,0 +1,123 @@
+#include "normalisation.h"
+#include "parallele.h"
+#include "statistiques.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    DataSet *ds;
+    const double *decalage;
+    const double *echelle;
+} ContexteApplication;
+
+static const char *nomsNormalisation[] = { "aucune", "standard", "minmax" };
+
+const char *nomNormalisation(int type) {
+    if (type < NORMALISATION_AUCUNE || type > NORMALISATION_MINMAX) return "inconnue";
+    return nomsNormalisation[type];
+}
+
+int typeNormalisationDepuisNom(const char *nom) {
+    for (int t = NORMALISATION_AUCUNE; t <= NORMALISATION_MINMAX; t++) {
+        if (strcmp(nom, nomsNormalisation[t]) == 0) return t;
+    }
+    return -1;
+}
+
+static void tacheApplication(void *ctx, int debut, int fin) {
+    ContexteApplication *c = ctx;
+    int d = c->ds->nbColonne;
+    for (int i = debut; i < fin; i++) {
+        double *ligne = ligneData(c->ds, i);
+        for (int j = 0; j < d; j++) ligne[j] = (ligne[j] - c->decalage[j]) * c->echelle[j];
+    }
+}
+
+// copie les paramètres dans le dataset et transforme toutes ses lignes.
+static void transformer(DataSet *ds, int type, const double *decalage, const double *echelle, int nbThreads) {
+    size_t taille = sizeof(double) * (size_t)(ds->nbColonne > 0 ? ds->nbColonne : 1);
+    double *dec = malloc(taille);
+    double *ech = malloc(taille);
+    if (!dec || !ech) {
+        printf("Erreur : memoire insuffisante pour la normalisation\n");
+        exit(1);
+    }
+    memcpy(dec, decalage, sizeof(double) * (size_t)ds->nbColonne);
+    memcpy(ech, echelle, sizeof(double) * (size_t)ds->nbColonne);
+    ContexteApplication ca = { ds, dec, ech };
+    executerParallele(nbThreads, ds->n, 4096, tacheApplication, &ca);
+    ds->normalisation.type = type;
+    ds->normalisation.nbColonne = ds->nbColonne;
+    ds->normalisation.decalage = dec;
+    ds->normalisation.echelle = ech;
+    invaliderStatistiques(ds);
+}
+
+int normaliserDataSet(DataSet *ds, int type, int nbThreads) {
+    if (type != NORMALISATION_STANDARD && type != NORMALISATION_MINMAX) {
+        printf("Erreur : normalisation inconnue\n");
+        return 0;
+    }
+    if (ds->normalisation.type != NORMALISATION_AUCUNE) {
+        printf("Erreur : donnees deja normalisees (%s)\n", nomNormalisation(ds->normalisation.type));
+        return 0;
+    }
+    if (ds->creux) {
+        // le décalage rendrait toutes les valeurs non nulles.
+        printf("Erreur : normalisation indisponible sur un dataset creux\n");
+        return 0;
+    }
+    if (ds->n == 0 || ds->nbColonne == 0) return 0;
+    int d = ds->nbColonne;
+    double *decalage = malloc(sizeof(double) * (size_t)d);
+    double *echelle = malloc(sizeof(double) * (size_t)d);
+    if (!decalage || !echelle) {
+        printf("Erreur : memoire insuffisante pour la normalisation\n");
+        exit(1);
+    }
+    // paramètres sur les lignes du train si le dataset est splitté, sinon sur toutes : un
+    // parcours des lignes dans l'ordre, les autres sont sautées.
+    StatColonne *colonnes = malloc(sizeof(StatColonne) * (size_t)d);
+    const int split = ds->indexSplit && ds->nTrain > 0;
+    char *selection = split ? calloc((size_t)ds->n, 1) : NULL;
+    if (!colonnes || (split && !selection)) {
+        printf("Erreur : memoire insuffisante pour la normalisation\n");
+        exit(1);
+    }
+    if (selection) for (int i = 0; i < ds->nTrain; i++) selection[ds->indexSplit[i]] = 1;
+    momentsColonnes(ds, selection, colonnes, nbThreads);
+    free(selection);
+    for (int j = 0; j < d; j++) {
+        double etendue = type == NORMALISATION_STANDARD ? colonnes[j].ecartType : colonnes[j].max - colonnes[j].min;
+        decalage[j] = type == NORMALISATION_STANDARD ? colonnes[j].moyenne : colonnes[j].min;
+        echelle[j] = etendue > 0 ? 1.0 / etendue : 1.0;
+    }
+    free(colonnes);
+    transformer(ds, type, decalage, echelle, nbThreads);
+    free(decalage);
+    free(echelle);
+    return 1;
+}
+
+int appliquerNormalisation(DataSet *ds, const Normalisation *norm, int nbThreads) {
+    if (norm == NULL || norm->type == NORMALISATION_AUCUNE) return 1;
+    if (ds->creux) {
+        printf("Erreur : normalisation indisponible sur un dataset creux\n");
+        return 0;
+    }
+    if (norm->nbColonne != ds->nbColonne) {
+        printf("Erreur : normalisation sur %d colones, donnees sur %d\n", norm->nbColonne, ds->nbColonne);
+        return 0;
+    }
+    const Normalisation *actuelle = &ds->normalisation;
+    if (actuelle->type != NORMALISATION_AUCUNE) {
+        size_t taille = sizeof(double) * (size_t)ds->nbColonne;
+        if (actuelle->type == norm->type && memcmp(actuelle->decalage, norm->decalage, taille) == 0 &&
+            memcmp(actuelle->echelle, norm->echelle, taille) == 0) return 1;
+        printf("Erreur : donnees deja normalisees avec d'autres parametres\n");
+        return 0;
+    }
+    transformer(ds, norm->type, norm->decalage, norm->echelle, nbThreads);
+    return 1;
+}
@@ -0,0 +1,22 @@
+#ifndef NORMALISATION_H_
+#define NORMALISATION_H_
+
+#include "dataSet.h"
+
+// "aucune", "standard" (moyenne 0, écart-type 1) ou "minmax" (valeurs ramenées dans [0, 1]).
+const char *nomNormalisation(int type);
+// type corespondant à un nom, -1 si inconnu.
+int typeNormalisationDepuisNom(const char *nom);
+
+// calcule les paramètres sur les lignes du train (toutes les lignes si le dataset n'est pas
+// splitté) puis normalise donnees en place, en un seul passage réparti sur nbThreads
+// (0 = un par coeur). une colone constante garde une échelle de 1. retourne 1 si ok,
+// 0 si le type est inconnu, si les données sont déjà normalisées ou si le dataset est creux.
+int normaliserDataSet(DataSet *ds, int type, int nbThreads);
+
+// aplique des paramètres déjà calculés (ceux d'un modele chargé) à des données brutes.
+// ne fait rien si ds a déjà exactement cette normalisation. retourne 0 si le nombre de
+// colones ne corespond pas, si ds est normalisé autrement ou s'il est creux.
+int appliquerNormalisation(DataSet *ds, const Normalisation *norm, int nbThreads);
+
+#endif //NORMALISATION_H_
@@ -0,0 +1,1195 @@
+#include "noyau.h"
+#include "parallele.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NOYAU_X86 1
+#include <immintrin.h>
+#endif
+
+// ==================== ORDRE DE CALCUL COMMUN ====================
+// les éléments sont répartis sur 8 acumulateurs (voie = i % 8) tant qu'il reste
+// un bloc complet de 8, puis les voies sont réduites par paires dans un ordre fixe,
+// et la queue (n % 8 éléments) est ajoutée séquentiellement.
+// aucune variante n'utilise de fma pour garder les meme arrondis partout
+// (noyau.c doit etre compilé avec -ffp-contract=off, voir CMakeLists.txt).
+
+// les produits scalaires sont aussi recopiés pour chaque largeur fixe (voir LARGEURS FIXES) :
+// ils doivent pouvoir etre insérés dans l'apelant.
+#define EN_LIGNE inline __attribute__((always_inline))
+
+static double reduire8(const double v[8]) {
+    return ((v[0] + v[4]) + (v[2] + v[6])) + ((v[1] + v[5]) + (v[3] + v[7]));
+}
+
+static EN_LIGNE double produitScalaireScalaire(const double *a, const double *b, int n) {
+    double acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int l = 0; l < 8; l++) acc[l] += a[i + l] * b[i + l];
+    }
+    double somme = reduire8(acc);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+static EN_LIGNE void produitScalaire4Scalaire(const double *w, const double *const lignes[4], int n,
+                                     double sortie[4]) {
+    double acc[4][8] = {{0}};
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int l = 0; l < 8; l++) {
+            double wl = w[i + l];
+            for (int r = 0; r < 4; r++) acc[r][l] += wl * lignes[r][i + l];
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        double somme = reduire8(acc[r]);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+static void ligneDecisionScalaire(const double *xs, int n, const double *a, const double *b, int nbExperts,
+                                  int *labels, double *scores) {
+    for (int p = 0; p < n; p++) {
+        double meilleur = a[0] + b[0] * xs[p];
+        int label = nbExperts == 1 ? meilleur >= 0 : 0;
+        for (int k = 1; k < nbExperts; k++) {
+            double s = a[k] + b[k] * xs[p];
+            if (s > meilleur) {
+                meilleur = s;
+                label = k;
+            }
+        }
+        labels[p] = label;
+        scores[p] = meilleur;
+    }
+}
+
+
+// ==================== FLOAT ET INT8 ====================
+// float : meme principe sur 16 voies (voie = i % 16), réduites d'abord moitié contre
+// moitié puis comme reduire8. un registre avx2 porte 8 floats au lieu de 4 doubles.
+// int8 : sommes entieres exactes, toutes les variantes donnent trivialement le meme
+// résultat. les produits sont acumulés sur 32 bits : l'apelant découpe les longs vecteurs
+// (voir produitScalaireInt8) pour qu'aucune voie ne déborde.
+
+static float reduire16f(const float v[16]) {
+    float r[8];
+    for (int l = 0; l < 8; l++) r[l] = v[l] + v[l + 8];
+    return ((r[0] + r[4]) + (r[2] + r[6])) + ((r[1] + r[5]) + (r[3] + r[7]));
+}
+
+static float produitScalaireFloatScalaire(const float *a, const float *b, int n) {
+    float acc[16] = {0};
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        for (int l = 0; l < 16; l++) acc[l] += a[i + l] * b[i + l];
+    }
+    float somme = reduire16f(acc);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+static int32_t produitScalaireInt8Scalaire(const int8_t *a, const int8_t *b, int n) {
+    int32_t somme = 0;
+    for (int i = 0; i < n; i++) somme += (int32_t)a[i] * b[i];
+    return somme;
+}
+
+// quantification d'une ligne : maximum de |x| (exact quel que soit l'ordre), puis arrondi
+// au plus proche de x * (127 / max), les demis s'éloignant de 0. les variantes simd font
+// les memes opérations double par double et donnent donc les memes octets.
+static int8_t arrondirInt8(double v) {
+    return (int8_t)(int)(v + (v >= 0 ? 0.5 : -0.5));
+}
+
+// maximum des voies d'une variante simd et de la queue de x.
+static double maximumAbsolu(const double *voies, int nbVoies, const double *x, int n) {
+    double m = 0;
+    for (int l = 0; l < nbVoies; l++) m = voies[l] > m ? voies[l] : m;
+    for (int j = 0; j < n; j++) {
+        double a = fabs(x[j]);
+        m = a > m ? a : m;
+    }
+    return m;
+}
+
+static void convertirFloatScalaire(const double *x, int n, float *f) {
+    for (int j = 0; j < n; j++) f[j] = (float)x[j];
+}
+
+static float quantifierInt8Scalaire(const double *x, int n, int8_t *q) {
+    // 4 maximums indépendants pour ne pas attendre chaque comparaison.
+    double max[4] = {0, 0, 0, 0};
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        for (int r = 0; r < 4; r++) {
+            double a = fabs(x[j + r]);
+            max[r] = a > max[r] ? a : max[r];
+        }
+    }
+    double m = maximumAbsolu(max, 4, x + j, n - j);
+    if (m == 0) {
+        memset(q, 0, (size_t)n);
+        return 1.0f;
+    }
+    double inverse = 127.0 / m;
+    for (j = 0; j < n; j++) q[j] = arrondirInt8(x[j] * inverse);
+    return (float)(m / 127.0);
+}
+
+// 4 lignes face aux memes poids : memes voies et meme réduction que pour une ligne.
+static void produitScalaire4FloatScalaire(const float *w, const float *const lignes[4], int n, float sortie[4]) {
+    float acc[4][16] = {{0}};
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        for (int l = 0; l < 16; l++) {
+            float wl = w[i + l];
+            for (int r = 0; r < 4; r++) acc[r][l] += wl * lignes[r][i + l];
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        float somme = reduire16f(acc[r]);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+static void produitScalaire4Int8Scalaire(const int8_t *w, const int8_t *const lignes[4], int n,
+                                         int32_t sortie[4]) {
+    int32_t somme[4] = {0, 0, 0, 0};
+    for (int i = 0; i < n; i++) {
+        int32_t wi = w[i];
+        for (int r = 0; r < 4; r++) somme[r] += wi * lignes[r][i];
+    }
+    for (int r = 0; r < 4; r++) sortie[r] = somme[r];
+}
+
+#ifdef NOYAU_X86
+
+__attribute__((target("sse2")))
+static EN_LIGNE double produitScalaireSSE2(const double *a, const double *b, int n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd(), acc3 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+    }
+    double v[8];
+    _mm_storeu_pd(v, acc0);
+    _mm_storeu_pd(v + 2, acc1);
+    _mm_storeu_pd(v + 4, acc2);
+    _mm_storeu_pd(v + 6, acc3);
+    double somme = reduire8(v);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+__attribute__((target("sse2")))
+static EN_LIGNE void produitScalaire4SSE2(const double *w, const double *const lignes[4], int n,
+                                 double sortie[4]) {
+    __m128d acc[4][4];
+    for (int r = 0; r < 4; r++) {
+        for (int q = 0; q < 4; q++) acc[r][q] = _mm_setzero_pd();
+    }
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128d w0 = _mm_loadu_pd(w + i), w1 = _mm_loadu_pd(w + i + 2);
+        __m128d w2 = _mm_loadu_pd(w + i + 4), w3 = _mm_loadu_pd(w + i + 6);
+        for (int r = 0; r < 4; r++) {
+            const double *x = lignes[r] + i;
+            acc[r][0] = _mm_add_pd(acc[r][0], _mm_mul_pd(w0, _mm_loadu_pd(x)));
+            acc[r][1] = _mm_add_pd(acc[r][1], _mm_mul_pd(w1, _mm_loadu_pd(x + 2)));
+            acc[r][2] = _mm_add_pd(acc[r][2], _mm_mul_pd(w2, _mm_loadu_pd(x + 4)));
+            acc[r][3] = _mm_add_pd(acc[r][3], _mm_mul_pd(w3, _mm_loadu_pd(x + 6)));
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        double v[8];
+        for (int q = 0; q < 4; q++) _mm_storeu_pd(v + 2 * q, acc[r][q]);
+        double somme = reduire8(v);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+__attribute__((target("avx2")))
+static EN_LIGNE double produitScalaireAVX2(const double *a, const double *b, int n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    double v[8];
+    _mm256_storeu_pd(v, acc0);
+    _mm256_storeu_pd(v + 4, acc1);
+    double somme = reduire8(v);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+__attribute__((target("avx2")))
+static EN_LIGNE void produitScalaire4AVX2(const double *w, const double *const lignes[4], int n,
+                                 double sortie[4]) {
+    __m256d acc[4][2];
+    for (int r = 0; r < 4; r++) acc[r][0] = acc[r][1] = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d w0 = _mm256_loadu_pd(w + i), w1 = _mm256_loadu_pd(w + i + 4);
+        for (int r = 0; r < 4; r++) {
+            const double *x = lignes[r] + i;
+            acc[r][0] = _mm256_add_pd(acc[r][0], _mm256_mul_pd(w0, _mm256_loadu_pd(x)));
+            acc[r][1] = _mm256_add_pd(acc[r][1], _mm256_mul_pd(w1, _mm256_loadu_pd(x + 4)));
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        double v[8];
+        _mm256_storeu_pd(v, acc[r][0]);
+        _mm256_storeu_pd(v + 4, acc[r][1]);
+        double somme = reduire8(v);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+__attribute__((target("avx512f")))
+static EN_LIGNE double produitScalaireAVX512(const double *a, const double *b, int n) {
+    __m512d acc = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_add_pd(acc, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    }
+    double v[8];
+    _mm512_storeu_pd(v, acc);
+    double somme = reduire8(v);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+__attribute__((target("avx512f")))
+static EN_LIGNE void produitScalaire4AVX512(const double *w, const double *const lignes[4], int n,
+                                   double sortie[4]) {
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d wv = _mm512_loadu_pd(w + i);
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(wv, _mm512_loadu_pd(lignes[0] + i)));
+        acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(wv, _mm512_loadu_pd(lignes[1] + i)));
+        acc2 = _mm512_add_pd(acc2, _mm512_mul_pd(wv, _mm512_loadu_pd(lignes[2] + i)));
+        acc3 = _mm512_add_pd(acc3, _mm512_mul_pd(wv, _mm512_loadu_pd(lignes[3] + i)));
+    }
+    double v[4][8];
+    _mm512_storeu_pd(v[0], acc0);
+    _mm512_storeu_pd(v[1], acc1);
+    _mm512_storeu_pd(v[2], acc2);
+    _mm512_storeu_pd(v[3], acc3);
+    for (int r = 0; r < 4; r++) {
+        double somme = reduire8(v[r]);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+// les variantes simd traitent plusieurs pixels par registre ; les labels suivent dans
+// un registre de doubles (0.0, 1.0, ...) et la queue passe par la version scalaire.
+__attribute__((target("sse2")))
+static void ligneDecisionSSE2(const double *xs, int n, const double *a, const double *b, int nbExperts,
+                              int *labels, double *scores) {
+    int p = 0;
+    for (; p + 2 <= n; p += 2) {
+        __m128d x = _mm_loadu_pd(xs + p);
+        __m128d meilleur = _mm_add_pd(_mm_set1_pd(a[0]), _mm_mul_pd(_mm_set1_pd(b[0]), x));
+        __m128d label;
+        if (nbExperts == 1) {
+            label = _mm_and_pd(_mm_cmpge_pd(meilleur, _mm_setzero_pd()), _mm_set1_pd(1.0));
+        } else {
+            label = _mm_setzero_pd();
+            for (int k = 1; k < nbExperts; k++) {
+                __m128d s = _mm_add_pd(_mm_set1_pd(a[k]), _mm_mul_pd(_mm_set1_pd(b[k]), x));
+                __m128d m = _mm_cmpgt_pd(s, meilleur);
+                meilleur = _mm_or_pd(_mm_and_pd(m, s), _mm_andnot_pd(m, meilleur));
+                label = _mm_or_pd(_mm_and_pd(m, _mm_set1_pd((double)k)), _mm_andnot_pd(m, label));
+            }
+        }
+        _mm_storeu_pd(scores + p, meilleur);
+        _mm_storel_epi64((__m128i *)(labels + p), _mm_cvtpd_epi32(label));
+    }
+    ligneDecisionScalaire(xs + p, n - p, a, b, nbExperts, labels + p, scores + p);
+}
+
+__attribute__((target("avx2")))
+static void ligneDecisionAVX2(const double *xs, int n, const double *a, const double *b, int nbExperts,
+                              int *labels, double *scores) {
+    int p = 0;
+    for (; p + 4 <= n; p += 4) {
+        __m256d x = _mm256_loadu_pd(xs + p);
+        __m256d meilleur = _mm256_add_pd(_mm256_set1_pd(a[0]), _mm256_mul_pd(_mm256_set1_pd(b[0]), x));
+        __m256d label;
+        if (nbExperts == 1) {
+            label = _mm256_and_pd(_mm256_cmp_pd(meilleur, _mm256_setzero_pd(), _CMP_GE_OQ), _mm256_set1_pd(1.0));
+        } else {
+            label = _mm256_setzero_pd();
+            for (int k = 1; k < nbExperts; k++) {
+                __m256d s = _mm256_add_pd(_mm256_set1_pd(a[k]), _mm256_mul_pd(_mm256_set1_pd(b[k]), x));
+                __m256d m = _mm256_cmp_pd(s, meilleur, _CMP_GT_OQ);
+                meilleur = _mm256_blendv_pd(meilleur, s, m);
+                label = _mm256_blendv_pd(label, _mm256_set1_pd((double)k), m);
+            }
+        }
+        _mm256_storeu_pd(scores + p, meilleur);
+        _mm_storeu_si128((__m128i *)(labels + p), _mm256_cvtpd_epi32(label));
+    }
+    ligneDecisionScalaire(xs + p, n - p, a, b, nbExperts, labels + p, scores + p);
+}
+
+__attribute__((target("avx512f")))
+static void ligneDecisionAVX512(const double *xs, int n, const double *a, const double *b, int nbExperts,
+                                int *labels, double *scores) {
+    int p = 0;
+    for (; p + 8 <= n; p += 8) {
+        __m512d x = _mm512_loadu_pd(xs + p);
+        __m512d meilleur = _mm512_add_pd(_mm512_set1_pd(a[0]), _mm512_mul_pd(_mm512_set1_pd(b[0]), x));
+        __m512d label;
+        if (nbExperts == 1) {
+            __mmask8 m = _mm512_cmp_pd_mask(meilleur, _mm512_setzero_pd(), _CMP_GE_OQ);
+            label = _mm512_mask_blend_pd(m, _mm512_setzero_pd(), _mm512_set1_pd(1.0));
+        } else {
+            label = _mm512_setzero_pd();
+            for (int k = 1; k < nbExperts; k++) {
+                __m512d s = _mm512_add_pd(_mm512_set1_pd(a[k]), _mm512_mul_pd(_mm512_set1_pd(b[k]), x));
+                __mmask8 m = _mm512_cmp_pd_mask(s, meilleur, _CMP_GT_OQ);
+                meilleur = _mm512_mask_blend_pd(m, meilleur, s);
+                label = _mm512_mask_blend_pd(m, label, _mm512_set1_pd((double)k));
+            }
+        }
+        _mm512_storeu_pd(scores + p, meilleur);
+        _mm256_storeu_si256((__m256i *)(labels + p), _mm512_cvtpd_epi32(label));
+    }
+    ligneDecisionScalaire(xs + p, n - p, a, b, nbExperts, labels + p, scores + p);
+}
+
+__attribute__((target("sse2")))
+static float produitScalaireFloatSSE2(const float *a, const float *b, int n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+    }
+    float v[16];
+    _mm_storeu_ps(v, acc0);
+    _mm_storeu_ps(v + 4, acc1);
+    _mm_storeu_ps(v + 8, acc2);
+    _mm_storeu_ps(v + 12, acc3);
+    float somme = reduire16f(v);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+__attribute__((target("avx2")))
+static float produitScalaireFloatAVX2(const float *a, const float *b, int n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    float v[16];
+    _mm256_storeu_ps(v, acc0);
+    _mm256_storeu_ps(v + 8, acc1);
+    float somme = reduire16f(v);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+__attribute__((target("avx512f")))
+static float produitScalaireFloatAVX512(const float *a, const float *b, int n) {
+    __m512 acc = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc = _mm512_add_ps(acc, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    }
+    float v[16];
+    _mm512_storeu_ps(v, acc);
+    float somme = reduire16f(v);
+    for (; i < n; i++) somme += a[i] * b[i];
+    return somme;
+}
+
+// int8 -> int16 par extension de signe, puis madd : paires de produits sommées en 32 bits.
+__attribute__((target("sse2")))
+static int32_t produitScalaireInt8SSE2(const int8_t *a, const int8_t *b, int n) {
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i aBas = _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+        __m128i aHaut = _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+        __m128i bBas = _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8);
+        __m128i bHaut = _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(aBas, bBas));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(aHaut, bHaut));
+    }
+    int32_t v[4];
+    _mm_storeu_si128((__m128i *)v, acc);
+    return v[0] + v[1] + v[2] + v[3] + produitScalaireInt8Scalaire(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static int32_t produitScalaireInt8AVX2(const int8_t *a, const int8_t *b, int n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i)));
+        __m256i b0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i)));
+        __m256i a1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i + 16)));
+        __m256i b1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i + 16)));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(a0, b0));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(a1, b1));
+    }
+    int32_t v[8];
+    _mm256_storeu_si256((__m256i *)v, _mm256_add_epi32(acc0, acc1));
+    int32_t somme = 0;
+    for (int l = 0; l < 8; l++) somme += v[l];
+    return somme + produitScalaireInt8Scalaire(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static int32_t produitScalaireInt8AVX512(const int8_t *a, const int8_t *b, int n) {
+    __m512i acc = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512i va = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)(a + i)));
+        __m512i vb = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)(b + i)));
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+    }
+    return _mm512_reduce_add_epi32(acc) + produitScalaireInt8Scalaire(a + i, b + i, n - i);
+}
+
+// conversion en float : meme arrondi (celui du mode courant) pour toutes les variantes.
+__attribute__((target("sse2")))
+static void convertirFloatSSE2(const double *x, int n, float *f) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m128 bas = _mm_cvtpd_ps(_mm_loadu_pd(x + j));
+        __m128 haut = _mm_cvtpd_ps(_mm_loadu_pd(x + j + 2));
+        _mm_storeu_ps(f + j, _mm_movelh_ps(bas, haut));
+    }
+    for (; j < n; j++) f[j] = (float)x[j];
+}
+
+__attribute__((target("avx2")))
+static void convertirFloatAVX2(const double *x, int n, float *f) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        _mm_storeu_ps(f + j, _mm256_cvtpd_ps(_mm256_loadu_pd(x + j)));
+        _mm_storeu_ps(f + j + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(x + j + 4)));
+    }
+    for (; j < n; j++) f[j] = (float)x[j];
+}
+
+__attribute__((target("avx512f")))
+static void convertirFloatAVX512(const double *x, int n, float *f) {
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        _mm256_storeu_ps(f + j, _mm512_cvtpd_ps(_mm512_loadu_pd(x + j)));
+        _mm256_storeu_ps(f + j + 8, _mm512_cvtpd_ps(_mm512_loadu_pd(x + j + 8)));
+    }
+    for (; j < n; j++) f[j] = (float)x[j];
+}
+
+// quantification par blocs de 16 doubles : 16 entiers 32 bits ramenés à 16 octets (les
+// valeurs sont déjà dans [-127, 127], la saturation des packs ne change rien).
+// le demi prend le signe de v : pour v = -0.0 on ajoute -0.5 au lieu de 0.5, mais les deux
+// sont tronqués à 0, comme dans arrondirInt8.
+__attribute__((target("sse2")))
+static float quantifierInt8SSE2(const double *x, int n, int8_t *q) {
+    const __m128d signe = _mm_set1_pd(-0.0);
+    __m128d max0 = _mm_setzero_pd(), max1 = _mm_setzero_pd();
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        max0 = _mm_max_pd(_mm_andnot_pd(signe, _mm_loadu_pd(x + j)), max0);
+        max1 = _mm_max_pd(_mm_andnot_pd(signe, _mm_loadu_pd(x + j + 2)), max1);
+    }
+    double voies[4];
+    _mm_storeu_pd(voies, max0);
+    _mm_storeu_pd(voies + 2, max1);
+    double m = maximumAbsolu(voies, 4, x + j, n - j);
+    if (m == 0) {
+        memset(q, 0, (size_t)n);
+        return 1.0f;
+    }
+    double inverse = 127.0 / m;
+    const __m128d vi = _mm_set1_pd(inverse), demi = _mm_set1_pd(0.5);
+    for (j = 0; j + 16 <= n; j += 16) {
+        __m128i e[4];
+        for (int b = 0; b < 4; b++) {
+            __m128i paire[2];
+            for (int h = 0; h < 2; h++) {
+                __m128d v = _mm_mul_pd(_mm_loadu_pd(x + j + 4 * b + 2 * h), vi);
+                paire[h] = _mm_cvttpd_epi32(_mm_add_pd(v, _mm_or_pd(demi, _mm_and_pd(v, signe))));
+            }
+            e[b] = _mm_unpacklo_epi64(paire[0], paire[1]);
+        }
+        __m128i octets = _mm_packs_epi16(_mm_packs_epi32(e[0], e[1]), _mm_packs_epi32(e[2], e[3]));
+        _mm_storeu_si128((__m128i *)(q + j), octets);
+    }
+    for (; j < n; j++) q[j] = arrondirInt8(x[j] * inverse);
+    return (float)(m / 127.0);
+}
+
+__attribute__((target("avx2")))
+static float quantifierInt8AVX2(const double *x, int n, int8_t *q) {
+    const __m256d signe = _mm256_set1_pd(-0.0);
+    __m256d max0 = _mm256_setzero_pd(), max1 = _mm256_setzero_pd();
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        max0 = _mm256_max_pd(_mm256_andnot_pd(signe, _mm256_loadu_pd(x + j)), max0);
+        max1 = _mm256_max_pd(_mm256_andnot_pd(signe, _mm256_loadu_pd(x + j + 4)), max1);
+    }
+    double voies[8];
+    _mm256_storeu_pd(voies, max0);
+    _mm256_storeu_pd(voies + 4, max1);
+    double m = maximumAbsolu(voies, 8, x + j, n - j);
+    if (m == 0) {
+        memset(q, 0, (size_t)n);
+        return 1.0f;
+    }
+    double inverse = 127.0 / m;
+    const __m256d vi = _mm256_set1_pd(inverse), demi = _mm256_set1_pd(0.5);
+    for (j = 0; j + 16 <= n; j += 16) {
+        __m128i e[4];
+        for (int b = 0; b < 4; b++) {
+            __m256d v = _mm256_mul_pd(_mm256_loadu_pd(x + j + 4 * b), vi);
+            e[b] = _mm256_cvttpd_epi32(_mm256_add_pd(v, _mm256_or_pd(demi, _mm256_and_pd(v, signe))));
+        }
+        __m128i octets = _mm_packs_epi16(_mm_packs_epi32(e[0], e[1]), _mm_packs_epi32(e[2], e[3]));
+        _mm_storeu_si128((__m128i *)(q + j), octets);
+    }
+    for (; j < n; j++) q[j] = arrondirInt8(x[j] * inverse);
+    return (float)(m / 127.0);
+}
+
+__attribute__((target("avx512f")))
+static float quantifierInt8AVX512(const double *x, int n, int8_t *q) {
+    __m512d max0 = _mm512_setzero_pd(), max1 = _mm512_setzero_pd();
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        max0 = _mm512_max_pd(_mm512_abs_pd(_mm512_loadu_pd(x + j)), max0);
+        max1 = _mm512_max_pd(_mm512_abs_pd(_mm512_loadu_pd(x + j + 8)), max1);
+    }
+    double voies = _mm512_reduce_max_pd(_mm512_max_pd(max0, max1));
+    double m = maximumAbsolu(&voies, 1, x + j, n - j);
+    if (m == 0) {
+        memset(q, 0, (size_t)n);
+        return 1.0f;
+    }
+    double inverse = 127.0 / m;
+    const __m512d vi = _mm512_set1_pd(inverse);
+    const __m512i demi = _mm512_castpd_si512(_mm512_set1_pd(0.5));
+    const __m512i signe = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+    for (j = 0; j + 16 <= n; j += 16) {
+        __m256i e[2];
+        for (int b = 0; b < 2; b++) {
+            __m512d v = _mm512_mul_pd(_mm512_loadu_pd(x + j + 8 * b), vi);
+            __m512i arrondi = _mm512_or_si512(demi, _mm512_and_si512(_mm512_castpd_si512(v), signe));
+            e[b] = _mm512_cvttpd_epi32(_mm512_add_pd(v, _mm512_castsi512_pd(arrondi)));
+        }
+        __m512i entiers = _mm512_inserti64x4(_mm512_castsi256_si512(e[0]), e[1], 1);
+        _mm_storeu_si128((__m128i *)(q + j), _mm512_cvtepi32_epi8(entiers));
+    }
+    for (; j < n; j++) q[j] = arrondirInt8(x[j] * inverse);
+    return (float)(m / 127.0);
+}
+
+// versions 4 lignes : les poids (et leur extension en int16) sont chargés une fois par bloc.
+__attribute__((target("sse2")))
+static void produitScalaire4FloatSSE2(const float *w, const float *const lignes[4], int n, float sortie[4]) {
+    __m128 acc[4][4];
+    for (int r = 0; r < 4; r++) {
+        for (int q = 0; q < 4; q++) acc[r][q] = _mm_setzero_ps();
+    }
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128 w0 = _mm_loadu_ps(w + i), w1 = _mm_loadu_ps(w + i + 4);
+        __m128 w2 = _mm_loadu_ps(w + i + 8), w3 = _mm_loadu_ps(w + i + 12);
+        for (int r = 0; r < 4; r++) {
+            const float *x = lignes[r] + i;
+            acc[r][0] = _mm_add_ps(acc[r][0], _mm_mul_ps(w0, _mm_loadu_ps(x)));
+            acc[r][1] = _mm_add_ps(acc[r][1], _mm_mul_ps(w1, _mm_loadu_ps(x + 4)));
+            acc[r][2] = _mm_add_ps(acc[r][2], _mm_mul_ps(w2, _mm_loadu_ps(x + 8)));
+            acc[r][3] = _mm_add_ps(acc[r][3], _mm_mul_ps(w3, _mm_loadu_ps(x + 12)));
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        float v[16];
+        for (int q = 0; q < 4; q++) _mm_storeu_ps(v + 4 * q, acc[r][q]);
+        float somme = reduire16f(v);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+__attribute__((target("avx2")))
+static void produitScalaire4FloatAVX2(const float *w, const float *const lignes[4], int n, float sortie[4]) {
+    __m256 acc[4][2];
+    for (int r = 0; r < 4; r++) acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 w0 = _mm256_loadu_ps(w + i), w1 = _mm256_loadu_ps(w + i + 8);
+        for (int r = 0; r < 4; r++) {
+            const float *x = lignes[r] + i;
+            acc[r][0] = _mm256_add_ps(acc[r][0], _mm256_mul_ps(w0, _mm256_loadu_ps(x)));
+            acc[r][1] = _mm256_add_ps(acc[r][1], _mm256_mul_ps(w1, _mm256_loadu_ps(x + 8)));
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        float v[16];
+        _mm256_storeu_ps(v, acc[r][0]);
+        _mm256_storeu_ps(v + 8, acc[r][1]);
+        float somme = reduire16f(v);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+__attribute__((target("avx512f")))
+static void produitScalaire4FloatAVX512(const float *w, const float *const lignes[4], int n, float sortie[4]) {
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps(), acc3 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 wv = _mm512_loadu_ps(w + i);
+        acc0 = _mm512_add_ps(acc0, _mm512_mul_ps(wv, _mm512_loadu_ps(lignes[0] + i)));
+        acc1 = _mm512_add_ps(acc1, _mm512_mul_ps(wv, _mm512_loadu_ps(lignes[1] + i)));
+        acc2 = _mm512_add_ps(acc2, _mm512_mul_ps(wv, _mm512_loadu_ps(lignes[2] + i)));
+        acc3 = _mm512_add_ps(acc3, _mm512_mul_ps(wv, _mm512_loadu_ps(lignes[3] + i)));
+    }
+    float v[4][16];
+    _mm512_storeu_ps(v[0], acc0);
+    _mm512_storeu_ps(v[1], acc1);
+    _mm512_storeu_ps(v[2], acc2);
+    _mm512_storeu_ps(v[3], acc3);
+    for (int r = 0; r < 4; r++) {
+        float somme = reduire16f(v[r]);
+        for (int k = i; k < n; k++) somme += w[k] * lignes[r][k];
+        sortie[r] = somme;
+    }
+}
+
+__attribute__((target("sse2")))
+static void produitScalaire4Int8SSE2(const int8_t *w, const int8_t *const lignes[4], int n, int32_t sortie[4]) {
+    __m128i acc[4];
+    for (int r = 0; r < 4; r++) acc[r] = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i vw = _mm_loadu_si128((const __m128i *)(w + i));
+        __m128i wBas = _mm_srai_epi16(_mm_unpacklo_epi8(vw, vw), 8);
+        __m128i wHaut = _mm_srai_epi16(_mm_unpackhi_epi8(vw, vw), 8);
+        for (int r = 0; r < 4; r++) {
+            __m128i vx = _mm_loadu_si128((const __m128i *)(lignes[r] + i));
+            __m128i xBas = _mm_srai_epi16(_mm_unpacklo_epi8(vx, vx), 8);
+            __m128i xHaut = _mm_srai_epi16(_mm_unpackhi_epi8(vx, vx), 8);
+            acc[r] = _mm_add_epi32(acc[r], _mm_madd_epi16(wBas, xBas));
+            acc[r] = _mm_add_epi32(acc[r], _mm_madd_epi16(wHaut, xHaut));
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        int32_t v[4];
+        _mm_storeu_si128((__m128i *)v, acc[r]);
+        sortie[r] = v[0] + v[1] + v[2] + v[3] + produitScalaireInt8Scalaire(w + i, lignes[r] + i, n - i);
+    }
+}
+
+__attribute__((target("avx2")))
+static void produitScalaire4Int8AVX2(const int8_t *w, const int8_t *const lignes[4], int n, int32_t sortie[4]) {
+    __m256i acc[4];
+    for (int r = 0; r < 4; r++) acc[r] = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i w0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(w + i)));
+        __m256i w1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(w + i + 16)));
+        for (int r = 0; r < 4; r++) {
+            __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(lignes[r] + i)));
+            __m256i x1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(lignes[r] + i + 16)));
+            acc[r] = _mm256_add_epi32(acc[r], _mm256_add_epi32(_mm256_madd_epi16(w0, x0), _mm256_madd_epi16(w1, x1)));
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        int32_t v[8];
+        _mm256_storeu_si256((__m256i *)v, acc[r]);
+        int32_t somme = 0;
+        for (int l = 0; l < 8; l++) somme += v[l];
+        sortie[r] = somme + produitScalaireInt8Scalaire(w + i, lignes[r] + i, n - i);
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void produitScalaire4Int8AVX512(const int8_t *w, const int8_t *const lignes[4], int n,
+                                       int32_t sortie[4]) {
+    __m512i acc[4];
+    for (int r = 0; r < 4; r++) acc[r] = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512i vw = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)(w + i)));
+        for (int r = 0; r < 4; r++) {
+            __m512i vx = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)(lignes[r] + i)));
+            acc[r] = _mm512_add_epi32(acc[r], _mm512_madd_epi16(vw, vx));
+        }
+    }
+    for (int r = 0; r < 4; r++) {
+        sortie[r] = _mm512_reduce_add_epi32(acc[r]) + produitScalaireInt8Scalaire(w + i, lignes[r] + i, n - i);
+    }
+}
+
+#endif
+
+// ==================== DISPATCH ====================
+
+FonctionProduit noyauProduitScalaire(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return produitScalaireScalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return produitScalaireSSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return produitScalaireAVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return produitScalaireAVX512;
+#endif
+    return NULL;
+}
+
+FonctionProduit4 noyauProduitScalaire4(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return produitScalaire4Scalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return produitScalaire4SSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return produitScalaire4AVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return produitScalaire4AVX512;
+#endif
+    return NULL;
+}
+
+FonctionLigneDecision noyauLigneDecision(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return ligneDecisionScalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return ligneDecisionSSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return ligneDecisionAVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return ligneDecisionAVX512;
+#endif
+    return NULL;
+}
+
+FonctionProduitFloat noyauProduitFloat(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return produitScalaireFloatScalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return produitScalaireFloatSSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return produitScalaireFloatAVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return produitScalaireFloatAVX512;
+#endif
+    return NULL;
+}
+
+// la variante avx512 demande avx512bw : sans lui on garde celle d'avx2.
+FonctionProduitInt8 noyauProduitInt8(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return produitScalaireInt8Scalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return produitScalaireInt8SSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return produitScalaireInt8AVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) {
+        return __builtin_cpu_supports("avx512bw") ? produitScalaireInt8AVX512 : produitScalaireInt8AVX2;
+    }
+#endif
+    return NULL;
+}
+
+FonctionProduit4Float noyauProduit4Float(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return produitScalaire4FloatScalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return produitScalaire4FloatSSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return produitScalaire4FloatAVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return produitScalaire4FloatAVX512;
+#endif
+    return NULL;
+}
+
+FonctionProduit4Int8 noyauProduit4Int8(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return produitScalaire4Int8Scalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return produitScalaire4Int8SSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return produitScalaire4Int8AVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) {
+        return __builtin_cpu_supports("avx512bw") ? produitScalaire4Int8AVX512 : produitScalaire4Int8AVX2;
+    }
+#endif
+    return NULL;
+}
+
+FonctionConversionFloat noyauConversionFloat(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return convertirFloatScalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return convertirFloatSSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return convertirFloatAVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return convertirFloatAVX512;
+#endif
+    return NULL;
+}
+
+FonctionQuantifier noyauQuantifierInt8(const char *nom) {
+    if (strcmp(nom, "scalaire") == 0) return quantifierInt8Scalaire;
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (strcmp(nom, "sse2") == 0 && __builtin_cpu_supports("sse2")) return quantifierInt8SSE2;
+    if (strcmp(nom, "avx2") == 0 && __builtin_cpu_supports("avx2")) return quantifierInt8AVX2;
+    if (strcmp(nom, "avx512") == 0 && __builtin_cpu_supports("avx512f")) return quantifierInt8AVX512;
+#endif
+    return NULL;
+}
+
+static const char *variantes[] = { "avx512", "avx2", "sse2", "scalaire" };
+#define NB_VARIANTES ((int)(sizeof(variantes) / sizeof(variantes[0])))
+
+// le produit double est choisi par classe de largeur : la classe c couvre [2^c, 2^(c+1)),
+// la derniere tout le reste. sur les petits vecteurs les registres larges coûtent plus
+// (mise en route, réduction de 8 voies) qu'ils ne rapportent.
+#define NB_CLASSES_LARGEUR 14
+
+static pthread_once_t choixFait = PTHREAD_ONCE_INIT;
+static const char *nomActif = NULL;
+static FonctionLigneDecision noyauLigneActif = NULL;
+static FonctionProduitFloat noyauFloatActif = NULL;
+static FonctionProduitInt8 noyauInt8Actif = NULL;
+static FonctionProduit4Float noyau4FloatActif = NULL;
+static FonctionProduit4Int8 noyau4Int8Actif = NULL;
+static FonctionConversionFloat conversionActive = NULL;
+static FonctionQuantifier quantifierActif = NULL;
+static int varianteParClasse[NB_CLASSES_LARGEUR];
+static FonctionProduit produitParClasse[NB_CLASSES_LARGEUR];
+static FonctionProduit4 produit4ParClasse[NB_CLASSES_LARGEUR];
+
+static int classeLargeur(int n) {
+    int c = n > 1 ? 31 - __builtin_clz((unsigned)n) : 0;
+    return c < NB_CLASSES_LARGEUR ? c : NB_CLASSES_LARGEUR - 1;
+}
+
+// meilleur de 3 mesures d'environ 2^15 multiplications.
+static double mesurerProduit(FonctionProduit f, const double *a, const double *b, int n) {
+    long iterations = (1L << 15) / n + 1;
+    double meilleur = 1e30;
+    for (int r = 0; r < 3; r++) {
+        volatile double puits = 0;
+        double t0 = maintenant();
+        for (long it = 0; it < iterations; it++) puits = puits + f(a, b, n);
+        double t = maintenant() - t0;
+        if (t < meilleur) meilleur = t;
+    }
+    return meilleur;
+}
+
+// la variante la plus large disponible sert de référence (nomNoyauActif, float, int8,
+// images). pour le produit double, chaque classe de largeur est mesurée au lancement
+// (quelques millisecondes) et garde la variante la plus rapide : toutes donnent le meme
+// résultat, le choix ne change que la vitesse.
+static void choisirNoyau(void) {
+    int disponibles[NB_VARIANTES], nbDisponibles = 0;
+    for (int k = 0; k < NB_VARIANTES; k++) {
+        if (noyauProduitScalaire(variantes[k])) disponibles[nbDisponibles++] = k;
+    }
+    int large = disponibles[0];
+    nomActif = variantes[large];
+    noyauLigneActif = noyauLigneDecision(nomActif);
+    noyauFloatActif = noyauProduitFloat(nomActif);
+    noyauInt8Actif = noyauProduitInt8(nomActif);
+    noyau4FloatActif = noyauProduit4Float(nomActif);
+    noyau4Int8Actif = noyauProduit4Int8(nomActif);
+    conversionActive = noyauConversionFloat(nomActif);
+    quantifierActif = noyauQuantifierInt8(nomActif);
+
+    // largeur représentative de la classe c : 2^c + 2^(c-1) (avec une queue non vide).
+    const int nMax = (1 << (NB_CLASSES_LARGEUR - 1)) + (1 << (NB_CLASSES_LARGEUR - 2));
+    double *a = malloc(sizeof(double) * (size_t)nMax);
+    double *b = malloc(sizeof(double) * (size_t)nMax);
+    for (int i = 0; a && b && i < nMax; i++) {
+        a[i] = (double)(i % 7) * 0.25 - 0.5;
+        b[i] = (double)(i % 5) * 0.5;
+    }
+    for (int c = 0; c < NB_CLASSES_LARGEUR; c++) {
+        int choix = large;
+        if (a && b && nbDisponibles > 1) {
+            int n = c == 0 ? 1 : (1 << c) + (1 << (c - 1));
+            double meilleur = 1e30;
+            for (int v = 0; v < nbDisponibles; v++) {
+                double t = mesurerProduit(noyauProduitScalaire(variantes[disponibles[v]]), a, b, n);
+                if (t < meilleur) {
+                    meilleur = t;
+                    choix = disponibles[v];
+                }
+            }
+        }
+        varianteParClasse[c] = choix;
+        produitParClasse[c] = noyauProduitScalaire(variantes[choix]);
+        produit4ParClasse[c] = noyauProduitScalaire4(variantes[choix]);
+    }
+    free(a);
+    free(b);
+}
+
+double produitScalaire(const double *a, const double *b, int n) {
+    pthread_once(&choixFait, choisirNoyau);
+    return produitParClasse[classeLargeur(n)](a, b, n);
+}
+
+void produitScalaire4(const double *w, const double *const lignes[4], int n, double sortie[4]) {
+    pthread_once(&choixFait, choisirNoyau);
+    produit4ParClasse[classeLargeur(n)](w, lignes, n, sortie);
+}
+
+void ligneDecision(const double *xs, int n, const double *a, const double *b, int nbExperts, int *labels,
+                   double *scores) {
+    pthread_once(&choixFait, choisirNoyau);
+    noyauLigneActif(xs, n, a, b, nbExperts, labels, scores);
+}
+
+float produitScalaireFloat(const float *a, const float *b, int n) {
+    pthread_once(&choixFait, choisirNoyau);
+    return noyauFloatActif(a, b, n);
+}
+
+// par tranches de TRANCHE_INT8 : meme la variante scalaire (un seul acumulateur 32 bits,
+// 127 * 127 par produit) ne peut pas y déborder.
+int64_t produitScalaireInt8(const int8_t *a, const int8_t *b, int n) {
+    pthread_once(&choixFait, choisirNoyau);
+    int64_t somme = 0;
+    for (int i = 0; i < n; i += TRANCHE_INT8) {
+        int taille = n - i < TRANCHE_INT8 ? n - i : TRANCHE_INT8;
+        somme += noyauInt8Actif(a + i, b + i, taille);
+    }
+    return somme;
+}
+
+FonctionProduit4Float choisirProduit4Float(void) {
+    pthread_once(&choixFait, choisirNoyau);
+    return noyau4FloatActif;
+}
+
+FonctionProduit4Int8 choisirProduit4Int8(void) {
+    pthread_once(&choixFait, choisirNoyau);
+    return noyau4Int8Actif;
+}
+
+FonctionConversionFloat choisirConversionFloat(void) {
+    pthread_once(&choixFait, choisirNoyau);
+    return conversionActive;
+}
+
+FonctionQuantifier choisirQuantifierInt8(void) {
+    pthread_once(&choixFait, choisirNoyau);
+    return quantifierActif;
+}
+
+const char *nomNoyauActif(void) {
+    pthread_once(&choixFait, choisirNoyau);
+    return nomActif;
+}
+
+const char *nomNoyauPourLargeur(int n) {
+    pthread_once(&choixFait, choisirNoyau);
+    return variantes[varianteParClasse[classeLargeur(n)]];
+}
+
+// ==================== LARGEURS FIXES ====================
+// chaque variante apelée avec n constant : le compilateur la recopie pour cette largeur et
+// déroule tout (plus de boucle ni de queue). le calcul reste celui de la variante, donc le
+// résultat est identique au bit près à produitScalaire.
+// sous 8 colones il n'y a aucun bloc de 8 : l'ordre commun se réduit à une somme
+// séquentielle depuis 0, écrite en scalaire (un registre large ne servirait qu'à la réduction).
+
+static EN_LIGNE double sommeCourte2(const double *a, const double *b) {
+    double s = 0;
+    s += a[0] * b[0];
+    s += a[1] * b[1];
+    return s;
+}
+
+static EN_LIGNE double sommeCourte4(const double *a, const double *b) {
+    double s = 0;
+    s += a[0] * b[0];
+    s += a[1] * b[1];
+    s += a[2] * b[2];
+    s += a[3] * b[3];
+    return s;
+}
+
+// une largeur courte, commune à toutes les variantes.
+#define COURTE_LARGEUR(N)                                                                   \
+    static double produitCourt##N(const double *a, const double *b, int n) {                \
+        (void)n;                                                                            \
+        return sommeCourte##N(a, b);                                                        \
+    }                                                                                       \
+    static void produit4Court##N(const double *w, const double *const l[4], int n, double s[4]) { \
+        (void)n;                                                                            \
+        for (int r = 0; r < 4; r++) s[r] = sommeCourte##N(w, l[r]);                         \
+    }                                                                                       \
+    static void scoresCourts2x##N(const double *const w[], const double *x, double *s) {    \
+        for (int k = 0; k < 2; k++) s[k] = sommeCourte##N(w[k], x);                         \
+    }                                                                                       \
+    static void scoresCourts3x##N(const double *const w[], const double *x, double *s) {    \
+        for (int k = 0; k < 3; k++) s[k] = sommeCourte##N(w[k], x);                         \
+    }                                                                                       \
+    static void scoresCourts4x##N(const double *const w[], const double *x, double *s) {    \
+        for (int k = 0; k < 4; k++) s[k] = sommeCourte##N(w[k], x);                         \
+    }
+
+COURTE_LARGEUR(2)
+COURTE_LARGEUR(4)
+
+// une largeur pour une variante : le produit seul, 4 lignes face aux memes poids, puis
+// K experts one-vs-all sur une meme ligne (la ligne est lue une fois et les K produits
+// sont déroulés ensemble).
+#define FIXES_LARGEUR(N, S, CIBLE)                                                          \
+    CIBLE static double produitFixe##N##S(const double *a, const double *b, int n) {        \
+        (void)n;                                                                            \
+        return produitScalaire##S(a, b, N);                                                 \
+    }                                                                                       \
+    CIBLE static void produit4Fixe##N##S(const double *w, const double *const l[4], int n, double s[4]) { \
+        (void)n;                                                                            \
+        produitScalaire4##S(w, l, N, s);                                                    \
+    }                                                                                       \
+    CIBLE static void scoresFixes2x##N##S(const double *const w[], const double *x, double *s) { \
+        for (int k = 0; k < 2; k++) s[k] = produitScalaire##S(w[k], x, N);                  \
+    }                                                                                       \
+    CIBLE static void scoresFixes3x##N##S(const double *const w[], const double *x, double *s) { \
+        for (int k = 0; k < 3; k++) s[k] = produitScalaire##S(w[k], x, N);                  \
+    }                                                                                       \
+    CIBLE static void scoresFixes4x##N##S(const double *const w[], const double *x, double *s) { \
+        for (int k = 0; k < 4; k++) s[k] = produitScalaire##S(w[k], x, N);                  \
+    }
+
+// 8 et 16 colones pour une variante, et les tables de toutes les largeurs
+// (colone = largeur 2, 4, 8, 16).
+#define FIXES_CIBLE(S, CIBLE)                                                               \
+    FIXES_LARGEUR(8, S, CIBLE)                                                              \
+    FIXES_LARGEUR(16, S, CIBLE)                                                             \
+    static const FonctionProduit produitsFixes##S[4] = {                                    \
+        produitCourt2, produitCourt4, produitFixe8##S, produitFixe16##S                     \
+    };                                                                                      \
+    static const FonctionProduit4 produits4Fixes##S[4] = {                                  \
+        produit4Court2, produit4Court4, produit4Fixe8##S, produit4Fixe16##S                 \
+    };                                                                                      \
+    static const FonctionScoresFixes scoresFixes##S[3][4] = {                               \
+        { scoresCourts2x2, scoresCourts2x4, scoresFixes2x8##S, scoresFixes2x16##S },        \
+        { scoresCourts3x2, scoresCourts3x4, scoresFixes3x8##S, scoresFixes3x16##S },        \
+        { scoresCourts4x2, scoresCourts4x4, scoresFixes4x8##S, scoresFixes4x16##S },        \
+    };
+
+FIXES_CIBLE(Scalaire, )
+#ifdef NOYAU_X86
+FIXES_CIBLE(SSE2, __attribute__((target("sse2"))))
+FIXES_CIBLE(AVX2, __attribute__((target("avx2"))))
+FIXES_CIBLE(AVX512, __attribute__((target("avx512f"))))
+#endif
+
+// colone des tables pour une largeur, -1 si elle n'a pas de version déroulée.
+static int colonneFixe(int n) {
+    return n == 2 ? 0 : n == 4 ? 1 : n == 8 ? 2 : n == 16 ? 3 : -1;
+}
+
+// tables de la cible retenue par choisirNoyau.
+static const FonctionProduit *produitsFixesActifs(void) {
+    pthread_once(&choixFait, choisirNoyau);
+#ifdef NOYAU_X86
+    if (strcmp(nomActif, "avx512") == 0) return produitsFixesAVX512;
+    if (strcmp(nomActif, "avx2") == 0) return produitsFixesAVX2;
+    if (strcmp(nomActif, "sse2") == 0) return produitsFixesSSE2;
+#endif
+    return produitsFixesScalaire;
+}
+
+static const FonctionProduit4 *produits4FixesActifs(void) {
+    pthread_once(&choixFait, choisirNoyau);
+#ifdef NOYAU_X86
+    if (strcmp(nomActif, "avx512") == 0) return produits4FixesAVX512;
+    if (strcmp(nomActif, "avx2") == 0) return produits4FixesAVX2;
+    if (strcmp(nomActif, "sse2") == 0) return produits4FixesSSE2;
+#endif
+    return produits4FixesScalaire;
+}
+
+static const FonctionScoresFixes (*scoresFixesActifs(void))[4] {
+    pthread_once(&choixFait, choisirNoyau);
+#ifdef NOYAU_X86
+    if (strcmp(nomActif, "avx512") == 0) return scoresFixesAVX512;
+    if (strcmp(nomActif, "avx2") == 0) return scoresFixesAVX2;
+    if (strcmp(nomActif, "sse2") == 0) return scoresFixesSSE2;
+#endif
+    return scoresFixesScalaire;
+}
+
+FonctionProduit noyauProduitFixe(int n) {
+    int colonne = colonneFixe(n);
+    return colonne < 0 ? NULL : produitsFixesActifs()[colonne];
+}
+
+FonctionProduit4 noyauProduit4Fixe(int n) {
+    int colonne = colonneFixe(n);
+    return colonne < 0 ? NULL : produits4FixesActifs()[colonne];
+}
+
+FonctionProduit choisirProduit(int n) {
+    FonctionProduit f = noyauProduitFixe(n);
+    if (f) return f;
+    pthread_once(&choixFait, choisirNoyau);
+    return produitParClasse[classeLargeur(n)];
+}
+
+FonctionProduit4 choisirProduit4(int n) {
+    FonctionProduit4 f = noyauProduit4Fixe(n);
+    if (f) return f;
+    pthread_once(&choixFait, choisirNoyau);
+    return produit4ParClasse[classeLargeur(n)];
+}
+
+FonctionScoresFixes noyauScoresFixes(int nbExperts, int n) {
+    int colonne = colonneFixe(n);
+    if (nbExperts < 2 || nbExperts > 4 || colonne < 0) return NULL;
+    return scoresFixesActifs()[nbExperts - 2][colonne];
+}
+
+// ==================== LIGNES CREUSES ====================
+// pas de dispatch : le coût est dominé par les acès dispersés à w, pas par les calculs.
+// 4 acumulateurs indépendants pour ne pas attendre chaque addition.
+
+double produitScalaireCreux(const double *w, const int *colonnes, const double *valeurs, int nnz) {
+    double acc[4] = {0, 0, 0, 0};
+    int i = 0;
+    for (; i + 4 <= nnz; i += 4) {
+        for (int l = 0; l < 4; l++) acc[l] += w[colonnes[i + l]] * valeurs[i + l];
+    }
+    double somme = (acc[0] + acc[2]) + (acc[1] + acc[3]);
+    for (; i < nnz; i++) somme += w[colonnes[i]] * valeurs[i];
+    return somme;
+}
+
+void ajouterCreux(double *w, double facteur, const int *colonnes, const double *valeurs, int nnz) {
+    for (int i = 0; i < nnz; i++) w[colonnes[i]] += facteur * valeurs[i];
+}
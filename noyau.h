@@ -0,0 +1,95 @@
+#ifndef NOYAU_H_
+#define NOYAU_H_
+
+#include <stdint.h>
+
+// signature commune à toutes les variantes du produit scalaire.
+typedef double (*FonctionProduit)(const double *a, const double *b, int n);
+
+// produit scalaire du meme vecteur w avec 4 lignes à la fois : w n'est chargé
+// qu'une fois par bloc. chaque sortie[r] est identique à produitScalaire(w, lignes[r], n).
+typedef void (*FonctionProduit4)(const double *w, const double *const lignes[4], int n, double sortie[4]);
+
+// produit scalaire a.b sur n doubles, variante choisie une seule fois selon le cpu et la
+// largeur (voir nomNoyauPourLargeur).
+// toutes les variantes (scalaire, sse2, avx2, avx512) donnent exactement le meme
+// résultat au bit près : elles acumulent sur 8 voies puis réduisent dans le meme ordre.
+double produitScalaire(const double *a, const double *b, int n);
+
+void produitScalaire4(const double *w, const double *const lignes[4], int n, double sortie[4]);
+
+// une ligne de pixels d'une image de décision : le score de l'expert k au pixel p vaut
+// a[k] + b[k] * xs[p] (projection affine). avec un seul expert, label = score >= 0 ;
+// sinon label = premier k au score maximal et score = ce maximum.
+typedef void (*FonctionLigneDecision)(const double *xs, int n, const double *a, const double *b, int nbExperts,
+                                      int *labels, double *scores);
+
+void ligneDecision(const double *xs, int n, const double *a, const double *b, int nbExperts, int *labels,
+                   double *scores);
+
+// ligne creuse (nnz valeurs non nulles aux colones données) face à un vecteur dense w :
+// produit scalaire, et w[colonnes[i]] += facteur * valeurs[i]. coût en O(nnz).
+double produitScalaireCreux(const double *w, const int *colonnes, const double *valeurs, int nnz);
+void ajouterCreux(double *w, double facteur, const int *colonnes, const double *valeurs, int nnz);
+
+// inférence compacte : meme produit scalaire en float (16 voies, toutes les variantes
+// identiques au bit près entre elles) et en int8 (somme entiere exacte, valeurs dans
+// [-127, 127]).
+typedef float (*FonctionProduitFloat)(const float *a, const float *b, int n);
+typedef int32_t (*FonctionProduitInt8)(const int8_t *a, const int8_t *b, int n);
+
+float produitScalaireFloat(const float *a, const float *b, int n);
+int64_t produitScalaireInt8(const int8_t *a, const int8_t *b, int n);
+
+// 4 lignes face aux memes poids, chaque sortie[r] identique à la version une ligne. pour
+// l'int8, n ne dépasse pas TRANCHE_INT8 (l'apelant découpe, voir produitScalaireInt8).
+// la variante active est à résoudre une fois par apel de prédiction, pas à chaque ligne.
+#define TRANCHE_INT8 (1 << 16)
+typedef void (*FonctionProduit4Float)(const float *w, const float *const lignes[4], int n, float sortie[4]);
+typedef void (*FonctionProduit4Int8)(const int8_t *w, const int8_t *const lignes[4], int n, int32_t sortie[4]);
+
+FonctionProduit4Float choisirProduit4Float(void);
+FonctionProduit4Int8 choisirProduit4Int8(void);
+
+// conversion d'une ligne en float, et sa quantification int8 (voir quantifierInt8 dans
+// precision.h) : memes valeurs et meme échelle pour toutes les variantes.
+typedef void (*FonctionConversionFloat)(const double *x, int n, float *f);
+typedef float (*FonctionQuantifier)(const double *x, int n, int8_t *q);
+FonctionConversionFloat choisirConversionFloat(void);
+FonctionQuantifier choisirQuantifierInt8(void);
+
+// largeurs fixes (2, 4, 8 et 16 colones) : fonctions générées pour chaque largeur, sans
+// boucle, au résultat identique à produitScalaire. noyauProduitFixe retourne NULL pour une
+// autre largeur ; choisirProduit retombe alors sur la variante simd active. à apeler une
+// fois (création ou chargement d'un perceptron), pas à chaque ligne.
+// sous 8 colones les versions déroulées sont scalaires pour toutes les variantes.
+FonctionProduit noyauProduitFixe(int n);
+FonctionProduit choisirProduit(int n);
+// pareil pour 4 lignes face aux memes poids (produitScalaire4) : à résoudre une fois par apel
+// de prédiction.
+FonctionProduit4 noyauProduit4Fixe(int n);
+FonctionProduit4 choisirProduit4(int n);
+
+// scores[k] = produitScalaire(poids[k], ligne, n) pour nbExperts experts à la fois, pour
+// 2 à 4 experts de 2, 4, 8 ou 16 colones (NULL sinon).
+typedef void (*FonctionScoresFixes)(const double *const poids[], const double *ligne, double *scores);
+FonctionScoresFixes noyauScoresFixes(int nbExperts, int n);
+
+// nom de la variante la plus large disponible ("scalaire", "sse2", "avx2", "avx512").
+const char *nomNoyauActif(void);
+// variante retenue pour le produit double à n colones (mesurée au lancement par classe de
+// largeur : les petits vecteurs vont souvent plus vite sans les registres larges).
+const char *nomNoyauPourLargeur(int n);
+
+// retourne une variante précise, ou NULL si le cpu ne la supporte pas.
+FonctionProduit noyauProduitScalaire(const char *nom);
+FonctionProduit4 noyauProduitScalaire4(const char *nom);
+FonctionLigneDecision noyauLigneDecision(const char *nom);
+FonctionProduitFloat noyauProduitFloat(const char *nom);
+FonctionProduitInt8 noyauProduitInt8(const char *nom);
+FonctionProduit4Float noyauProduit4Float(const char *nom);
+FonctionProduit4Int8 noyauProduit4Int8(const char *nom);
+FonctionConversionFloat noyauConversionFloat(const char *nom);
+FonctionQuantifier noyauQuantifierInt8(const char *nom);
+
+#endif
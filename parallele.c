@@ -0,0 +1,163 @@
+#include "parallele.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static int nbThreadsChoisi = 0;
+
+double maintenant(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// nombre de coeurs en ligne, ou la valeur imposée par definirNbThreadsParDefaut.
+int nbThreadsParDefaut(void) {
+    if (nbThreadsChoisi > 0) return nbThreadsChoisi;
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+void definirNbThreadsParDefaut(int nbThreads) {
+    nbThreadsChoisi = nbThreads > 0 ? nbThreads : 0;
+}
+
+typedef struct {
+    TacheIntervalle tache;
+    void *ctx;
+    int debut;
+    int fin;
+} Morceau;
+
+static void *lancerMorceau(void *arg) {
+    Morceau *m = arg;
+    m->tache(m->ctx, m->debut, m->fin);
+    return NULL;
+}
+
+void executerParallele(int nbThreads, int n, int seuil, TacheIntervalle tache, void *ctx) {
+    if (n <= 0) return;
+    if (nbThreads <= 0) nbThreads = nbThreadsParDefaut();
+    if (nbThreads > n) nbThreads = n;
+    if (nbThreads == 1 || n < seuil) {
+        tache(ctx, 0, n);
+        return;
+    }
+    Morceau *morceaux = malloc(sizeof(Morceau) * (size_t)nbThreads);
+    pthread_t *threads = malloc(sizeof(pthread_t) * (size_t)nbThreads);
+    int *lance = calloc((size_t)nbThreads, sizeof(int));
+    if (!morceaux || !threads || !lance) { perror("malloc"); exit(EXIT_FAILURE); }
+    for (int t = 0; t < nbThreads; t++) {
+        morceaux[t].tache = tache;
+        morceaux[t].ctx = ctx;
+        morceaux[t].debut = (int)((long)n * t / nbThreads);
+        morceaux[t].fin = (int)((long)n * (t + 1) / nbThreads);
+    }
+    // le thread apelant traite lui meme le premier morceau.
+    for (int t = 1; t < nbThreads; t++) {
+        lance[t] = pthread_create(&threads[t], NULL, lancerMorceau, &morceaux[t]) == 0;
+        if (!lance[t]) lancerMorceau(&morceaux[t]);
+    }
+    lancerMorceau(&morceaux[0]);
+    for (int t = 1; t < nbThreads; t++) {
+        if (lance[t]) pthread_join(threads[t], NULL);
+    }
+    free(lance);
+    free(threads);
+    free(morceaux);
+}
+
+// ==================== POOL DE THREADS ====================
+
+struct PoolThreads {
+    pthread_t *threads;
+    int nbThreads;
+    pthread_mutex_t verrou;
+    pthread_cond_t travailDispo;
+    pthread_cond_t lotFini;
+    // lot en cours
+    TacheIntervalle tache;
+    void *ctx;
+    int nbTaches;
+    int prochaine;
+    int enCours;
+    int arret;
+};
+
+// boucle d'un worker : prend la prochaine tache du lot tant qu'il en reste.
+static void *boucleWorker(void *arg) {
+    PoolThreads *pool = arg;
+    pthread_mutex_lock(&pool->verrou);
+    for (;;) {
+        while (!pool->arret && pool->prochaine >= pool->nbTaches) {
+            pthread_cond_wait(&pool->travailDispo, &pool->verrou);
+        }
+        if (pool->arret) break;
+        while (pool->prochaine < pool->nbTaches) {
+            int i = pool->prochaine++;
+            pool->enCours++;
+            pthread_mutex_unlock(&pool->verrou);
+            pool->tache(pool->ctx, i, i + 1);
+            pthread_mutex_lock(&pool->verrou);
+            pool->enCours--;
+        }
+        if (pool->enCours == 0) pthread_cond_signal(&pool->lotFini);
+    }
+    pthread_mutex_unlock(&pool->verrou);
+    return NULL;
+}
+
+PoolThreads *creerPool(int nbThreads) {
+    if (nbThreads <= 0) nbThreads = nbThreadsParDefaut();
+    PoolThreads *pool = calloc(1, sizeof(PoolThreads));
+    if (!pool) { perror("calloc"); exit(EXIT_FAILURE); }
+    pool->threads = malloc(sizeof(pthread_t) * (size_t)nbThreads);
+    if (!pool->threads) { perror("malloc"); exit(EXIT_FAILURE); }
+    pthread_mutex_init(&pool->verrou, NULL);
+    pthread_cond_init(&pool->travailDispo, NULL);
+    pthread_cond_init(&pool->lotFini, NULL);
+    for (int t = 0; t < nbThreads; t++) {
+        if (pthread_create(&pool->threads[t], NULL, boucleWorker, pool) != 0) break;
+        pool->nbThreads++;
+    }
+    if (pool->nbThreads == 0) {
+        printf("Erreur : impossible de creer les threads du pool\n");
+        exit(EXIT_FAILURE);
+    }
+    return pool;
+}
+
+int taillePool(const PoolThreads *pool) {
+    return pool->nbThreads;
+}
+
+void poolExecuter(PoolThreads *pool, int nbTaches, TacheIntervalle tache, void *ctx) {
+    if (nbTaches <= 0) return;
+    pthread_mutex_lock(&pool->verrou);
+    pool->tache = tache;
+    pool->ctx = ctx;
+    pool->nbTaches = nbTaches;
+    pool->prochaine = 0;
+    pool->enCours = 0;
+    pthread_cond_broadcast(&pool->travailDispo);
+    while (pool->prochaine < pool->nbTaches || pool->enCours > 0) {
+        pthread_cond_wait(&pool->lotFini, &pool->verrou);
+    }
+    pthread_mutex_unlock(&pool->verrou);
+}
+
+void detruirePool(PoolThreads *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->verrou);
+    pool->arret = 1;
+    pthread_cond_broadcast(&pool->travailDispo);
+    pthread_mutex_unlock(&pool->verrou);
+    for (int t = 0; t < pool->nbThreads; t++) pthread_join(pool->threads[t], NULL);
+    pthread_mutex_destroy(&pool->verrou);
+    pthread_cond_destroy(&pool->travailDispo);
+    pthread_cond_destroy(&pool->lotFini);
+    free(pool->threads);
+    free(pool);
+}
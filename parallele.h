@@ -0,0 +1,28 @@
+#ifndef PARALLELE_H_
+#define PARALLELE_H_
+
+// horloge monotone, en secondes (mesures de durée).
+double maintenant(void);
+
+// travail à faire sur l'intervalle [debut, fin) avec un contexte partagé.
+typedef void (*TacheIntervalle)(void *ctx, int debut, int fin);
+
+// nombre de threads utilisé quand on passe 0 (par défaut : nombre de coeurs).
+int nbThreadsParDefaut(void);
+void definirNbThreadsParDefaut(int nbThreads);
+
+// découpe [0, n) en nbThreads morceaux contigus et les traite en parallèle.
+// en dessous de seuil éléments, ou avec un seul thread, tout est fait sur le thread apelant.
+void executerParallele(int nbThreads, int n, int seuil, TacheIntervalle tache, void *ctx);
+
+// pool de threads persistants : les workers attendent des lots de taches
+// et se servent dans une file commune (une tache = un indice de 0 à nbTaches-1).
+typedef struct PoolThreads PoolThreads;
+
+PoolThreads *creerPool(int nbThreads);
+int taillePool(const PoolThreads *pool);
+// apelle tache(ctx, i, i + 1) pour chaque i de [0, nbTaches) et attend la fin du lot.
+void poolExecuter(PoolThreads *pool, int nbTaches, TacheIntervalle tache, void *ctx);
+void detruirePool(PoolThreads *pool);
+
+#endif
@@ -4,9 +4,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "perceptron.h"
+#include "noyau.h"
+#include "parallele.h"
+#include "precision.h"
+#include "binaire.h"
 #include "math.h"
 #include <string.h>
+#include <stddef.h>
 #include <dirent.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // fonction de seuil (heaviside) retournant 1 si la somme est positive, sinon 0.
 // utilisé pour la clasification binaire clasique.
@@ -29,7 +39,13 @@ Perceptron* createPerceptron(int n, int epoch) {
     newPerceptron->epoque = epoch;
     newPerceptron->accuracy = 0;
     newPerceptron->pasApprentissage = 0.001;
+    newPerceptron->tailleBatch = 0;
+    newPerceptron->nbThreads = 1;
+    newPerceptron->modeApprentissage = MODE_CLASSIQUE;
+    newPerceptron->poidsExternes = 0;
     newPerceptron->nPoids = n;
+    newPerceptron->produit = choisirProduit(n);
+    newPerceptron->poids = NULL;
     if (n != 0) {
         newPerceptron->poids = malloc(n * sizeof(double));
         for (int i = 0; i < n ; i++) {
@@ -41,15 +57,10 @@ Perceptron* createPerceptron(int n, int epoch) {
 
 // réalise une clasification binaire (0 ou 1) pour une entrée donnée.
 // calcule la somme pondérée des entrées et aplique la fonction de seuil.
+// apelé pour chaque ligne de l'entrainement : aucun test ici, le perceptron vient de
+// createPerceptron ou d'un chargement, qui ont choisi p->produit pour sa largeur.
 int predire(Perceptron *p, const double *entree) {
-    if (p == NULL || entree == NULL || p->poids == NULL) {
-        printf("Erreur fatale : pointeur NULL dans predire\n");
-        exit(1);
-    }
-    double somme = 0;
-    for (int i = 0 ; i < p->nPoids; i++) {
-        somme = somme + p->poids[i] * entree[i];
-    }
+    double somme = p->produit(p->poids, entree, p->nPoids);
     somme += p->biais;
     const int final = fonctionActivation(somme);
     return final;
@@ -58,92 +69,961 @@ int predire(Perceptron *p, const double *entree) {
 // retourne un score de confiance (0.0 à 1.0) pour une entrée donnée.
 // utilise la fonction d'activation sigmoïde au lieu du seuil brutale.
 double predireProba(Perceptron *p, const double *entree) {
-    if (p == NULL || entree == NULL || p->poids == NULL) {
-        printf("Erreur fatale : pointeur NULL dans predire\n");
-        exit(1);
-    }
-    double somme = 0;
-    for (int i = 0 ; i < p->nPoids; i++) {
-        somme = somme + p->poids[i] * entree[i];
-    }
+    double somme = p->produit(p->poids, entree, p->nPoids);
     somme += p->biais;
     const double final = fonctionActivationMultiClass(somme);
     return final;
 }
 
+// meme chose que predire pour une ligne creuse, en O(nnz).
+int predireCreux(const Perceptron *p, const int *colonnes, const double *valeurs, int nnz) {
+    return fonctionActivation(produitScalaireCreux(p->poids, colonnes, valeurs, nnz) + p->biais);
+}
+
+// ==================== SUIVI DE LA CONVERGENCE ====================
+
+// état d'un entrainement suivi. sans suivi, toutes les lignes du train servent à apprendre
+// et seuls le nombre d'époques et la convergence arretent la boucle.
+typedef struct {
+    SuiviEntrainement *s;
+    int nApprentissage;        // lignes du train utilisées pour apprendre (les premieres)
+    int nValidation;           // lignes suivantes, gardées pour la validation
+    const int *indexValidation;
+    int *predictions;
+    double debut;
+    int sansAmelioration;
+    // poids puis biais de chaque expert à la meilleure époque (validation seulement).
+    double *meilleursPoids;
+} Controle;
+
+static void demarrerControle(Controle *c, SuiviEntrainement *s, const DataSet *ds, int nbExperts, int d) {
+    memset(c, 0, sizeof(*c));
+    c->s = s;
+    c->nApprentissage = ds->nTrain;
+    if (s == NULL) return;
+    reinitialiserSuivi(s);
+    c->debut = maintenant();
+    if (s->partValidation > 0 && ds->nTrain > 1) {
+        c->nValidation = (int)(s->partValidation * ds->nTrain);
+        if (c->nValidation > ds->nTrain - 1) c->nValidation = ds->nTrain - 1;
+    }
+    if (c->nValidation > 0) {
+        c->nApprentissage = ds->nTrain - c->nValidation;
+        c->indexValidation = ds->indexSplit + c->nApprentissage;
+        c->predictions = malloc(sizeof(int) * (size_t)c->nValidation);
+        c->meilleursPoids = malloc(sizeof(double) * (size_t)nbExperts * (d + 1));
+    }
+    s->nValidation = c->nValidation;
+}
+
+// lignes de validation mal classées. un seul expert : classe cible (ou label si
+// classeCible < 0), sinon la classe de l'ensemble one-vs-all.
+static int erreursValidation(const Controle *c, Perceptron **experts, int nbExperts, int classeCible,
+                             const DataSet *ds) {
+    predireDataSet(experts, nbExperts, ds, c->indexValidation, c->nValidation, c->predictions);
+    int erreurs = 0;
+    for (int i = 0; i < c->nValidation; i++) {
+        int label = ds->etiquettes[c->indexValidation[i]];
+        if (nbExperts == 1 && classeCible >= 0) label = (label == classeCible);
+        if (c->predictions[i] != label) erreurs++;
+    }
+    return erreurs;
+}
+
+// enregistre l'époque qui vient de finir et décide si l'entrainement s'arrete.
+// les poids des experts doivent etre à jour (la validation les utilise).
+static int controlerEpoque(Controle *c, Perceptron **experts, int nbExperts, int classeCible, const DataSet *ds,
+                           int erreursTrain) {
+    SuiviEntrainement *s = c->s;
+    if (s == NULL) return erreursTrain == 0;
+    int erreursVal = c->nValidation > 0 ? erreursValidation(c, experts, nbExperts, classeCible, ds) : -1;
+    int epoque = s->nbEpoques;
+    enregistrerEpoque(s, erreursTrain, erreursVal);
+
+    int mesure = c->nValidation > 0 ? erreursVal : erreursTrain;
+    if (s->meilleureEpoque < 0 || mesure < s->meilleuresErreurs) {
+        s->meilleureEpoque = epoque;
+        s->meilleuresErreurs = mesure;
+        c->sansAmelioration = 0;
+        if (c->meilleursPoids) {
+            int d = experts[0]->nPoids;
+            for (int k = 0; k < nbExperts; k++) {
+                double *copie = c->meilleursPoids + (size_t)k * (d + 1);
+                memcpy(copie, experts[k]->poids, sizeof(double) * (size_t)d);
+                copie[d] = experts[k]->biais;
+            }
+        }
+    } else {
+        c->sansAmelioration++;
+    }
+
+    if (erreursTrain == 0) {
+        // le train est séparé : on garde ces poids, meme si une époque antérieure faisait
+        // aussi bien en validation.
+        s->meilleureEpoque = epoque;
+        s->meilleuresErreurs = mesure;
+        s->raisonArret = ARRET_CONVERGE;
+    } else if (s->patience > 0 && c->sansAmelioration >= s->patience) s->raisonArret = ARRET_PATIENCE;
+    else if (s->budgetSecondes > 0 && maintenant() - c->debut >= s->budgetSecondes) s->raisonArret = ARRET_BUDGET;
+    else return 0;
+    return 1;
+}
+
+// fin de l'entrainement : avec une validation, on remet les poids de la meilleure époque,
+// sauf si l'entrainement a convergé (les poids courants sont alors ceux retenus).
+static void terminerControle(Controle *c, Perceptron **experts, int nbExperts) {
+    if (c->s == NULL) return;
+    if (c->meilleursPoids && c->s->meilleureEpoque >= 0 && c->s->raisonArret != ARRET_CONVERGE) {
+        int d = experts[0]->nPoids;
+        for (int k = 0; k < nbExperts; k++) {
+            const double *copie = c->meilleursPoids + (size_t)k * (d + 1);
+            memcpy(experts[k]->poids, copie, sizeof(double) * (size_t)d);
+            experts[k]->biais = copie[d];
+        }
+    }
+    c->s->duree = maintenant() - c->debut;
+    free(c->predictions);
+    free(c->meilleursPoids);
+}
+
+// ==================== MODES POCKET ET MOYENNE ====================
+
+// état d'un perceptron en mode pocket ou moyenne, le temps d'un entrainement.
+// les deux se tiennent à jour sans passe suplémentaire sur les données :
+// - pocket garde les poids qui ont enchainé la plus longue série de bonnes prédictions.
+//   la copie n'a lieu qu'à une erreur qui termine une série record.
+// - moyenne suit la moyenne des poids sur tous les exemples vus sans la recalculer à
+//   chaque exemple : chaque mise à jour est aussi cumulée multipliée par sa date
+//   (compteur), et la moyenne vaut w - cumul / compteur. le coût reste O(d) par mise à jour
+//   et O(1) par exemple bien classé.
+typedef struct {
+    int mode;
+    int d;
+    // poids courants, ceux que l'apprentissage modifie (d'un perceptron ou d'une matrice).
+    double *w;
+    double *biais;
+    double compteur;
+    double *cumul;           // moyenne : d poids puis le biais
+    long serie;
+    long meilleureSerie;
+    double *poche;           // pocket : d poids puis le biais
+    double *courant;         // copie des poids courants pendant une validation
+} EtatMode;
+
+static void preparerMode(EtatMode *m, int mode, double *w, double *biais, int d) {
+    memset(m, 0, sizeof(*m));
+    m->mode = mode;
+    m->d = d;
+    m->w = w;
+    m->biais = biais;
+    if (mode == MODE_CLASSIQUE) return;
+    double *tampon = malloc(sizeof(double) * 2 * (size_t)(d + 1));
+    m->courant = tampon + d + 1;
+    m->compteur = 1;
+    if (mode == MODE_MOYENNE) {
+        m->cumul = tampon;
+        memset(m->cumul, 0, sizeof(double) * (size_t)(d + 1));
+    } else {
+        m->poche = tampon;
+        memcpy(m->poche, w, sizeof(double) * (size_t)d);
+        m->poche[d] = *biais;
+    }
+}
+
+// une erreur va modifier les poids : si la série qui se termine est la meilleure,
+// les poids qui l'ont faite partent dans la poche.
+static inline void fermerSerie(EtatMode *m) {
+    if (m->mode == MODE_POCKET && m->serie > m->meilleureSerie) {
+        memcpy(m->poche, m->w, sizeof(double) * (size_t)m->d);
+        m->poche[m->d] = *m->biais;
+        m->meilleureSerie = m->serie;
+    }
+    m->serie = 0;
+}
+
+// la mise à jour facteur * x (et facteurBiais sur le biais) est cumulée à sa date.
+static inline void cumulerMoyenne(EtatMode *m, double facteur, const double *x, double facteurBiais) {
+    if (m->mode != MODE_MOYENNE) return;
+    double f = m->compteur * facteur;
+    for (int z = 0; z < m->d; z++) m->cumul[z] += f * x[z];
+    m->cumul[m->d] += m->compteur * facteurBiais;
+}
+
+static inline void cumulerMoyenneCreuse(EtatMode *m, double facteur, const int *colonnes, const double *valeurs,
+                                        int nnz, double facteurBiais) {
+    if (m->mode != MODE_MOYENNE) return;
+    ajouterCreux(m->cumul, m->compteur * facteur, colonnes, valeurs, nnz);
+    m->cumul[m->d] += m->compteur * facteurBiais;
+}
+
+// poids que l'entrainement rendrait s'il s'arretait maintenant.
+static void calculerSortie(const EtatMode *m, double *poids, double *biais) {
+    const int d = m->d;
+    if (m->mode == MODE_MOYENNE) {
+        for (int z = 0; z < d; z++) poids[z] = m->w[z] - m->cumul[z] / m->compteur;
+        *biais = *m->biais - m->cumul[d] / m->compteur;
+    } else if (m->mode == MODE_POCKET) {
+        const double *source = m->serie > m->meilleureSerie ? m->w : m->poche;
+        double b = m->serie > m->meilleureSerie ? *m->biais : m->poche[d];
+        if (poids != source) memcpy(poids, source, sizeof(double) * (size_t)d);
+        *biais = b;
+    }
+}
+
+// fin d'entrainement : les poids de sortie remplacent ceux du perceptron.
+static void terminerMode(EtatMode *m, Perceptron *p) {
+    if (m->mode == MODE_CLASSIQUE) return;
+    calculerSortie(m, p->poids, &p->biais);
+    free(m->cumul ? m->cumul : m->poche);
+}
+
+// validation d'une époque : les experts portent un moment leurs poids de sortie.
+static void exposerSortie(EtatMode *etats, Perceptron **experts, int nbExperts) {
+    for (int k = 0; k < nbExperts; k++) {
+        EtatMode *m = &etats[k];
+        if (m->mode == MODE_CLASSIQUE) continue;
+        memcpy(m->courant, experts[k]->poids, sizeof(double) * (size_t)m->d);
+        m->courant[m->d] = experts[k]->biais;
+        calculerSortie(m, experts[k]->poids, &experts[k]->biais);
+    }
+}
+
+static void reprendreCourant(EtatMode *etats, Perceptron **experts, int nbExperts) {
+    for (int k = 0; k < nbExperts; k++) {
+        EtatMode *m = &etats[k];
+        if (m->mode == MODE_CLASSIQUE) continue;
+        memcpy(experts[k]->poids, m->courant, sizeof(double) * (size_t)m->d);
+        experts[k]->biais = m->courant[m->d];
+    }
+}
+
+// controlerEpoque pour des experts en mode pocket / moyenne : la validation juge les
+// poids que l'entrainement rendrait, pas les poids courants.
+static int controlerEpoqueModes(Controle *c, EtatMode *etats, Perceptron **experts, int nbExperts, int classeCible,
+                                const DataSet *ds, int erreursTrain) {
+    int exposer = etats != NULL && c->nValidation > 0;
+    if (exposer) exposerSortie(etats, experts, nbExperts);
+    int arret = controlerEpoque(c, experts, nbExperts, classeCible, ds, erreursTrain);
+    if (exposer) reprendreCourant(etats, experts, nbExperts);
+    return arret;
+}
+
+// ==================== MINI-BATCH ====================
+
+// un mini-batch est découpé en sous-blocs de taille fixe, chacun avec son propre
+// acumulateur. la fusion se fait toujours dans l'ordre des sous-blocs : le résultat
+// ne dépend donc pas du nombre de threads.
+#define TAILLE_SOUS_BLOC 256
+
+typedef struct {
+    const DataSet *ds;
+    const Perceptron *p;
+    int classeCible;
+    int debutBatch;
+    int finBatch;
+    int strideAcc;
+    double *acumulateurs;  // un vecteur de strideAcc doubles par sous-bloc (poids puis biais)
+    int *erreurs;          // nombre d'erreurs par sous-bloc
+    int *erreursLignes;    // dataset creux : erreur de chaque ligne du batch, à la place des acumulateurs
+} ContexteBatch;
+
+// sous-bloc d'un dataset creux : les poids sont figés, on ne note que l'erreur de chaque
+// ligne. les mises à jour sont apliquées ensuite ligne par ligne, en O(nnz).
+static int sousBlocCreux(const ContexteBatch *c, int j0, int j1) {
+    const Perceptron *p = c->p;
+    int erreurs = 0;
+    for (int j = j0; j < j1; j++) {
+        const int *colonnes;
+        const double *valeurs;
+        int nnz = ligneCreuse(c->ds, c->ds->indexSplit[j], &colonnes, &valeurs);
+        int label = c->ds->sortieAttendue_train[j];
+        if (c->classeCible >= 0) label = (label == c->classeCible);
+        int erreur = label - predireCreux(p, colonnes, valeurs, nnz);
+        c->erreursLignes[j - c->debutBatch] = erreur;
+        if (erreur != 0) erreurs++;
+    }
+    return erreurs;
+}
+
+// parcourt un sous-bloc avec les poids figés et cumule erreur * x localement.
+static void tacheSousBloc(void *arg, int debut, int fin) {
+    const ContexteBatch *c = arg;
+    const Perceptron *p = c->p;
+    const int d = p->nPoids;
+    for (int b = debut; b < fin; b++) {
+        int j0 = c->debutBatch + b * TAILLE_SOUS_BLOC;
+        int j1 = j0 + TAILLE_SOUS_BLOC < c->finBatch ? j0 + TAILLE_SOUS_BLOC : c->finBatch;
+        if (c->ds->creux) {
+            c->erreurs[b] = sousBlocCreux(c, j0, j1);
+            continue;
+        }
+        double *acc = c->acumulateurs + (size_t)b * c->strideAcc;
+        memset(acc, 0, sizeof(double) * (size_t)(d + 1));
+        int erreurs = 0;
+        for (int j = j0; j < j1; j += 4) {
+            int taille = j1 - j < 4 ? j1 - j : 4;
+            const double *bloc[4];
+            double sommes[4];
+            for (int r = 0; r < taille; r++) bloc[r] = ligneTrain(c->ds, j + r);
+            if (taille == 4) {
+                produitScalaire4(p->poids, bloc, d, sommes);
+            } else {
+                for (int r = 0; r < taille; r++) sommes[r] = produitScalaire(p->poids, bloc[r], d);
+            }
+            for (int r = 0; r < taille; r++) {
+                int label = c->ds->sortieAttendue_train[j + r];
+                if (c->classeCible >= 0) label = (label == c->classeCible);
+                int erreur = label - fonctionActivation(sommes[r] + p->biais);
+                if (erreur != 0) {
+                    erreurs++;
+                    for (int z = 0; z < d; z++) acc[z] += erreur * bloc[r][z];
+                    acc[d] += erreur;
+                }
+            }
+        }
+        c->erreurs[b] = erreurs;
+    }
+}
+
+// acumulateurs et pool d'un perceptron en mini-batch, gardés d'une époque à l'autre.
+typedef struct {
+    ContexteBatch c;
+    Perceptron *p;
+    PoolThreads *pool;
+    EtatMode *mode;          // NULL en mode classique
+} EtatMiniBatch;
+
+static void preparerMiniBatch(EtatMiniBatch *m, const DataSet *dataTrain, Perceptron *p, int classeCible,
+                              EtatMode *mode) {
+    const int sousBlocsMax = (p->tailleBatch + TAILLE_SOUS_BLOC - 1) / TAILLE_SOUS_BLOC;
+    m->p = p;
+    m->mode = mode;
+    m->c.ds = dataTrain;
+    m->c.p = p;
+    m->c.classeCible = classeCible;
+    m->c.strideAcc = calculerStride(p->nPoids + 1);
+    m->c.acumulateurs = NULL;
+    m->c.erreursLignes = NULL;
+    if (dataTrain->creux) m->c.erreursLignes = malloc(sizeof(int) * (size_t)p->tailleBatch);
+    else m->c.acumulateurs = allocMatrice(sousBlocsMax, m->c.strideAcc);
+    m->c.erreurs = malloc(sizeof(int) * (size_t)sousBlocsMax);
+    int nbThreads = p->nbThreads > 0 ? p->nbThreads : nbThreadsParDefaut();
+    if (nbThreads > sousBlocsMax) nbThreads = sousBlocsMax;
+    m->pool = nbThreads > 1 ? creerPool(nbThreads) : NULL;
+}
+
+static void terminerMiniBatch(EtatMiniBatch *m) {
+    detruirePool(m->pool);
+    free(m->c.acumulateurs);
+    free(m->c.erreursLignes);
+    free(m->c.erreurs);
+}
+
+// dataset creux : la somme des mises à jour du batch, apliquée ligne par ligne.
+static void appliquerBatchCreux(EtatMiniBatch *m, double pas) {
+    const ContexteBatch *c = &m->c;
+    Perceptron *p = m->p;
+    for (int j = c->debutBatch; j < c->finBatch; j++) {
+        int erreur = c->erreursLignes[j - c->debutBatch];
+        if (erreur == 0) continue;
+        const int *colonnes;
+        const double *valeurs;
+        int nnz = ligneCreuse(c->ds, c->ds->indexSplit[j], &colonnes, &valeurs);
+        ajouterCreux(p->poids, pas * erreur, colonnes, valeurs, nnz);
+        p->biais = p->biais + pas * erreur;
+        if (m->mode) cumulerMoyenneCreuse(m->mode, pas * erreur, colonnes, valeurs, nnz, pas * erreur);
+    }
+}
+
+// une époque en mini-batch sur les nLignes premieres lignes du train : les lignes d'un
+// batch sont évaluées avec les memes poids, réparties par sous-blocs sur le pool, puis
+// la somme des mises à jour est apliquée en une fois à la fin du batch. en pocket et
+// moyenne, un batch compte comme un exemple : les poids étant figés sur tout le batch,
+// pocket garde ceux qui y ont fait le plus de bonnes prédictions, et la moyenne porte
+// sur les poids après chaque batch.
+// retourne le nombre d'erreurs de l'époque.
+static int epoqueMiniBatch(EtatMiniBatch *m, int nLignes) {
+    ContexteBatch *c = &m->c;
+    Perceptron *p = m->p;
+    const int d = p->nPoids;
+    const int tailleBatch = p->tailleBatch;
+    int erreurTrouve = 0;
+    for (int debut = 0; debut < nLignes; debut += tailleBatch) {
+        c->debutBatch = debut;
+        c->finBatch = debut + tailleBatch < nLignes ? debut + tailleBatch : nLignes;
+        int nbSousBlocs = (c->finBatch - debut + TAILLE_SOUS_BLOC - 1) / TAILLE_SOUS_BLOC;
+        if (m->pool) poolExecuter(m->pool, nbSousBlocs, tacheSousBloc, c);
+        else tacheSousBloc(c, 0, nbSousBlocs);
+        // fusion des acumulateurs dans l'ordre des sous-blocs.
+        double *total = c->acumulateurs;
+        for (int b = 1; total && b < nbSousBlocs; b++) {
+            const double *acc = c->acumulateurs + (size_t)b * c->strideAcc;
+            for (int z = 0; z <= d; z++) total[z] += acc[z];
+        }
+        int erreursBatch = 0;
+        for (int b = 0; b < nbSousBlocs; b++) erreursBatch += c->erreurs[b];
+        if (m->mode) {
+            m->mode->serie = c->finBatch - debut - erreursBatch;
+            fermerSerie(m->mode);
+        }
+        if (erreursBatch != 0) {
+            // moyenne des mises à jour du batch : le pas garde le meme ordre de grandeur
+            // qu'en ligne quelle que soit la taille du batch.
+            erreurTrouve += erreursBatch;
+            double pas = p->pasApprentissage / (c->finBatch - debut);
+            if (total) {
+                for (int z = 0; z < d; z++) p->poids[z] += pas * total[z];
+                p->biais = p->biais + pas * total[d];
+                if (m->mode) cumulerMoyenne(m->mode, pas, total, pas * total[d]);
+            } else {
+                appliquerBatchCreux(m, pas);
+            }
+        }
+        if (m->mode) m->mode->compteur++;
+    }
+    return erreurTrouve;
+}
+
+// epoqueEnLigne sur un dataset creux : chaque ligne coûte O(nnz), pas O(nPoids).
+static int epoqueEnLigneCreuse(const DataSet *dataTrain, Perceptron *p, int classeCible, int nLignes,
+                               EtatMode *mode) {
+    int erreurTrouve = 0;
+    for (int j = 0 ; j < nLignes ; j++) {
+        const int *colonnes;
+        const double *valeurs;
+        int nnz = ligneCreuse(dataTrain, dataTrain->indexSplit[j], &colonnes, &valeurs);
+        int label = dataTrain->sortieAttendue_train[j];
+        if (classeCible >= 0) label = (label == classeCible);
+        int erreur = label - predireCreux(p, colonnes, valeurs, nnz);
+        if (erreur != 0) {
+            erreurTrouve++;
+            if (mode) fermerSerie(mode);
+            ajouterCreux(p->poids, erreur * p->pasApprentissage, colonnes, valeurs, nnz);
+            p->biais = p->biais + erreur * p->pasApprentissage;
+            if (mode) {
+                cumulerMoyenneCreuse(mode, erreur * p->pasApprentissage, colonnes, valeurs, nnz,
+                                     erreur * p->pasApprentissage);
+            }
+        } else if (mode) {
+            mode->serie++;
+        }
+        if (mode) mode->compteur++;
+    }
+    return erreurTrouve;
+}
+
+// une époque d'apprentissage en ligne sur les nLignes premieres lignes du train.
+// mode est NULL en mode classique. retourne le nombre d'erreurs de l'époque.
+static int epoqueEnLigne(const DataSet *dataTrain, Perceptron *p, int classeCible, int nLignes, EtatMode *mode) {
+    if (dataTrain->creux) return epoqueEnLigneCreuse(dataTrain, p, classeCible, nLignes, mode);
+    int erreurTrouve = 0;
+    for (int j = 0 ; j < nLignes ; j++) {
+        const double *ligne = ligneTrain(dataTrain, j);
+        int prediction = predire(p, ligne);
+        int label = dataTrain->sortieAttendue_train[j];
+        if (classeCible >= 0) label = (label == classeCible);
+        int erreur = label - prediction;
+        if (erreur != 0) {
+            erreurTrouve++;
+            if (mode) fermerSerie(mode);
+            for (int z = 0; z < p->nPoids; z++) {
+                p->poids[z] += erreur * p->pasApprentissage * ligne[z];
+            }
+            p->biais = p->biais + erreur * p->pasApprentissage;
+            if (mode) cumulerMoyenne(mode, erreur * p->pasApprentissage, ligne, erreur * p->pasApprentissage);
+        } else if (mode) {
+            mode->serie++;
+        }
+        if (mode) mode->compteur++;
+    }
+    return erreurTrouve;
+}
+
+// ajuste les poids et le biais du perceptron selon la regle d'apprentissage.
+// si classeCible >= 0 le label attendu est (label == classeCible), sinon le label lui meme.
+// le dataset n'est jamais modifié, plusieurs threads peuvent l'utiliser en meme temps.
+// suivi peut etre NULL (arret à la convergence ou au bout des époques).
+static void entrainerVersCible(const DataSet *dataTrain, Perceptron *p, int classeCible, SuiviEntrainement *suivi) {
+    if (dataTrain->indexSplit == NULL) {
+        printf("Erreur : le dataset n'a pas ete splitte\n");
+        return;
+    }
+    Controle controle;
+    demarrerControle(&controle, suivi, dataTrain, 1, p->nPoids);
+    EtatMode etat;
+    preparerMode(&etat, p->modeApprentissage, p->poids, &p->biais, p->nPoids);
+    EtatMode *mode = etat.mode != MODE_CLASSIQUE ? &etat : NULL;
+    EtatMiniBatch mb;
+    if (p->tailleBatch > 1) preparerMiniBatch(&mb, dataTrain, p, classeCible, mode);
+    for (int i = 0; i < p->epoque ; i++) {
+        int erreurTrouve = p->tailleBatch > 1 ? epoqueMiniBatch(&mb, controle.nApprentissage)
+                                              : epoqueEnLigne(dataTrain, p, classeCible, controle.nApprentissage, mode);
+        if (controlerEpoqueModes(&controle, mode, &p, 1, classeCible, dataTrain, erreurTrouve)) break;
+    }
+    if (p->tailleBatch > 1) terminerMiniBatch(&mb);
+    terminerMode(&etat, p);
+    terminerControle(&controle, &p, 1);
+}
+
 // ajuste les poids et le biais du perceptron selon la regle d'apprentissage.
 // s'arrête si le nombre d'époques est atteint ou si plus aucune ereur n'est détectée.
 void entrainerPerceptron(const DataSet *dataTrain, Perceptron *p) {
-    for (int i = 0; i < p->epoque ; i++) {
-        int erreurTrouve = 0;
-        for (int j = 0 ; j < dataTrain->nTrain ; j++) {
-            if (dataTrain->tab_Train[j] == NULL) {
-                printf("Erreur : tab_Train[%d] est NULL\n", j);
-                return;
+    entrainerVersCible(dataTrain, p, -1, NULL);
+}
+
+void entrainerPerceptronSuivi(const DataSet *dataTrain, Perceptron *p, SuiviEntrainement *suivi) {
+    entrainerVersCible(dataTrain, p, -1, suivi);
+}
+
+// entraine plusieur perceptrons selon la stratégie "one-vs-all".
+// chaque perceptron devient un expert pour reconnaitre une classe spécifique.
+// tous les experts avancent ensemble : chaque ligne du train n'est lue qu'une fois
+// par époque et sert aux K experts, le label binaire (label == k) est calculé à la volée.
+// les poids sont regroupés dans une matrice K x d contiguë le temps de l'entrainement.
+// le résultat est identique à un entrainement expert par expert avec entrainerPerceptron.
+static void entrainerMultiClasseFusion(Perceptron **perceptrons, int nbLabel, const DataSet *ds,
+                                       SuiviEntrainement *suivi) {
+    const int d = perceptrons[0]->nPoids;
+    const int stride = calculerStride(d);
+    double *poids = allocMatrice(nbLabel, stride);
+    double *biais = malloc(sizeof(double) * (size_t)nbLabel);
+    int *erreurs = malloc(sizeof(int) * (size_t)nbLabel);
+    int *actifs = malloc(sizeof(int) * (size_t)nbLabel);
+    int *termine = calloc((size_t)nbLabel, sizeof(int));
+    int maxEpoque = 0;
+    for (int k = 0; k < nbLabel; k++) {
+        memcpy(poids + (size_t)k * stride, perceptrons[k]->poids, sizeof(double) * (size_t)d);
+        biais[k] = perceptrons[k]->biais;
+        if (perceptrons[k]->epoque > maxEpoque) maxEpoque = perceptrons[k]->epoque;
+    }
+    // modes pocket / moyenne : suivis sur les lignes de la matrice.
+    int avecModes = 0;
+    for (int k = 0; k < nbLabel; k++) {
+        if (perceptrons[k]->modeApprentissage != MODE_CLASSIQUE) avecModes = 1;
+    }
+    EtatMode *etats = avecModes ? malloc(sizeof(EtatMode) * (size_t)nbLabel) : NULL;
+    if (etats) {
+        for (int k = 0; k < nbLabel; k++) {
+            preparerMode(&etats[k], perceptrons[k]->modeApprentissage, poids + (size_t)k * stride, &biais[k], d);
+        }
+    }
+    Controle controle;
+    demarrerControle(&controle, suivi, ds, nbLabel, d);
+    for (int e = 0; e < maxEpoque; e++) {
+        // experts encore en cours : ni convergés, ni à court d'époques.
+        int nbActifs = 0;
+        for (int k = 0; k < nbLabel; k++) {
+            if (!termine[k] && e < perceptrons[k]->epoque) actifs[nbActifs++] = k;
+            erreurs[k] = 0;
+        }
+        if (nbActifs == 0) break;
+        for (int j = 0; j < controle.nApprentissage; j++) {
+            const double *ligne = ligneTrain(ds, j);
+            int label = ds->sortieAttendue_train[j];
+            for (int a = 0; a < nbActifs; a += 4) {
+                int taille = nbActifs - a < 4 ? nbActifs - a : 4;
+                double sommes[4];
+                if (taille == 4) {
+                    // la ligne joue le role du vecteur partagé, les 4 experts celui des lignes.
+                    const double *bloc[4];
+                    for (int r = 0; r < 4; r++) bloc[r] = poids + (size_t)actifs[a + r] * stride;
+                    produitScalaire4(ligne, bloc, d, sommes);
+                } else {
+                    for (int r = 0; r < taille; r++) {
+                        sommes[r] = produitScalaire(poids + (size_t)actifs[a + r] * stride, ligne, d);
+                    }
+                }
+                for (int r = 0; r < taille; r++) {
+                    int k = actifs[a + r];
+                    int prediction = fonctionActivation(sommes[r] + biais[k]);
+                    int erreur = (label == k) - prediction;
+                    if (erreur != 0) {
+                        erreurs[k]++;
+                        double *w = poids + (size_t)k * stride;
+                        double pas = perceptrons[k]->pasApprentissage;
+                        if (etats) fermerSerie(&etats[k]);
+                        for (int z = 0; z < d; z++) {
+                            w[z] += erreur * pas * ligne[z];
+                        }
+                        biais[k] = biais[k] + erreur * pas;
+                        if (etats) cumulerMoyenne(&etats[k], erreur * pas, ligne, erreur * pas);
+                    } else if (etats) {
+                        etats[k].serie++;
+                    }
+                    if (etats) etats[k].compteur++;
+                }
             }
-            int prediction = predire(p, dataTrain->tab_Train[j]);
-            int label = dataTrain->sortieAttendue_train[j];
-            int erreur = label - prediction;
-            if (erreur != 0) {
-                erreurTrouve++;
-                for (int z = 0; z < p->nPoids; z++) {
-                    p->poids[z] += erreur * p->pasApprentissage * dataTrain->tab_Train[j][z];
+        }
+        int total = 0;
+        for (int a = 0; a < nbActifs; a++) {
+            if (erreurs[actifs[a]] == 0) termine[actifs[a]] = 1;
+            total += erreurs[actifs[a]];
+        }
+        if (suivi) {
+            // la validation prédit avec les perceptrons : on leur recopie les poids courants.
+            if (controle.nValidation > 0) {
+                for (int k = 0; k < nbLabel; k++) {
+                    memcpy(perceptrons[k]->poids, poids + (size_t)k * stride, sizeof(double) * (size_t)d);
+                    perceptrons[k]->biais = biais[k];
                 }
-                p->biais = p->biais + erreur * p->pasApprentissage;
             }
+            if (controlerEpoqueModes(&controle, etats, perceptrons, nbLabel, -1, ds, total)) break;
         }
-        if (erreurTrouve == 0 ) break;
     }
+    for (int k = 0; k < nbLabel; k++) {
+        memcpy(perceptrons[k]->poids, poids + (size_t)k * stride, sizeof(double) * (size_t)d);
+        perceptrons[k]->biais = biais[k];
+        if (etats) terminerMode(&etats[k], perceptrons[k]);
+    }
+    free(etats);
+    terminerControle(&controle, perceptrons, nbLabel);
+    free(poids);
+    free(biais);
+    free(erreurs);
+    free(actifs);
+    free(termine);
 }
 
-// entraine plusieur perceptrons selon la stratégie "one-vs-all".
-// chaque perceptron devient un expert pour reconnaitre une classe spécifique.
 void entrainerMultiClasse(Perceptron **perceptrons, int nbLabel, const DataSet *ds) {
-    for (int i = 0; i < nbLabel; i++) {
-        int *labelsOriginaux = malloc(ds->nTrain * sizeof(int));
-        for (int k = 0; k < ds->nTrain; k++) {
-            labelsOriginaux[k] = ds->sortieAttendue_train[k];
-            ds->sortieAttendue_train[k] = (labelsOriginaux[k] == i) ? 1 : 0;
+    entrainerMultiClasseSuivi(perceptrons, nbLabel, ds, 1, NULL);
+}
+
+typedef struct {
+    Perceptron **experts;
+    const DataSet *ds;
+    // entrainement suivi : une époque par tache, sur les nApprentissage premieres lignes.
+    const int *actifs;
+    int *erreurs;
+    int nApprentissage;
+    EtatMode *etats;
+} ContexteExperts;
+
+static void tacheExpert(void *arg, int debut, int fin) {
+    const ContexteExperts *c = arg;
+    for (int k = debut; k < fin; k++) entrainerVersCible(c->ds, c->experts[k], k, NULL);
+}
+
+static void tacheEpoqueExpert(void *arg, int debut, int fin) {
+    const ContexteExperts *c = arg;
+    for (int a = debut; a < fin; a++) {
+        int k = c->actifs[a];
+        EtatMode *mode = c->etats[k].mode != MODE_CLASSIQUE ? &c->etats[k] : NULL;
+        c->erreurs[k] = epoqueEnLigne(c->ds, c->experts[k], k, c->nApprentissage, mode);
+    }
+}
+
+// one-vs-all suivi quand la version fusionnée ne s'aplique pas (mini-batch ou plusieurs
+// threads) : les experts avancent d'une époque à la fois pour que le controle voie
+// l'ensemble. en ligne, les experts d'une époque sont répartis sur le pool ; en mini-batch
+// chaque expert utilise déjà son propre pool, ils passent donc un par un.
+static void entrainerMultiClasseParEpoque(Perceptron **perceptrons, int nbLabel, const DataSet *ds, int nbThreads,
+                                          SuiviEntrainement *suivi) {
+    int miniBatch = 0, maxEpoque = 0;
+    for (int k = 0; k < nbLabel; k++) {
+        if (perceptrons[k]->tailleBatch > 1) miniBatch = 1;
+        if (perceptrons[k]->epoque > maxEpoque) maxEpoque = perceptrons[k]->epoque;
+    }
+    EtatMode *etats = malloc(sizeof(EtatMode) * (size_t)nbLabel);
+    for (int k = 0; k < nbLabel; k++) {
+        preparerMode(&etats[k], perceptrons[k]->modeApprentissage, perceptrons[k]->poids, &perceptrons[k]->biais,
+                     perceptrons[k]->nPoids);
+    }
+    EtatMiniBatch *mb = NULL;
+    if (miniBatch) {
+        mb = malloc(sizeof(EtatMiniBatch) * (size_t)nbLabel);
+        for (int k = 0; k < nbLabel; k++) {
+            EtatMode *mode = etats[k].mode != MODE_CLASSIQUE ? &etats[k] : NULL;
+            if (perceptrons[k]->tailleBatch > 1) preparerMiniBatch(&mb[k], ds, perceptrons[k], k, mode);
+        }
+    }
+    int *actifs = malloc(sizeof(int) * (size_t)nbLabel);
+    int *erreurs = calloc((size_t)nbLabel, sizeof(int));
+    int *termine = calloc((size_t)nbLabel, sizeof(int));
+    if (nbThreads > nbLabel) nbThreads = nbLabel;
+    PoolThreads *pool = !miniBatch && nbThreads > 1 ? creerPool(nbThreads) : NULL;
+    Controle controle;
+    demarrerControle(&controle, suivi, ds, nbLabel, perceptrons[0]->nPoids);
+    ContexteExperts c = { perceptrons, ds, actifs, erreurs, controle.nApprentissage, etats };
+    for (int e = 0; e < maxEpoque; e++) {
+        int nbActifs = 0;
+        for (int k = 0; k < nbLabel; k++) {
+            if (!termine[k] && e < perceptrons[k]->epoque) actifs[nbActifs++] = k;
+        }
+        if (nbActifs == 0) break;
+        if (pool) {
+            poolExecuter(pool, nbActifs, tacheEpoqueExpert, &c);
+        } else {
+            for (int a = 0; a < nbActifs; a++) {
+                int k = actifs[a];
+                EtatMode *mode = etats[k].mode != MODE_CLASSIQUE ? &etats[k] : NULL;
+                erreurs[k] = perceptrons[k]->tailleBatch > 1
+                                 ? epoqueMiniBatch(&mb[k], controle.nApprentissage)
+                                 : epoqueEnLigne(ds, perceptrons[k], k, controle.nApprentissage, mode);
+            }
+        }
+        int total = 0;
+        for (int a = 0; a < nbActifs; a++) {
+            if (erreurs[actifs[a]] == 0) termine[actifs[a]] = 1;
+            total += erreurs[actifs[a]];
         }
-        entrainerPerceptron(ds, perceptrons[i]);
-        for (int k = 0; k < ds->nTrain; k++) {
-            ds->sortieAttendue_train[k] = labelsOriginaux[k];
+        if (controlerEpoqueModes(&controle, etats, perceptrons, nbLabel, -1, ds, total)) break;
+    }
+    for (int k = 0; k < nbLabel; k++) terminerMode(&etats[k], perceptrons[k]);
+    free(etats);
+    terminerControle(&controle, perceptrons, nbLabel);
+    detruirePool(pool);
+    if (mb) {
+        for (int k = 0; k < nbLabel; k++) {
+            if (perceptrons[k]->tailleBatch > 1) terminerMiniBatch(&mb[k]);
         }
-        free(labelsOriginaux);
+        free(mb);
     }
+    free(actifs);
+    free(erreurs);
+    free(termine);
+}
+
+// one-vs-all en parallèle : un expert par tache, distribuées sur un pool de nbThreads
+// workers (0 = un par coeur). les labels sont partagés en lecture seule et chaque expert
+// ne dépend que de ses propres poids, donc le résultat ne dépend pas du nombre de threads.
+void entrainerMultiClasseParallele(Perceptron **perceptrons, int nbLabel, const DataSet *ds, int nbThreads) {
+    entrainerMultiClasseSuivi(perceptrons, nbLabel, ds, nbThreads, NULL);
 }
 
-// compare les scores de probabilité de chaque expert pour une entrée donnée.
-// désigne comme gagnante la clase ayant obtenu la probabilité la plus élevée.
+void entrainerMultiClasseSuivi(Perceptron **perceptrons, int nbLabel, const DataSet *ds, int nbThreads,
+                               SuiviEntrainement *suivi) {
+    if (nbLabel <= 0) return;
+    if (ds->indexSplit == NULL) {
+        printf("Erreur : le dataset n'a pas ete splitte\n");
+        return;
+    }
+    if (nbThreads <= 0) nbThreads = nbThreadsParDefaut();
+    if (nbThreads > nbLabel) nbThreads = nbLabel;
+    // la version fusionnée recopie les poids dans une matrice K x d : sur un dataset creux
+    // chaque expert garde ses poids et ne touche que les colones non nulles.
+    int fusion = ds->creux == NULL;
+    int miniBatch = 0;
+    for (int k = 0; k < nbLabel; k++) {
+        if (perceptrons[k]->tailleBatch > 1) miniBatch = 1;
+    }
+    if (suivi) {
+        if (!miniBatch && fusion && nbThreads <= 1) entrainerMultiClasseFusion(perceptrons, nbLabel, ds, suivi);
+        else entrainerMultiClasseParEpoque(perceptrons, nbLabel, ds, nbThreads, suivi);
+        return;
+    }
+    if (nbThreads <= 1) {
+        // les experts en mini-batch ont leur propre boucle, on les entraine un par un.
+        if (miniBatch || !fusion) {
+            for (int e = 0; e < nbLabel; e++) entrainerVersCible(ds, perceptrons[e], e, NULL);
+        } else {
+            entrainerMultiClasseFusion(perceptrons, nbLabel, ds, NULL);
+        }
+        return;
+    }
+    ContexteExperts c = { perceptrons, ds, NULL, NULL, 0, NULL };
+    PoolThreads *pool = creerPool(nbThreads);
+    poolExecuter(pool, nbLabel, tacheExpert, &c);
+    detruirePool(pool);
+}
+
+// compare les scores de chaque expert pour une entrée donnée.
+// désigne comme gagnante la premiere clase au score maximal : c'est celle à la probabilité
+// la plus élevée (la sigmoïde est croissante), sans les égalités des sigmoïdes arrondies à
+// 1.0 pour les grands scores. meme règle que les images de décision (ligneDecision).
 int predireMulti(Perceptron **experts, int nbClasses, const double *entree) {
     int gagnant = 0;
-    double maxProba = -1.0;
+    double meilleur = 0;
     for (int i = 0; i < nbClasses; i++) {
-        double p = predireProba(experts[i], entree);
-        if (p > maxProba) {
-            maxProba = p;
+        Perceptron *p = experts[i];
+        double s = p->produit(p->poids, entree, p->nPoids) + p->biais;
+        if (i == 0 || s > meilleur) {
+            meilleur = s;
             gagnant = i;
         }
     }
     return gagnant;
 }
 
+// ==================== PRÉDICTION PAR LOTS ====================
+
+// nombre de lignes traitées ensemble par un thread (sommes gardées sur la pile).
+#define TAILLE_LOT 256
+// en dessous de ce nombre de lignes, un seul thread suffit.
+#define SEUIL_LOT_PARALLELE 16384
+
+enum { LOT_CLASSE, LOT_PROBA, LOT_MULTI };
+
+typedef struct {
+    Perceptron *const *experts;
+    int nbExperts;
+    int mode;
+    const double *lignes;
+    int stride;
+    const int *index;
+    int *sortieClasse;
+    double *sortieProba;
+    const DataSet *creux;    // lignes lues dans ce dataset creux à la place de lignes
+    FonctionScoresFixes scoresFixes;   // LOT_MULTI dense avec peu d'experts étroits, sinon NULL
+    FonctionProduit4 produit4;         // lignes denses par paquets de 4, résolu une fois par apel
+} ContexteLot;
+
+// un perceptron sur une largeur déroulée passe aussi ses paquets de 4 lignes en version déroulée.
+static FonctionProduit4 produit4Lot(const Perceptron *p) {
+    return p->produit == noyauProduitFixe(p->nPoids) ? noyauProduit4Fixe(p->nPoids) : produitScalaire4;
+}
+
+static const double *ligneLot(const ContexteLot *c, int i) {
+    size_t r = c->index ? (size_t)c->index[i] : (size_t)i;
+    return c->lignes + r * (size_t)c->stride;
+}
+
+// calcule les sommes pondérées (biais compris) des lignes [debut, fin) par paquets de 4,
+// les poids restent dans les registres pour les 4 lignes du paquet.
+static void sommesLot(const Perceptron *p, const ContexteLot *c, int debut, int fin, double *sommes) {
+    if (c->creux) {
+        for (int i = debut; i < fin; i++) {
+            const int *colonnes;
+            const double *valeurs;
+            int nnz = ligneCreuse(c->creux, c->index ? c->index[i] : i, &colonnes, &valeurs);
+            sommes[i - debut] = produitScalaireCreux(p->poids, colonnes, valeurs, nnz) + p->biais;
+        }
+        return;
+    }
+    int i = debut;
+    for (; i + 4 <= fin; i += 4) {
+        const double *bloc[4] = { ligneLot(c, i), ligneLot(c, i + 1), ligneLot(c, i + 2), ligneLot(c, i + 3) };
+        c->produit4(p->poids, bloc, p->nPoids, &sommes[i - debut]);
+    }
+    for (; i < fin; i++) sommes[i - debut] = p->produit(p->poids, ligneLot(c, i), p->nPoids);
+    for (int k = 0; k < fin - debut; k++) sommes[k] += p->biais;
+}
+
+static void tacheLot(void *arg, int debut, int fin) {
+    const ContexteLot *c = arg;
+    double sommes[TAILLE_LOT];
+    double meilleure[TAILLE_LOT];
+    for (int d = debut; d < fin; d += TAILLE_LOT) {
+        int f = d + TAILLE_LOT < fin ? d + TAILLE_LOT : fin;
+        int taille = f - d;
+        if (c->mode == LOT_CLASSE) {
+            sommesLot(c->experts[0], c, d, f, sommes);
+            for (int k = 0; k < taille; k++) c->sortieClasse[d + k] = fonctionActivation(sommes[k]);
+        } else if (c->mode == LOT_PROBA) {
+            sommesLot(c->experts[0], c, d, f, sommes);
+            for (int k = 0; k < taille; k++) c->sortieProba[d + k] = fonctionActivationMultiClass(sommes[k]);
+        } else if (c->scoresFixes) {
+            // tous les experts d'un coup sur chaque ligne, meme règle que ci-dessous.
+            const double *poids[4];
+            for (int e = 0; e < c->nbExperts; e++) poids[e] = c->experts[e]->poids;
+            for (int k = 0; k < taille; k++) {
+                double scores[4];
+                c->scoresFixes(poids, ligneLot(c, d + k), scores);
+                int gagnant = 0;
+                double meilleur = scores[0] + c->experts[0]->biais;
+                for (int e = 1; e < c->nbExperts; e++) {
+                    double s = scores[e] + c->experts[e]->biais;
+                    if (s > meilleur) {
+                        meilleur = s;
+                        gagnant = e;
+                    }
+                }
+                c->sortieClasse[d + k] = gagnant;
+            }
+        } else {
+            // meme règle que predireMulti : la premiere clase au score maximal gagne.
+            sommesLot(c->experts[0], c, d, f, meilleure);
+            for (int k = 0; k < taille; k++) c->sortieClasse[d + k] = 0;
+            for (int e = 1; e < c->nbExperts; e++) {
+                sommesLot(c->experts[e], c, d, f, sommes);
+                for (int k = 0; k < taille; k++) {
+                    if (sommes[k] > meilleure[k]) {
+                        meilleure[k] = sommes[k];
+                        c->sortieClasse[d + k] = e;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void verifierModele(const Perceptron *p) {
+    if (p == NULL || p->poids == NULL) {
+        printf("Erreur fatale : pointeur NULL dans predire\n");
+        exit(1);
+    }
+}
+
+// prédit la clase (0 ou 1) de n lignes en un seul apel.
+void predireBatch(const Perceptron *p, const double *lignes, int stride, const int *index, int n, int *sortie) {
+    verifierModele(p);
+    Perceptron *const experts[1] = { (Perceptron *)p };
+    ContexteLot c = { experts, 1, LOT_CLASSE, lignes, stride, index, sortie, NULL, NULL, NULL, produit4Lot(p) };
+    executerParallele(0, n, SEUIL_LOT_PARALLELE, tacheLot, &c);
+}
+
+// score de confiance (sigmoïde) de n lignes en un seul apel.
+void predireProbaBatch(const Perceptron *p, const double *lignes, int stride, const int *index, int n,
+                       double *sortie) {
+    verifierModele(p);
+    Perceptron *const experts[1] = { (Perceptron *)p };
+    ContexteLot c = { experts, 1, LOT_PROBA, lignes, stride, index, NULL, sortie, NULL, NULL, produit4Lot(p) };
+    executerParallele(0, n, SEUIL_LOT_PARALLELE, tacheLot, &c);
+}
+
+// version par lots de predireMulti : chaque expert parcourt le paquet de lignes à son tour.
+void predireMultiBatch(Perceptron **experts, int nbClasses, const double *lignes, int stride, const int *index,
+                       int n, int *sortie) {
+    for (int e = 0; e < nbClasses; e++) verifierModele(experts[e]);
+    ContexteLot c = { experts, nbClasses, LOT_MULTI, lignes, stride, index, sortie, NULL, NULL,
+                      noyauScoresFixes(nbClasses, experts[0]->nPoids), produit4Lot(experts[0]) };
+    executerParallele(0, n, SEUIL_LOT_PARALLELE, tacheLot, &c);
+}
+
+// predireBatch (1 expert) ou predireMultiBatch sur les lignes d'un dataset, dense ou creux.
+void predireDataSet(Perceptron **experts, int nbExperts, const DataSet *ds, const int *index, int n, int *sortie) {
+    if (!ds->creux) {
+        if (nbExperts == 1) predireBatch(experts[0], ds->donnees, ds->stride, index, n, sortie);
+        else predireMultiBatch(experts, nbExperts, ds->donnees, ds->stride, index, n, sortie);
+        return;
+    }
+    for (int e = 0; e < nbExperts; e++) verifierModele(experts[e]);
+    ContexteLot c = { experts, nbExperts, nbExperts == 1 ? LOT_CLASSE : LOT_MULTI, NULL, 0, index, sortie, NULL, ds,
+                      NULL, NULL };
+    executerParallele(0, n, SEUIL_LOT_PARALLELE, tacheLot, &c);
+}
+
 // calcule le taux de réussite (0.0 à 1.0) sur les données de teste.
+// si le dataset n'est pas encore séparé, il est mélangé ici (d'où le DataSet non const).
 // compare les prédictions du modele avec les étiquettes réeles non vues durant l'entrainement.
-double accuracy(Perceptron *p, const DataSet *dataTest) {
+double accuracy(Perceptron *p, DataSet *dataTest) {
+    if (dataTest->nTest == 0) {
+        melanger(dataTest);
+    }
     int nombreDePrediction = dataTest->nTest;
+    int *predictions = malloc(sizeof(int) * (size_t)nombreDePrediction);
+    predireDataSet(&p, 1, dataTest, dataTest->indexSplit + dataTest->nTrain, nombreDePrediction, predictions);
     int nombreDeSucces = 0;
+    for (int i = 0; i < nombreDePrediction ; i++) {
+        if (predictions[i] == dataTest->sortieAttendue_Teste[i]) nombreDeSucces++;
+    }
+    free(predictions);
+    return (double) nombreDeSucces / nombreDePrediction;
+}
+
+// meme chose que accuracy pour un ensemble d'experts one-vs-all.
+double accuracyMulti(Perceptron **experts, int nbClasses, DataSet *dataTest) {
     if (dataTest->nTest == 0) {
         melanger(dataTest);
-        nombreDePrediction = dataTest->nTest;
     }
+    int nombreDePrediction = dataTest->nTest;
+    int *predictions = malloc(sizeof(int) * (size_t)nombreDePrediction);
+    predireDataSet(experts, nbClasses, dataTest, dataTest->indexSplit + dataTest->nTrain, nombreDePrediction,
+                   predictions);
+    int nombreDeSucces = 0;
     for (int i = 0; i < nombreDePrediction ; i++) {
-        int prediction = predire(p, dataTest->tab_Teste[i]);
-        int label = dataTest->sortieAttendue_Teste[i];
-        if (label - prediction == 0) {
-            nombreDeSucces++;
-        }
+        if (predictions[i] == dataTest->sortieAttendue_Teste[i]) nombreDeSucces++;
     }
+    free(predictions);
     return (double) nombreDeSucces / nombreDePrediction;
 }
 
@@ -168,8 +1048,10 @@ Perceptron* chargerPerceptron(const char *file) {
         return NULL;
     }
     rewind(f);
-    Perceptron* p = malloc(sizeof(Perceptron));
+    Perceptron* p = calloc(1, sizeof(Perceptron));
+    p->nbThreads = 1;
     p->nPoids = totalMots - 1;
+    p->produit = choisirProduit(p->nPoids);
     p->poids = malloc(p->nPoids * sizeof(double));
     char *endPtr;
     if (fscanf(f, "%255s", mot) != EOF) {
@@ -189,7 +1071,7 @@ Perceptron* chargerPerceptron(const char *file) {
 void libererPerceptron(Perceptron *p) {
     p->biais = 0;
     p->epoque = 0;
-    free(p->poids);
+    if (!p->poidsExternes) free(p->poids);
     p->accuracy = 0;
     free(p);
 }
@@ -218,18 +1100,325 @@ void listerFichiersPerceptron() {
 
 // enregistre le biais et les poids du modele actuelle dans un fichier texte.
 // le fichier est stocké dans le sous-dosier dédié 'perceptron/'.
+// obsolète : le menu et la cli passent par sauvegarderModele. %.17g garde chaque double
+// exact à la relecture (chargerPerceptron), là où %f le coupait à 6 décimales.
 void sauvegarderPerceptron(const Perceptron *p, const char *file) {
     char chemin[255];
     snprintf(chemin, sizeof(chemin), "Perceptron/%s", file);
     FILE *f = fopen(chemin, "w");
     if (f == NULL) {
         printf("Erreur lors de la création du fichier de sauvegarde\n");
+        return;
     }
-    else {
-        fprintf(f, "%f\n", p->biais);
-        for (int i = 0 ; i < p->nPoids ; i++){
-            fprintf(f, "%f\n", p->poids[i]);
-        }
+    fprintf(f, "%.17g\n", p->biais);
+    for (int i = 0 ; i < p->nPoids ; i++){
+        fprintf(f, "%.17g\n", p->poids[i]);
     }
     fclose(f);
-}
\ No newline at end of file
+}
+// ==================== FORMAT BINAIRE DES MODELES ====================
+// entete fixe, métadonnées de chaque expert, noms (colones puis classes, en longueur +
+// octets), la normalisation des données si il y en a une (d décalages puis d échelles),
+// puis la matrice K x stride des poids alignée sur 64 octets. depuis la version 2, les poids
+// peuvent etre suivis d'une copie en float ou en int8 (voir precision.h) pour la prédiction.
+// au chargement le fichier est projeté en mémoire et les poids sont utilisés tels quels.
+
+#define MAGIE_MODELE "PCPMODL"
+#define VERSION_MODELE 2
+#define ORDRE_OCTETS_MODELE 0x01020304u
+
+typedef struct {
+    char magie[8];
+    uint32_t version;
+    uint32_t ordreOctets;
+    uint32_t nbExperts;
+    uint32_t nPoids;
+    uint32_t stride;
+    uint32_t nbClasses;
+    uint32_t nbNomsColonnes;
+    uint32_t typeNormalisation;   // 0 = aucune, sinon NORMALISATION_STANDARD / _MINMAX
+    uint64_t offsetMeta;
+    uint64_t offsetNoms;
+    uint64_t offsetNormalisation;
+    uint64_t offsetPoids;
+    uint64_t tailleFichier;
+    // version 2 : poids compacts (PRECISION_DOUBLE = aucun).
+    uint32_t precision;
+    uint32_t strideCompact;
+    uint64_t offsetCompact;
+} EnteteModele;
+
+// taille de l'entete d'un fichier version 1, qui s'arrete avant les poids compacts.
+#define TAILLE_ENTETE_V1 offsetof(EnteteModele, precision)
+
+typedef struct {
+    double biais;
+    double pasApprentissage;
+    double accuracy;
+    int32_t epoque;
+    int32_t tailleBatch;
+    int32_t nbThreads;
+    int32_t modeApprentissage;
+} MetaExpert;
+
+// enregistre les experts (et les noms du dataset) dans Perceptron/<file>.
+int sauvegarderModele(Perceptron **experts, int nbExperts, const DataSet *ds, const char *file) {
+    return sauvegarderModelePrecision(experts, nbExperts, ds, file, PRECISION_DOUBLE);
+}
+
+int sauvegarderModelePrecision(Perceptron **experts, int nbExperts, const DataSet *ds, const char *file,
+                               int precision) {
+    if (nbExperts <= 0 || experts == NULL || experts[0] == NULL) {
+        printf("Erreur : aucun modele a sauvegarder\n");
+        return 0;
+    }
+    if (precision < PRECISION_DOUBLE || precision > PRECISION_INT8) {
+        printf("Erreur : precision inconnue\n");
+        return 0;
+    }
+    char chemin[512];
+    snprintf(chemin, sizeof(chemin), "Perceptron/%s", file);
+    FILE *f = fopen(chemin, "wb");
+    if (f == NULL) {
+        printf("Erreur lors de la création du fichier de sauvegarde\n");
+        return 0;
+    }
+    const int d = experts[0]->nPoids;
+    const int avecNoms = ds != NULL && ds->nomColonne != NULL && ds->nbColonne == d;
+    EnteteModele e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.magie, MAGIE_MODELE, sizeof(MAGIE_MODELE));
+    e.version = VERSION_MODELE;
+    e.ordreOctets = ORDRE_OCTETS_MODELE;
+    e.nbExperts = (uint32_t)nbExperts;
+    e.nPoids = (uint32_t)d;
+    e.stride = (uint32_t)calculerStride(d);
+    e.nbNomsColonnes = avecNoms ? (uint32_t)d : 0;
+    e.nbClasses = ds != NULL ? (uint32_t)ds->nomsClasses.nb : 0;
+    e.offsetMeta = sizeof(EnteteModele);
+    e.offsetNoms = e.offsetMeta + sizeof(MetaExpert) * e.nbExperts;
+    uint64_t tailleNoms = 0;
+    for (uint32_t j = 0; j < e.nbNomsColonnes; j++) tailleNoms += sizeof(uint32_t) + strlen(ds->nomColonne[j]);
+    for (uint32_t c = 0; c < e.nbClasses; c++) tailleNoms += sizeof(uint32_t) + strlen(ds->nomsClasses.noms[c]);
+    const int normalise = ds != NULL && ds->normalisation.type != NORMALISATION_AUCUNE &&
+                          ds->normalisation.nbColonne == d;
+    uint64_t finNoms = e.offsetNoms + tailleNoms;
+    if (normalise) {
+        e.typeNormalisation = (uint32_t)ds->normalisation.type;
+        e.offsetNormalisation = aligner64(finNoms);
+        e.offsetPoids = aligner64(e.offsetNormalisation + 2 * (uint64_t)d * sizeof(double));
+    } else {
+        e.offsetPoids = aligner64(finNoms);
+    }
+    e.tailleFichier = e.offsetPoids + (uint64_t)e.nbExperts * e.stride * sizeof(double);
+    void *compact = NULL;
+    size_t tailleCompact = 0;
+    if (precision != PRECISION_DOUBLE) {
+        int strideCompact;
+        tailleCompact = tailleBlocCompact(nbExperts, d, precision, &strideCompact);
+        compact = aligned_alloc(64, tailleCompact);
+        remplirBlocCompact(compact, experts, nbExperts, precision);
+        e.precision = (uint32_t)precision;
+        e.strideCompact = (uint32_t)strideCompact;
+        e.offsetCompact = aligner64(e.tailleFichier);
+        e.tailleFichier = e.offsetCompact + tailleCompact;
+    }
+
+    uint64_t position = 0;
+    fwrite(&e, sizeof(e), 1, f);
+    position += sizeof(e);
+    for (int k = 0; k < nbExperts; k++) {
+        MetaExpert m;
+        memset(&m, 0, sizeof(m));
+        m.biais = experts[k]->biais;
+        m.pasApprentissage = experts[k]->pasApprentissage;
+        m.accuracy = experts[k]->accuracy;
+        m.epoque = experts[k]->epoque;
+        m.tailleBatch = experts[k]->tailleBatch;
+        m.nbThreads = experts[k]->nbThreads;
+        m.modeApprentissage = experts[k]->modeApprentissage;
+        fwrite(&m, sizeof(m), 1, f);
+        position += sizeof(m);
+    }
+    for (uint32_t j = 0; j < e.nbNomsColonnes; j++) position += ecrireChaine(f, ds->nomColonne[j]);
+    for (uint32_t c = 0; c < e.nbClasses; c++) position += ecrireChaine(f, ds->nomsClasses.noms[c]);
+    if (normalise) {
+        completerJusqua(f, &position, e.offsetNormalisation);
+        fwrite(ds->normalisation.decalage, sizeof(double), (size_t)d, f);
+        fwrite(ds->normalisation.echelle, sizeof(double), (size_t)d, f);
+        position += 2 * (uint64_t)d * sizeof(double);
+    }
+    completerJusqua(f, &position, e.offsetPoids);
+    static const double zeros[64] = {0};
+    for (int k = 0; k < nbExperts; k++) {
+        fwrite(experts[k]->poids, sizeof(double), (size_t)d, f);
+        fwrite(zeros, sizeof(double), e.stride - e.nPoids, f);
+        position += (uint64_t)e.stride * sizeof(double);
+    }
+    if (compact) {
+        completerJusqua(f, &position, e.offsetCompact);
+        fwrite(compact, 1, tailleCompact, f);
+        free(compact);
+    }
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) printf("Erreur : ecriture incomplete de %s\n", chemin);
+    return ok;
+}
+
+// lit une chaine du bloc des noms en vérifiant les bornes, dans une copie terminée par \0.
+static char *lireNom(const char **p, const char *fin) {
+    uint32_t n;
+    const char *debut = lireChaine(p, fin, &n);
+    if (debut == NULL) return NULL;
+    char *s = malloc((size_t)n + 1);
+    memcpy(s, debut, n);
+    s[n] = '\0';
+    return s;
+}
+
+// vérifie l'entete avant de construire les experts : les blocs dans l'ordre du format
+// (meta, noms, normalisation, poids, compact), chacun aligné et dans le fichier.
+static int validerEnteteModele(const EnteteModele *e, size_t taille) {
+    const uint64_t tailleEntete = e->version == 1 ? TAILLE_ENTETE_V1 : sizeof(EnteteModele);
+    if ((e->version != 1 && e->version != VERSION_MODELE) || e->ordreOctets != ORDRE_OCTETS_MODELE ||
+        e->tailleFichier > taille || e->nbExperts == 0 || e->nbExperts > INT32_MAX || e->nPoids > INT32_MAX ||
+        e->stride < e->nPoids || e->stride > (uint64_t)e->nPoids + 64 ||
+        e->typeNormalisation > NORMALISATION_MINMAX || e->precision > PRECISION_INT8 ||
+        (e->nbNomsColonnes != 0 && e->nbNomsColonnes != e->nPoids))
+        return 0;
+    if (e->offsetMeta < tailleEntete || !tableauDansFichier(e->offsetMeta, e->nbExperts, sizeof(MetaExpert), taille) ||
+        e->offsetNoms < e->offsetMeta + (uint64_t)e->nbExperts * sizeof(MetaExpert) || e->offsetPoids % 8 != 0)
+        return 0;
+    uint64_t finNoms = e->offsetPoids;
+    if (e->typeNormalisation != NORMALISATION_AUCUNE) {
+        if (e->offsetNormalisation % 8 != 0 || e->offsetNormalisation > e->offsetPoids ||
+            2 * (uint64_t)e->nPoids > (e->offsetPoids - e->offsetNormalisation) / sizeof(double))
+            return 0;
+        finNoms = e->offsetNormalisation;
+    }
+    if (e->offsetNoms > finNoms ||
+        !tableauDansFichier(e->offsetPoids, (uint64_t)e->nbExperts * e->stride, sizeof(double), taille))
+        return 0;
+    if (e->precision == PRECISION_DOUBLE) return 1;
+    int strideCompact = 0;
+    size_t tailleCompact = tailleBlocCompact((int)e->nbExperts, (int)e->nPoids, (int)e->precision, &strideCompact);
+    return e->strideCompact == (uint32_t)strideCompact && e->offsetCompact % 64 == 0 &&
+           e->offsetCompact >= e->offsetPoids + (uint64_t)e->nbExperts * e->stride * sizeof(double) &&
+           tableauDansFichier(e->offsetCompact, tailleCompact, 1, taille);
+}
+
+// charge un modele : une projection mémoire du fichier, aucune conversion de texte.
+// les anciens fichiers texte (biais puis poids) sont encore acceptés.
+Modele* chargerModele(const char *file) {
+    char chemin[512];
+    snprintf(chemin, sizeof(chemin), "Perceptron/%s", file);
+    int fd = open(chemin, O_RDONLY);
+    if (fd < 0) {
+        printf("Fichier introuvable\n");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t taille = (size_t)st.st_size;
+    char magie[8] = {0};
+    if (taille < sizeof(EnteteModele) || pread(fd, magie, sizeof(magie), 0) != (ssize_t)sizeof(magie) ||
+        memcmp(magie, MAGIE_MODELE, sizeof(MAGIE_MODELE)) != 0) {
+        close(fd);
+        Perceptron *ancien = chargerPerceptron(file);
+        if (ancien == NULL) return NULL;
+        Modele *m = calloc(1, sizeof(Modele));
+        m->nbExperts = 1;
+        m->nPoids = ancien->nPoids;
+        m->experts = malloc(sizeof(Perceptron *));
+        m->experts[0] = ancien;
+        return m;
+    }
+    // copie à l'écriture : un modele chargé peut etre ré-entrainé sans toucher au fichier.
+    void *base = mmap(NULL, taille, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+    const char *octets = base;
+    EnteteModele e;
+    memset(&e, 0, sizeof(e));
+    memcpy(&e, octets, TAILLE_ENTETE_V1);
+    if (e.version == VERSION_MODELE) memcpy(&e, octets, sizeof(e));
+    if (!validerEnteteModele(&e, taille)) {
+        printf("Fichier modele invalide (version %u)\n", e.version);
+        munmap(base, taille);
+        return NULL;
+    }
+    Modele *m = calloc(1, sizeof(Modele));
+    m->mmapBase = base;
+    m->mmapTaille = taille;
+    m->nbExperts = (int)e.nbExperts;
+    m->nPoids = (int)e.nPoids;
+    m->experts = malloc(sizeof(Perceptron *) * e.nbExperts);
+    for (uint32_t k = 0; k < e.nbExperts; k++) {
+        MetaExpert meta;
+        memcpy(&meta, octets + e.offsetMeta + k * sizeof(MetaExpert), sizeof(meta));
+        Perceptron *p = calloc(1, sizeof(Perceptron));
+        p->biais = meta.biais;
+        p->pasApprentissage = meta.pasApprentissage;
+        p->accuracy = meta.accuracy;
+        p->epoque = meta.epoque;
+        p->tailleBatch = meta.tailleBatch;
+        p->nbThreads = meta.nbThreads;
+        p->modeApprentissage = meta.modeApprentissage;
+        p->nPoids = (int)e.nPoids;
+        p->produit = choisirProduit(p->nPoids);
+        p->poids = (double *)(octets + e.offsetPoids + (uint64_t)k * e.stride * sizeof(double));
+        p->poidsExternes = 1;
+        m->experts[k] = p;
+    }
+    const char *p = octets + e.offsetNoms;
+    const char *finNoms = octets + e.offsetPoids;
+    if (e.typeNormalisation != NORMALISATION_AUCUNE) {
+        finNoms = octets + e.offsetNormalisation;
+        m->normalisation.type = (int)e.typeNormalisation;
+        m->normalisation.nbColonne = (int)e.nPoids;
+        m->normalisation.decalage = (double *)(octets + e.offsetNormalisation);
+        m->normalisation.echelle = m->normalisation.decalage + e.nPoids;
+    }
+    if (e.nbNomsColonnes != 0) {
+        m->nomsColonnes = calloc(e.nPoids, sizeof(char *));
+        int ok = 1;
+        for (uint32_t j = 0; j < e.nPoids && ok; j++) ok = (m->nomsColonnes[j] = lireNom(&p, finNoms)) != NULL;
+        if (!ok) {
+            printf("Fichier modele invalide : noms de colonnes tronques\n");
+            libererModele(m);
+            return NULL;
+        }
+    }
+    for (uint32_t c = 0; c < e.nbClasses; c++) {
+        char *nom = lireNom(&p, finNoms);
+        if (nom == NULL) break;
+        // un nom en double décalerait les numéros suivants : on s'arrete là.
+        int numero = ajouterLabel(&m->classes, nom);
+        free(nom);
+        if (numero != (int)c) break;
+    }
+    if (e.precision != PRECISION_DOUBLE) placerBlocCompact(m, (char *)base + e.offsetCompact, (int)e.precision);
+    return m;
+}
+
+// libere le modele, ses experts et la projection mémoire.
+void libererModele(Modele *m) {
+    if (m == NULL) return;
+    for (int k = 0; k < m->nbExperts; k++) libererPerceptron(m->experts[k]);
+    free(m->experts);
+    if (m->nomsColonnes) {
+        for (int j = 0; j < m->nPoids; j++) free(m->nomsColonnes[j]);
+        free(m->nomsColonnes);
+    }
+    libererDictionnaire(&m->classes);
+    free(m->compactAlloue);
+    if (m->mmapBase) munmap(m->mmapBase, m->mmapTaille);
+    free(m);
+}
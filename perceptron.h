@@ -4,7 +4,22 @@
 
 #ifndef PERCEPTRON_H_
 #define PERCEPTRON_H_
+#include <stdint.h>
 #include "dataSet.h"
+#include "noyau.h"
+#include "suivi.h"
+
+// regle d'apprentissage : poids de la derniere mise à jour (classique), poids de la plus
+// longue série de bonnes prédictions (pocket), ou moyenne des poids sur tous les exemples.
+#define MODE_CLASSIQUE 0
+#define MODE_POCKET 1
+#define MODE_MOYENNE 2
+
+// precision des poids pour la prédiction d'un modele chargé (voir precision.h).
+#define PRECISION_DOUBLE 0
+#define PRECISION_FLOAT 1
+#define PRECISION_INT8 2
+
 typedef struct{
     double biais;
     int epoque;
@@ -12,13 +27,51 @@ typedef struct{
     double *poids;
     double accuracy;
     double pasApprentissage;
+    // 0 ou 1 : apprentissage en ligne (mise à jour après chaque erreur).
+    // au dela : mini-batch, les mises à jour de tailleBatch lignes sont cumulées puis apliquées.
+    int tailleBatch;
+    // threads utilisés pour parcourir un mini-batch (0 = un par coeur).
+    int nbThreads;
+    // 1 si poids apartient à un autre objet (modele projeté en mémoire) : pas de free.
+    int poidsExternes;
+    // MODE_CLASSIQUE, MODE_POCKET ou MODE_MOYENNE (appliqué à chaque entrainement).
+    int modeApprentissage;
+    // produit scalaire choisi pour nPoids à la création ou au chargement (version déroulée
+    // pour 2, 4, 8 ou 16 colones, sinon la variante simd) : predire ne teste plus rien.
+    FonctionProduit produit;
 } Perceptron;
 
+// modele complet tel qu'il est sauvegardé : nbExperts perceptrons (1 en binaire,
+// K en one-vs-all) plus les métadonnées utiles pour prédire sur de nouvelles données.
+typedef struct {
+    int nbExperts;
+    int nPoids;
+    Perceptron **experts;
+    DictionnaireLabels classes;
+    char **nomsColonnes;
+    // normalisation à apliquer aux données avant de prédire (décalages et échelles
+    // dans le fichier projeté).
+    Normalisation normalisation;
+    // fichier projeté en mémoire : les poids des experts pointent dedans.
+    void *mmapBase;
+    size_t mmapTaille;
+    // inférence compacte : en PRECISION_FLOAT / _INT8, matrice nbExperts x strideCompact
+    // (dans le fichier, ou dans compactAlloue si elle a été calculée au chargement).
+    // en int8 le poids réel vaut poidsInt8 * echelles[expert].
+    int precision;
+    int strideCompact;
+    float *poidsFloat;
+    int8_t *poidsInt8;
+    float *echelles;
+    void *compactAlloue;
+} Modele;
+
 
 Perceptron* createPerceptron(int n, int epoch);
 
 int fonctionActivation(double somme);
 void entrainerMultiClasse(Perceptron **perceptrons, int nbLabel, const DataSet *ds);
+void entrainerMultiClasseParallele(Perceptron **perceptrons, int nbLabel, const DataSet *ds, int nbThreads);
 double predireProba(Perceptron *p , const double *entree);
 int predireMulti(Perceptron **experts, int nbClasses, const double *entree);
 
@@ -26,15 +79,52 @@ double somme(const DataSet *data,const Perceptron *p , int n, int j);
 
 void entrainerPerceptron(const DataSet *dataTrain , Perceptron *p);
 
+// entrainement avec controle de la convergence (patience, validation, budget de temps)
+// et historique des erreurs par époque dans suivi (voir suivi.h).
+void entrainerPerceptronSuivi(const DataSet *dataTrain, Perceptron *p, SuiviEntrainement *suivi);
+// one-vs-all suivi sur nbThreads (0 = un par coeur). suivi NULL : meme chose que
+// entrainerMultiClasse / entrainerMultiClasseParallele.
+void entrainerMultiClasseSuivi(Perceptron **perceptrons, int nbLabel, const DataSet *ds, int nbThreads,
+                               SuiviEntrainement *suivi);
+
 int predire(Perceptron *p , const double *entree);
+// ligne creuse : nnz valeurs non nulles et leurs colones (voir MatriceCreuse).
+int predireCreux(const Perceptron *p, const int *colonnes, const double *valeurs, int nnz);
 
-double accuracy(Perceptron *p , const DataSet *dataTeste);
+double accuracy(Perceptron *p , DataSet *dataTeste);
+double accuracyMulti(Perceptron **experts, int nbClasses, DataSet *dataTeste);
+
+// prédictions sur n lignes d'un coup. la ligne i est lignes + index[i] * stride
+// (ou lignes + i * stride si index est NULL). au dela de quelques milliers de
+// lignes le travail est réparti sur plusieurs threads.
+void predireBatch(const Perceptron *p, const double *lignes, int stride, const int *index, int n, int *sortie);
+void predireProbaBatch(const Perceptron *p, const double *lignes, int stride, const int *index, int n,
+                       double *sortie);
+void predireMultiBatch(Perceptron **experts, int nbClasses, const double *lignes, int stride, const int *index,
+                       int n, int *sortie);
+// les memes sur les lignes d'un dataset dense ou creux (index comme ci-dessus) :
+// predireBatch avec un seul expert, sinon predireMultiBatch.
+void predireDataSet(Perceptron **experts, int nbExperts, const DataSet *ds, const int *index, int n, int *sortie);
 
 Perceptron* chargerPerceptron(const char *file);
 
 void libererPerceptron(Perceptron *p);
 
-void sauvegarderPerceptron(const Perceptron *p , const char *file);
+// ancien format texte (biais puis poids), obsolète : préférer sauvegarderModele.
+void sauvegarderPerceptron(const Perceptron *p , const char *file)
+    __attribute__((deprecated("utiliser sauvegarderModele")));
+
+// format binaire : matrice K x d des poids + hyperparametres, noms des classes et des colones,
+// et la normalisation de ds. ds peut etre NULL (ni noms ni normalisation).
+int sauvegarderModele(Perceptron **experts, int nbExperts, const DataSet *ds, const char *file);
+// meme chose avec en plus les poids en float ou en int8 (échelles par expert calculées ici),
+// que le chargement utilisera pour prédire.
+int sauvegarderModelePrecision(Perceptron **experts, int nbExperts, const DataSet *ds, const char *file,
+                               int precision);
+// charge un modele binaire par mmap (ou un ancien fichier texte de sauvegarderPerceptron),
+// dans la precision enregistrée.
+Modele* chargerModele(const char *file);
+void libererModele(Modele *m);
 void listerFichiersPerceptron() ;
 
 #endif //PERCEPTRON_H_
@@ -0,0 +1,224 @@
+#include "precision.h"
+#include "noyau.h"
+#include "parallele.h"
+#include "binaire.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// en dessous de ce nombre de lignes, un seul thread suffit (comme predireBatch).
+#define SEUIL_PARALLELE 16384
+// lignes converties ensemble par un thread, avant de passer les experts sur le lot.
+#define TAILLE_LOT 256
+
+const char *nomPrecision(int precision) {
+    if (precision == PRECISION_FLOAT) return "float";
+    if (precision == PRECISION_INT8) return "int8";
+    return "double";
+}
+
+int precisionDepuisNom(const char *nom) {
+    if (strcmp(nom, "double") == 0) return PRECISION_DOUBLE;
+    if (strcmp(nom, "float") == 0) return PRECISION_FLOAT;
+    if (strcmp(nom, "int8") == 0) return PRECISION_INT8;
+    return -1;
+}
+
+float quantifierInt8(const double *x, int n, int8_t *q) {
+    return choisirQuantifierInt8()(x, n, q);
+}
+
+size_t tailleBlocCompact(int nbExperts, int d, int precision, int *strideCompact) {
+    if (precision == PRECISION_FLOAT) {
+        *strideCompact = (d + 15) & ~15;
+        return aligner64(sizeof(float) * (size_t)nbExperts * (size_t)*strideCompact);
+    }
+    if (precision == PRECISION_INT8) {
+        *strideCompact = (d + 63) & ~63;
+        return aligner64(sizeof(float) * (size_t)nbExperts) + (size_t)nbExperts * (size_t)*strideCompact;
+    }
+    *strideCompact = 0;
+    return 0;
+}
+
+static void decouperBloc(void *bloc, int nbExperts, int precision, float **poidsFloat, int8_t **poidsInt8,
+                         float **echelles) {
+    *poidsFloat = NULL;
+    *poidsInt8 = NULL;
+    *echelles = NULL;
+    if (precision == PRECISION_FLOAT) {
+        *poidsFloat = bloc;
+    } else if (precision == PRECISION_INT8) {
+        *echelles = bloc;
+        *poidsInt8 = (int8_t *)bloc + aligner64(sizeof(float) * (size_t)nbExperts);
+    }
+}
+
+void remplirBlocCompact(void *bloc, Perceptron *const *experts, int nbExperts, int precision) {
+    const int d = experts[0]->nPoids;
+    int stride;
+    memset(bloc, 0, tailleBlocCompact(nbExperts, d, precision, &stride));
+    float *poidsFloat, *echelles;
+    int8_t *poidsInt8;
+    decouperBloc(bloc, nbExperts, precision, &poidsFloat, &poidsInt8, &echelles);
+    for (int k = 0; k < nbExperts; k++) {
+        const double *w = experts[k]->poids;
+        if (poidsFloat) {
+            float *f = poidsFloat + (size_t)k * stride;
+            for (int j = 0; j < d; j++) f[j] = (float)w[j];
+        } else if (poidsInt8) {
+            echelles[k] = quantifierInt8(w, d, poidsInt8 + (size_t)k * stride);
+        }
+    }
+}
+
+void placerBlocCompact(Modele *m, void *bloc, int precision) {
+    tailleBlocCompact(m->nbExperts, m->nPoids, precision, &m->strideCompact);
+    decouperBloc(bloc, m->nbExperts, precision, &m->poidsFloat, &m->poidsInt8, &m->echelles);
+    m->precision = precision;
+}
+
+int choisirPrecisionModele(Modele *m, int precision) {
+    if (precision < PRECISION_DOUBLE || precision > PRECISION_INT8) return 0;
+    if (precision == m->precision) return 1;
+    free(m->compactAlloue);
+    m->compactAlloue = NULL;
+    if (precision == PRECISION_DOUBLE) {
+        placerBlocCompact(m, NULL, PRECISION_DOUBLE);
+        return 1;
+    }
+    int stride;
+    size_t taille = tailleBlocCompact(m->nbExperts, m->nPoids, precision, &stride);
+    m->compactAlloue = aligned_alloc(64, taille);
+    if (m->compactAlloue == NULL) {
+        printf("Erreur : memoire insuffisante pour les poids %s\n", nomPrecision(precision));
+        exit(1);
+    }
+    remplirBlocCompact(m->compactAlloue, m->experts, m->nbExperts, precision);
+    placerBlocCompact(m, m->compactAlloue, precision);
+    return 1;
+}
+
+typedef struct {
+    const Modele *m;
+    const DataSet *ds;
+    const int *index;
+    int *sortie;
+    FonctionProduit4Float produitFloat;   // résolus une fois par apel
+    FonctionProduit4Int8 produitInt8;
+    FonctionConversionFloat convertir;
+    FonctionQuantifier quantifier;
+} ContexteCompact;
+
+// sommes entieres de 4 lignes par tranches de TRANCHE_INT8 (aucune voie ne déborde).
+static void produit4Int8(FonctionProduit4Int8 f, const int8_t *w, const int8_t *const lignes[4], int n,
+                         int64_t sortie[4]) {
+    for (int r = 0; r < 4; r++) sortie[r] = 0;
+    for (int i = 0; i < n; i += TRANCHE_INT8) {
+        int taille = n - i < TRANCHE_INT8 ? n - i : TRANCHE_INT8;
+        const int8_t *tranche[4] = { lignes[0] + i, lignes[1] + i, lignes[2] + i, lignes[3] + i };
+        int32_t partiel[4];
+        f(w + i, tranche, taille, partiel);
+        for (int r = 0; r < 4; r++) sortie[r] += partiel[r];
+    }
+}
+
+// scores d'un expert sur les lignes converties du lot, par paquets de 4 : les poids ne sont
+// chargés qu'une fois par paquet. le dernier paquet répète sa derniere ligne.
+static void scoresCompact(const ContexteCompact *c, int k, const void *tampon, const float *echellesLignes,
+                          int taille, double *scores) {
+    const Modele *m = c->m;
+    const size_t stride = (size_t)m->strideCompact;
+    for (int i = 0; i < taille; i += 4) {
+        int r4[4];
+        for (int r = 0; r < 4; r++) r4[r] = i + r < taille ? i + r : taille - 1;
+        int nb = taille - i < 4 ? taille - i : 4;
+        if (m->precision == PRECISION_FLOAT) {
+            const float *lignes = tampon;
+            const float *bloc[4] = { lignes + r4[0] * stride, lignes + r4[1] * stride, lignes + r4[2] * stride,
+                                     lignes + r4[3] * stride };
+            float s[4];
+            c->produitFloat(m->poidsFloat + (size_t)k * stride, bloc, m->nPoids, s);
+            for (int r = 0; r < nb; r++) scores[i + r] = s[r];
+        } else {
+            const int8_t *lignes = tampon;
+            const int8_t *bloc[4] = { lignes + r4[0] * stride, lignes + r4[1] * stride, lignes + r4[2] * stride,
+                                      lignes + r4[3] * stride };
+            int64_t s[4];
+            produit4Int8(c->produitInt8, m->poidsInt8 + (size_t)k * stride, bloc, m->nPoids, s);
+            for (int r = 0; r < nb; r++) {
+                scores[i + r] = (double)s[r] * ((double)m->echelles[k] * echellesLignes[i + r]);
+            }
+        }
+    }
+    for (int r = 0; r < taille; r++) scores[r] += m->experts[k]->biais;
+}
+
+static const double *ligneCompact(const ContexteCompact *c, int i) {
+    return ligneData(c->ds, c->index ? c->index[i] : i);
+}
+
+// la conversion lit chaque ligne une seule fois et travaille aussitôt dessus : on demande
+// la suivante au cache pendant ce temps (utile surtout quand index mélange les lignes).
+static void prechargerLigne(const double *ligne, int d) {
+    const char *octets = (const char *)ligne;
+    for (size_t o = 0; o < sizeof(double) * (size_t)d; o += 64) __builtin_prefetch(octets + o);
+}
+
+// meme décision que predireMulti : seuil à 0 pour un seul expert, sinon la premiere clase
+// au score maximal.
+static void tacheCompact(void *arg, int debut, int fin) {
+    const ContexteCompact *c = arg;
+    const Modele *m = c->m;
+    const int d = m->nPoids;
+    const size_t stride = (size_t)m->strideCompact;
+    const size_t octetsLigne = m->precision == PRECISION_FLOAT ? sizeof(float) * stride : stride;
+    // lignes converties du lot, réutilisées pour toutes les lignes de la tache.
+    void *tampon = aligned_alloc(64, aligner64(octetsLigne * TAILLE_LOT));
+    if (tampon == NULL) {
+        printf("Erreur : memoire insuffisante pour la prediction %s\n", nomPrecision(m->precision));
+        exit(1);
+    }
+    float echellesLignes[TAILLE_LOT];
+    double scores[TAILLE_LOT];
+    double meilleure[TAILLE_LOT];
+    for (int l = debut; l < fin; l += TAILLE_LOT) {
+        int taille = fin - l < TAILLE_LOT ? fin - l : TAILLE_LOT;
+        for (int r = 0; r < taille; r++) {
+            const double *ligne = ligneCompact(c, l + r);
+            if (l + r + 1 < fin) prechargerLigne(ligneCompact(c, l + r + 1), d);
+            if (m->precision == PRECISION_FLOAT) {
+                c->convertir(ligne, d, (float *)tampon + (size_t)r * stride);
+            } else {
+                echellesLignes[r] = c->quantifier(ligne, d, (int8_t *)tampon + (size_t)r * stride);
+            }
+        }
+        if (m->nbExperts == 1) {
+            scoresCompact(c, 0, tampon, echellesLignes, taille, scores);
+            for (int r = 0; r < taille; r++) c->sortie[l + r] = fonctionActivation(scores[r]);
+            continue;
+        }
+        scoresCompact(c, 0, tampon, echellesLignes, taille, meilleure);
+        for (int r = 0; r < taille; r++) c->sortie[l + r] = 0;
+        for (int k = 1; k < m->nbExperts; k++) {
+            scoresCompact(c, k, tampon, echellesLignes, taille, scores);
+            for (int r = 0; r < taille; r++) {
+                if (scores[r] > meilleure[r]) {
+                    meilleure[r] = scores[r];
+                    c->sortie[l + r] = k;
+                }
+            }
+        }
+    }
+    free(tampon);
+}
+
+void predireModele(const Modele *m, const DataSet *ds, const int *index, int n, int *sortie) {
+    if (m->precision == PRECISION_DOUBLE || ds->creux) {
+        predireDataSet(m->experts, m->nbExperts, ds, index, n, sortie);
+        return;
+    }
+    ContexteCompact c = { m, ds, index, sortie, choisirProduit4Float(), choisirProduit4Int8(),
+                          choisirConversionFloat(), choisirQuantifierInt8() };
+    executerParallele(0, n, SEUIL_PARALLELE, tacheCompact, &c);
+}
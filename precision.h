@@ -0,0 +1,38 @@
+#ifndef PRECISION_H_
+#define PRECISION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dataSet.h"
+#include "perceptron.h"
+
+// "double", "float" ou "int8".
+const char *nomPrecision(int precision);
+// precision corespondant à un nom, -1 si inconnu.
+int precisionDepuisNom(const char *nom);
+
+// quantification symétrique : q[j] = arrondi(x[j] / echelle) dans [-127, 127], avec
+// echelle = max |x| / 127 (1 pour un vecteur nul). retourne l'échelle.
+float quantifierInt8(const double *x, int n, int8_t *q);
+
+// poids compacts de nbExperts experts à d poids, tels qu'ils sont rangés dans un fichier
+// modele : en int8, les échelles des experts puis la matrice ; en float, la matrice seule.
+// retourne la taille du bloc en octets et le pas (en éléments) entre deux experts.
+size_t tailleBlocCompact(int nbExperts, int d, int precision, int *strideCompact);
+// remplit bloc (tailleBlocCompact octets, aligné sur 64) à partir des poids double.
+void remplirBlocCompact(void *bloc, Perceptron *const *experts, int nbExperts, int precision);
+// raccorde les pointeurs poidsFloat / poidsInt8 / echelles du modele à un bloc.
+void placerBlocCompact(Modele *m, void *bloc, int precision);
+
+// passe le modele en inférence double, float ou int8. les poids compacts sont recalculés à
+// partir des poids double si le fichier ne les contient pas déjà. retourne 0 si inconnu.
+int choisirPrecisionModele(Modele *m, int precision);
+
+// classe prédite (meme règle que predireBatch / predireMultiBatch) pour n lignes du dataset
+// (ligne i = index[i], ou i si index est NULL), dans la precision du modele. les lignes sont
+// converties une fois par lots puis partagées par tous les experts (4 lignes par chargement
+// des poids) ; en int8 chacune est quantifiée avec sa propre échelle. un dataset creux passe
+// toujours en double.
+void predireModele(const Modele *m, const DataSet *ds, const int *index, int n, int *sortie);
+
+#endif //PRECISION_H_
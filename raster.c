@@ -0,0 +1,204 @@
+#include "raster.h"
+#include "noyau.h"
+#include "parallele.h"
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// en dessous de ce nombre de lignes de pixels, le rendu reste sur le thread apelant.
+#define SEUIL_LIGNES_PARALLELE 64
+// meme chose pour la prédiction des points du nuage.
+#define SEUIL_POINTS_PARALLELE 16384
+
+typedef struct {
+    ImageDecision *img;
+    int nbExperts;
+    // constante, pente x et pente y de chaque expert (3 tableaux de nbExperts).
+    const double *c;
+    const double *bx;
+    const double *by;
+} ContexteRaster;
+
+typedef struct {
+    int nbExperts;
+    const double *c;
+    const double *bx;
+    const double *by;
+    int colX, colY;
+    const DataSet *ds;
+    const int *index;
+    int *sortie;
+} ContextePoints;
+
+ImageDecision *creerImageDecision(int largeur, int hauteur) {
+    if (largeur <= 0 || hauteur <= 0) return NULL;
+    ImageDecision *img = calloc(1, sizeof(ImageDecision));
+    if (!img) return NULL;
+    img->largeur = largeur;
+    img->hauteur = hauteur;
+    size_t nbPixels = (size_t)largeur * (size_t)hauteur;
+    img->labels = malloc(sizeof(int) * nbPixels);
+    img->scores = malloc(sizeof(double) * nbPixels);
+    img->xs = malloc(sizeof(double) * (size_t)largeur);
+    if (!img->labels || !img->scores || !img->xs) {
+        libererImageDecision(img);
+        return NULL;
+    }
+    return img;
+}
+
+void libererImageDecision(ImageDecision *img) {
+    if (!img) return;
+    free(img->labels);
+    free(img->scores);
+    free(img->xs);
+    free(img->coefs);
+    free(img);
+}
+
+void cadrerDecision(const DataSet *ds, int colX, int colY, double *centre,
+                    double *minX, double *maxX, double *minY, double *maxY) {
+    int n = ds->indexSplit ? ds->nTrain : ds->n;
+    *minX = DBL_MAX;
+    *maxX = -DBL_MAX;
+    *minY = DBL_MAX;
+    *maxY = -DBL_MAX;
+    for (int j = 0; j < ds->nbColonne; j++) centre[j] = 0;
+
+    for (int i = 0; i < n; i++) {
+        const double *ligne = ds->indexSplit ? ligneTrain(ds, i) : ligneData(ds, i);
+        for (int j = 0; j < ds->nbColonne; j++) centre[j] += ligne[j];
+        if (ligne[colX] < *minX) *minX = ligne[colX];
+        if (ligne[colX] > *maxX) *maxX = ligne[colX];
+        if (ligne[colY] < *minY) *minY = ligne[colY];
+        if (ligne[colY] > *maxY) *maxY = ligne[colY];
+    }
+    for (int j = 0; j < ds->nbColonne; j++) centre[j] /= n;
+
+    // Ajout d'une marge de 15%
+    double spanX = *maxX - *minX;
+    double spanY = *maxY - *minY;
+    *minX -= spanX * 0.15;
+    *maxX += spanX * 0.15;
+    *minY -= spanY * 0.15;
+    *maxY += spanY * 0.15;
+}
+
+// la partie du score qui ne dépend ni de x ni de y est calculée une fois par expert.
+// coefs : constantes, puis pentes en x, puis pentes en y (3 x nbExperts).
+static void calculerCoefs(Perceptron *const *experts, int nbExperts, int colX, int colY, const double *centre,
+                          double *coefs) {
+    for (int k = 0; k < nbExperts; k++) {
+        const Perceptron *p = experts[k];
+        double reste = p->biais;
+        for (int j = 0; j < p->nPoids; j++) {
+            if (j != colX && j != colY) reste += p->poids[j] * centre[j];
+        }
+        coefs[k] = reste;
+        coefs[nbExperts + k] = p->poids[colX];
+        coefs[2 * nbExperts + k] = p->poids[colY];
+    }
+}
+
+// lignes de pixels [debut, fin) : a[k] = constante + pente y * y, puis le noyau fait la ligne.
+static void tacheLignes(void *ctx, int debut, int fin) {
+    ContexteRaster *c = ctx;
+    ImageDecision *img = c->img;
+    double aPile[32];
+    double *a = c->nbExperts <= 32 ? aPile : malloc(sizeof(double) * (size_t)c->nbExperts);
+    for (int py = debut; py < fin; py++) {
+        double y = img->maxY - (img->maxY - img->minY) * py / img->hauteur;
+        for (int k = 0; k < c->nbExperts; k++) a[k] = c->c[k] + c->by[k] * y;
+        size_t decalage = (size_t)py * (size_t)img->largeur;
+        ligneDecision(img->xs, img->largeur, a, c->bx, c->nbExperts, img->labels + decalage,
+                      img->scores + decalage);
+    }
+    if (a != aPile) free(a);
+}
+
+void rasteriserDecision(ImageDecision *img, Perceptron *const *experts, int nbExperts, int colX, int colY,
+                        const double *centre, double minX, double maxX, double minY, double maxY, int nbThreads) {
+    if (!img || nbExperts <= 0) return;
+    img->minX = minX;
+    img->maxX = maxX;
+    img->minY = minY;
+    img->maxY = maxY;
+    if (img->capaciteCoefs < nbExperts) {
+        free(img->coefs);
+        img->coefs = malloc(sizeof(double) * 3 * (size_t)nbExperts);
+        img->capaciteCoefs = nbExperts;
+    }
+
+    ContexteRaster c = { img, nbExperts, img->coefs, img->coefs + nbExperts, img->coefs + 2 * nbExperts };
+    calculerCoefs(experts, nbExperts, colX, colY, centre, img->coefs);
+    for (int px = 0; px < img->largeur; px++) img->xs[px] = minX + (maxX - minX) * px / img->largeur;
+
+    executerParallele(nbThreads, img->hauteur, SEUIL_LIGNES_PARALLELE, tacheLignes, &c);
+}
+
+// points [debut, fin) : meme règle que le noyau de ligne (binaire : score >= 0,
+// sinon premiere classe au score maximal).
+static void tachePoints(void *ctx, int debut, int fin) {
+    ContextePoints *c = ctx;
+    for (int i = debut; i < fin; i++) {
+        const double *ligne = ligneData(c->ds, c->index ? c->index[i] : i);
+        double x = ligne[c->colX], y = ligne[c->colY];
+        double meilleur = (c->c[0] + c->by[0] * y) + c->bx[0] * x;
+        int label = c->nbExperts == 1 ? meilleur >= 0 : 0;
+        for (int k = 1; k < c->nbExperts; k++) {
+            double s = (c->c[k] + c->by[k] * y) + c->bx[k] * x;
+            if (s > meilleur) {
+                meilleur = s;
+                label = k;
+            }
+        }
+        c->sortie[i] = label;
+    }
+}
+
+void predireProjection(Perceptron *const *experts, int nbExperts, int colX, int colY, const double *centre,
+                       const DataSet *ds, const int *index, int n, int *sortie) {
+    if (nbExperts <= 0 || n <= 0) return;
+    double *coefs = malloc(sizeof(double) * 3 * (size_t)nbExperts);
+    calculerCoefs(experts, nbExperts, colX, colY, centre, coefs);
+    ContextePoints c = { nbExperts, coefs, coefs + nbExperts, coefs + 2 * nbExperts, colX, colY, ds, index, sortie };
+    executerParallele(0, n, SEUIL_POINTS_PARALLELE, tachePoints, &c);
+    free(coefs);
+}
+
+// palette de raylib (RED, BLUE, GREEN, ORANGE, PURPLE, BROWN) à 70/255 d'opacité sur RAYWHITE.
+void couleurZone(int c, unsigned char rgb[3]) {
+    static const unsigned char palette[6][3] = {
+        { 230, 41, 55 }, { 0, 121, 241 }, { 0, 228, 48 },
+        { 255, 161, 0 }, { 200, 122, 255 }, { 127, 106, 79 },
+    };
+    const unsigned char *base = palette[((c % 6) + 6) % 6];
+    for (int i = 0; i < 3; i++) rgb[i] = (unsigned char)((base[i] * 70 + 245 * (255 - 70)) / 255);
+}
+
+int exporterPPM(const ImageDecision *img, const char *chemin) {
+    FILE *f = fopen(chemin, "wb");
+    if (!f) {
+        printf("Erreur : impossible de creer %s\n", chemin);
+        return 0;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", img->largeur, img->hauteur);
+    unsigned char *ligne = malloc(3 * (size_t)img->largeur);
+    for (int py = 0; py < img->hauteur; py++) {
+        const int *labels = img->labels + (size_t)py * (size_t)img->largeur;
+        for (int px = 0; px < img->largeur; px++) {
+            int l = labels[px];
+            // frontiere : le voisin de droite ou du dessous n'a pas la meme classe.
+            int bord = (px + 1 < img->largeur && labels[px + 1] != l) ||
+                       (py + 1 < img->hauteur && labels[px + img->largeur] != l);
+            unsigned char *rgb = ligne + 3 * px;
+            if (bord) rgb[0] = rgb[1] = rgb[2] = 0;
+            else couleurZone(l, rgb);
+        }
+        fwrite(ligne, 3, (size_t)img->largeur, f);
+    }
+    free(ligne);
+    int ok = fclose(f) == 0;
+    if (!ok) printf("Erreur : ecriture incomplete de %s\n", chemin);
+    return ok;
+}
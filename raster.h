@@ -0,0 +1,49 @@
+#ifndef RASTER_H_
+#define RASTER_H_
+
+#include "dataSet.h"
+#include "perceptron.h"
+
+// image des zones de décision d'un modele projeté sur deux colones.
+// le pixel (px, py) corespond à x = minX + (maxX - minX) * px / largeur
+// et y = maxY - (maxY - minY) * py / hauteur ; les autres colones valent centre.
+typedef struct {
+    int largeur;
+    int hauteur;
+    double minX, maxX, minY, maxY;
+    // largeur * hauteur, ligne par ligne : classe prédite et score gagnant.
+    int *labels;
+    double *scores;
+    // tampons réutilisés d'un rendu à l'autre : x de chaque colone de pixels,
+    // et 3 coeficients par expert (constante, pente en x, pente en y).
+    double *xs;
+    double *coefs;
+    int capaciteCoefs;
+} ImageDecision;
+
+ImageDecision *creerImageDecision(int largeur, int hauteur);
+void libererImageDecision(ImageDecision *img);
+
+// centre de masse et bornes (avec 15% de marge) des colones colX / colY,
+// sur le train si le dataset est splitté, sinon sur toutes les lignes.
+void cadrerDecision(const DataSet *ds, int colX, int colY, double *centre,
+                    double *minX, double *maxX, double *minY, double *maxY);
+
+// remplit l'image : le score est affine en x et y, donc chaque ligne de pixels se réduit
+// à a[k] + b[k] * x (simd sur les pixels, threads sur les lignes). 1 expert = binaire,
+// sinon la classe au plus grand score l'emporte. nbThreads 0 = un par coeur.
+void rasteriserDecision(ImageDecision *img, Perceptron *const *experts, int nbExperts, int colX, int colY,
+                        const double *centre, double minX, double maxX, double minY, double maxY, int nbThreads);
+
+// classe prédite pour n lignes du dataset (ligne i = index[i], ou i si index est NULL)
+// vues dans la meme projection que l'image : colX / colY réels, autres colones = centre.
+void predireProjection(Perceptron *const *experts, int nbExperts, int colX, int colY, const double *centre,
+                       const DataSet *ds, const int *index, int n, int *sortie);
+
+// couleur claire (fond de zone) de la classe c, en rgb.
+void couleurZone(int c, unsigned char rgb[3]);
+
+// exporte l'image en ppm binaire (P6), frontieres en noir. retourne 1 si ok.
+int exporterPPM(const ImageDecision *img, const char *chemin);
+
+#endif //RASTER_H_
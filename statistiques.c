@@ -0,0 +1,301 @@
+#include "statistiques.h"
+#include "parallele.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// blocs de lignes : assez gros pour amortir la fusion, au plus BLOCS_MAX, et un
+// plafond sur la mémoire des acumulateurs (nbBlocs x classes x colones) quand K x d est grand.
+#define LIGNES_BLOC_MIN 4096
+#define BLOCS_MAX 64
+#define VALEURS_ACCU_MAX ((size_t)1 << 22)
+
+// moyenne et m2 (somme des carrés des écarts) de welford, par classe et par colone,
+// plus min / max par colone, sur un bloc de lignes.
+typedef struct {
+    int *effectif;
+    double *moyenne;
+    double *m2;
+    double *min;
+    double *max;
+} Accumulateur;
+
+// lignes dans l'ordre du dataset, seulement celles dont selection[i] est vrai si selection
+// n'est pas NULL, par classe ou toutes dans la classe 0.
+typedef struct {
+    const DataSet *ds;
+    const char *selection;
+    int nbClasses;
+    int parClasse;
+    int tailleBloc;
+    Accumulateur *blocs;
+} ContexteBlocs;
+
+typedef struct {
+    const DataSet *ds;
+    StatColonne *colonnes;
+} ContexteQuantiles;
+
+static void *allouer(size_t taille) {
+    void *p = malloc(taille > 0 ? taille : 1);
+    if (!p) {
+        printf("Erreur : memoire insuffisante pour les statistiques\n");
+        exit(1);
+    }
+    return p;
+}
+
+// une ligne de plus dans les acumulateurs d'une classe (inv = 1 / son nouvel effectif).
+static inline void accumulerLigne(const double *restrict x, double *restrict moy, double *restrict m2,
+                                  double *restrict min, double *restrict max, double inv, int d) {
+    for (int j = 0; j < d; j++) {
+        double delta = x[j] - moy[j];
+        moy[j] += delta * inv;
+        m2[j] += delta * (x[j] - moy[j]);
+        min[j] = x[j] < min[j] ? x[j] : min[j];
+        max[j] = x[j] > max[j] ? x[j] : max[j];
+    }
+}
+
+static void tacheBlocs(void *ctx, int debut, int fin) {
+    ContexteBlocs *c = ctx;
+    const DataSet *ds = c->ds;
+    int d = ds->nbColonne;
+    for (int b = debut; b < fin; b++) {
+        Accumulateur *a = &c->blocs[b];
+        memset(a->effectif, 0, sizeof(int) * (size_t)c->nbClasses);
+        memset(a->moyenne, 0, sizeof(double) * (size_t)c->nbClasses * d);
+        memset(a->m2, 0, sizeof(double) * (size_t)c->nbClasses * d);
+        for (int j = 0; j < d; j++) {
+            a->min[j] = INFINITY;
+            a->max[j] = -INFINITY;
+        }
+        int premiere = b * c->tailleBloc;
+        int derniere = premiere + c->tailleBloc < ds->n ? premiere + c->tailleBloc : ds->n;
+        for (int i = premiere; i < derniere; i++) {
+            if (c->selection && !c->selection[i]) continue;
+            int classe = c->parClasse ? ds->etiquettes[i] : 0;
+            double inv = 1.0 / ++a->effectif[classe];
+            accumulerLigne(ligneData(ds, i), a->moyenne + (size_t)classe * d, a->m2 + (size_t)classe * d,
+                           a->min, a->max, inv, d);
+        }
+    }
+}
+
+// fusion de chan : (na, moyA, m2A) += (nb, moyB, m2B) sur d colones.
+static void fusionner(int na, double *moyA, double *m2A, int nb, const double *moyB, const double *m2B, int d) {
+    if (nb == 0) return;
+    if (na == 0) {
+        memcpy(moyA, moyB, sizeof(double) * (size_t)d);
+        memcpy(m2A, m2B, sizeof(double) * (size_t)d);
+        return;
+    }
+    double n = (double)na + nb;
+    for (int j = 0; j < d; j++) {
+        double delta = moyB[j] - moyA[j];
+        moyA[j] += delta * nb / n;
+        m2A[j] += m2B[j] + delta * delta * ((double)na * nb / n);
+    }
+}
+
+// parcours par blocs de lignes et fusion des blocs dans l'ordre, classe par classe.
+// le découpage ne dépend que de n, K et d. remplit total, dont les tableaux vivent dans le
+// bloc retourné (à libérer).
+static double *accumuler(const DataSet *ds, const char *selection, int K, int parClasse, int nbThreads,
+                         Accumulateur *total) {
+    int n = ds->n, d = ds->nbColonne;
+    int tailleBloc = (n + BLOCS_MAX - 1) / BLOCS_MAX;
+    if (tailleBloc < LIGNES_BLOC_MIN) tailleBloc = LIGNES_BLOC_MIN;
+    int nbBlocs = (n + tailleBloc - 1) / tailleBloc;
+    while (nbBlocs > 1 && (size_t)nbBlocs * K * d > VALEURS_ACCU_MAX) {
+        tailleBloc = tailleBloc > n / 2 ? n : tailleBloc * 2;
+        nbBlocs = (n + tailleBloc - 1) / tailleBloc;
+    }
+
+    size_t parBloc = (size_t)K * d;
+    size_t tailleAccu = 2 * parBloc + 2 * (size_t)d + ((size_t)K + 1) / 2;
+    Accumulateur *blocs = allouer(sizeof(Accumulateur) * (size_t)nbBlocs);
+    // par bloc : moyennes, m2, min, max puis les effectifs (deux int par double).
+    double *valeurs = allouer(sizeof(double) * (size_t)nbBlocs * tailleAccu);
+    for (int b = 0; b < nbBlocs; b++) {
+        double *base = valeurs + (size_t)b * tailleAccu;
+        blocs[b].moyenne = base;
+        blocs[b].m2 = base + parBloc;
+        blocs[b].min = base + 2 * parBloc;
+        blocs[b].max = base + 2 * parBloc + d;
+        blocs[b].effectif = (int *)(base + 2 * parBloc + 2 * (size_t)d);
+    }
+    ContexteBlocs cb = { ds, selection, K, parClasse, tailleBloc, blocs };
+    executerParallele(nbThreads, nbBlocs, 2, tacheBlocs, &cb);
+
+    *total = blocs[0];
+    for (int b = 1; b < nbBlocs; b++) {
+        for (int k = 0; k < K; k++) {
+            fusionner(total->effectif[k], total->moyenne + (size_t)k * d, total->m2 + (size_t)k * d,
+                      blocs[b].effectif[k], blocs[b].moyenne + (size_t)k * d, blocs[b].m2 + (size_t)k * d, d);
+            total->effectif[k] += blocs[b].effectif[k];
+        }
+        for (int j = 0; j < d; j++) {
+            if (blocs[b].min[j] < total->min[j]) total->min[j] = blocs[b].min[j];
+            if (blocs[b].max[j] > total->max[j]) total->max[j] = blocs[b].max[j];
+        }
+    }
+    free(blocs);
+    return valeurs;
+}
+
+// k-ième plus petite valeur (quickselect, pivot médiane de trois). après l'apel,
+// t[0..k) <= t[k] <= t(k..n).
+static double selectionner(double *t, int n, int k) {
+    int gauche = 0, droite = n - 1;
+    while (droite > gauche) {
+        int milieu = gauche + (droite - gauche) / 2;
+        double tmp;
+        if (t[milieu] < t[gauche]) { tmp = t[milieu]; t[milieu] = t[gauche]; t[gauche] = tmp; }
+        if (t[droite] < t[gauche]) { tmp = t[droite]; t[droite] = t[gauche]; t[gauche] = tmp; }
+        if (t[droite] < t[milieu]) { tmp = t[droite]; t[droite] = t[milieu]; t[milieu] = tmp; }
+        double pivot = t[milieu];
+        int i = gauche, j = droite;
+        while (i <= j) {
+            while (t[i] < pivot) i++;
+            while (t[j] > pivot) j--;
+            if (i <= j) {
+                tmp = t[i]; t[i] = t[j]; t[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) droite = j;
+        else if (k >= i) gauche = i;
+        else break;
+    }
+    return t[k];
+}
+
+static double minimum(const double *t, int n) {
+    double m = t[0];
+    for (int i = 1; i < n; i++) if (t[i] < m) m = t[i];
+    return m;
+}
+
+// quantile p par interpolation linéaire entre les rangs floor(h) et floor(h) + 1, h = p (n - 1).
+static double quantile(double *t, int n, double p) {
+    double h = p * (n - 1);
+    int bas = (int)h;
+    double a = selectionner(t, n, bas);
+    if (h == bas || bas + 1 >= n) return a;
+    return a + (h - bas) * (minimum(t + bas + 1, n - bas - 1) - a);
+}
+
+static void tacheQuantiles(void *ctx, int debut, int fin) {
+    ContexteQuantiles *c = ctx;
+    const DataSet *ds = c->ds;
+    int n = ds->n;
+    double *t = allouer(sizeof(double) * (size_t)n);
+    for (int j = debut; j < fin; j++) {
+        const double *col = ds->donnees + j;
+        for (int i = 0; i < n; i++) t[i] = col[(size_t)i * ds->stride];
+        StatColonne *s = &c->colonnes[j];
+        if (n % 2) {
+            s->mediane = selectionner(t, n, n / 2);
+        } else {
+            double a = selectionner(t, n, n / 2 - 1);
+            s->mediane = (a + minimum(t + n / 2, n - n / 2)) / 2;
+        }
+        s->q1 = quantile(t, n, 0.25);
+        s->q3 = quantile(t, n, 0.75);
+    }
+    free(t);
+}
+
+static void libererStatistiques(StatistiquesDataSet *s) {
+    if (!s) return;
+    free(s->colonnes);
+    free(s->effectifClasse);
+    free(s->moyenneClasse);
+    free(s->ecartTypeClasse);
+    free(s);
+}
+
+void invaliderStatistiques(DataSet *ds) {
+    libererStatistiques(ds->stats);
+    ds->stats = NULL;
+}
+
+const StatistiquesDataSet *statistiquesDataSet(DataSet *ds, int nbThreads) {
+    if (ds->stats) return ds->stats;
+    if (ds->creux) return NULL;
+    int n = ds->n, d = ds->nbColonne;
+    int K = n > 0 ? compterClasses(ds) : 0;
+
+    StatistiquesDataSet *s = allouer(sizeof(StatistiquesDataSet));
+    s->n = n;
+    s->nbColonne = d;
+    s->nbClasses = K;
+    s->colonnes = calloc((size_t)(d > 0 ? d : 1), sizeof(StatColonne));
+    s->effectifClasse = calloc((size_t)(K > 0 ? K : 1), sizeof(int));
+    s->moyenneClasse = calloc((size_t)(K > 0 ? K : 1) * (d > 0 ? d : 1), sizeof(double));
+    s->ecartTypeClasse = calloc((size_t)(K > 0 ? K : 1) * (d > 0 ? d : 1), sizeof(double));
+    if (!s->colonnes || !s->effectifClasse || !s->moyenneClasse || !s->ecartTypeClasse) {
+        printf("Erreur : memoire insuffisante pour les statistiques\n");
+        exit(1);
+    }
+    if (n == 0 || d == 0) {
+        ds->stats = s;
+        return s;
+    }
+
+    Accumulateur total;
+    double *valeurs = accumuler(ds, NULL, K, 1, nbThreads, &total);
+
+    // résumés par classe, puis colones globales en fusionnant les classes dans l'ordre.
+    double *moy = calloc((size_t)d, sizeof(double));
+    double *m2 = calloc((size_t)d, sizeof(double));
+    int effectif = 0;
+    for (int k = 0; k < K; k++) {
+        int nk = total.effectif[k];
+        s->effectifClasse[k] = nk;
+        for (int j = 0; j < d; j++) {
+            size_t idx = (size_t)k * d + j;
+            s->moyenneClasse[idx] = total.moyenne[idx];
+            s->ecartTypeClasse[idx] = nk > 0 ? sqrt(total.m2[idx] / nk) : 0;
+        }
+        fusionner(effectif, moy, m2, nk, total.moyenne + (size_t)k * d, total.m2 + (size_t)k * d, d);
+        effectif += nk;
+    }
+    for (int j = 0; j < d; j++) {
+        StatColonne *c = &s->colonnes[j];
+        c->moyenne = moy[j];
+        c->variance = m2[j] / n;
+        c->ecartType = sqrt(c->variance);
+        c->min = total.min[j];
+        c->max = total.max[j];
+    }
+    free(moy);
+    free(m2);
+    free(valeurs);
+
+    ContexteQuantiles cq = { ds, s->colonnes };
+    executerParallele(nbThreads, d, 2, tacheQuantiles, &cq);
+
+    ds->stats = s;
+    return s;
+}
+
+void momentsColonnes(const DataSet *ds, const char *selection, StatColonne *colonnes, int nbThreads) {
+    int d = ds->nbColonne;
+    if (ds->n == 0 || d == 0) return;
+    Accumulateur total;
+    double *valeurs = accumuler(ds, selection, 1, 0, nbThreads, &total);
+    int n = total.effectif[0] > 0 ? total.effectif[0] : 1;
+    for (int j = 0; j < d; j++) {
+        StatColonne *c = &colonnes[j];
+        c->moyenne = total.moyenne[j];
+        c->variance = total.m2[j] / n;
+        c->ecartType = sqrt(c->variance);
+        c->min = total.min[j];
+        c->max = total.max[j];
+    }
+    free(valeurs);
+}
@@ -0,0 +1,45 @@
+#ifndef STATISTIQUES_H_
+#define STATISTIQUES_H_
+
+#include "dataSet.h"
+
+// résumé d'une colone (variance et écart-type "population", divisés par n).
+// quartiles par interpolation linéaire, la médiane est la moyenne des deux
+// valeurs centrales quand n est pair.
+typedef struct {
+    double moyenne;
+    double variance;
+    double ecartType;
+    double min;
+    double max;
+    double q1;
+    double mediane;
+    double q3;
+} StatColonne;
+
+typedef struct StatistiquesDataSet {
+    int n;
+    int nbColonne;
+    int nbClasses;
+    StatColonne *colonnes;
+    // par classe : effectif, puis moyenne et écart-type de chaque colone (nbClasses x nbColonne).
+    int *effectifClasse;
+    double *moyenneClasse;
+    double *ecartTypeClasse;
+} StatistiquesDataSet;
+
+// statistiques de toutes les colones, calculées au premier apel puis gardées dans le dataset.
+// un seul parcours des lignes par blocs (welford par classe, fusion de chan), réparti sur
+// nbThreads (0 = un par coeur). le découpage ne dépend que de la taille des données :
+// le résultat est le meme quel que soit le nombre de threads. NULL pour un dataset creux.
+const StatistiquesDataSet *statistiquesDataSet(DataSet *ds, int nbThreads);
+
+// moyenne, variance, écart-type, min et max de chaque colone (sans les quantiles) sur les
+// lignes i où selection[i] est vrai (toutes si selection est NULL) : le meme parcours par
+// blocs, dans l'ordre des lignes, sans distinguer les classes. colonnes a nbColonne cases.
+void momentsColonnes(const DataSet *ds, const char *selection, StatColonne *colonnes, int nbThreads);
+
+// à apeler après toute modification de donnees ou etiquettes.
+void invaliderStatistiques(DataSet *ds);
+
+#endif //STATISTIQUES_H_
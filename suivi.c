@@ -0,0 +1,69 @@
+#include "suivi.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+SuiviEntrainement *creerSuivi(int capacite) {
+    if (capacite < 1) capacite = 1;
+    SuiviEntrainement *s = calloc(1, sizeof(SuiviEntrainement));
+    int *historique = malloc(sizeof(int) * 2 * (size_t)capacite);
+    if (!s || !historique) {
+        printf("Erreur : memoire insuffisante pour le suivi\n");
+        exit(1);
+    }
+    s->capacite = capacite;
+    s->erreursTrain = historique;
+    s->erreursValidation = historique + capacite;
+    reinitialiserSuivi(s);
+    return s;
+}
+
+void libererSuivi(SuiviEntrainement *s) {
+    if (!s) return;
+    free(s->erreursTrain);
+    free(s);
+}
+
+void reinitialiserSuivi(SuiviEntrainement *s) {
+    __atomic_store_n(&s->nbEpoques, 0, __ATOMIC_RELEASE);
+    s->nValidation = 0;
+    s->meilleureEpoque = -1;
+    s->meilleuresErreurs = -1;
+    s->raisonArret = ARRET_EPOQUES;
+    s->duree = 0;
+}
+
+void enregistrerEpoque(SuiviEntrainement *s, int erreursTrain, int erreursValidation) {
+    int e = s->nbEpoques;
+    s->erreursTrain[e % s->capacite] = erreursTrain;
+    s->erreursValidation[e % s->capacite] = erreursValidation;
+    __atomic_store_n(&s->nbEpoques, e + 1, __ATOMIC_RELEASE);
+}
+
+int epoquesTerminees(const SuiviEntrainement *s) {
+    return __atomic_load_n(&s->nbEpoques, __ATOMIC_ACQUIRE);
+}
+
+// pendant un entrainement, la plus ancienne des époques copiées peut déjà avoir été
+// réécrite si n est proche de capacite : les lecteurs demandent moins que la capacité.
+int lireHistorique(const SuiviEntrainement *s, int *train, int *validation, int n, int *premiere) {
+    int total = epoquesTerminees(s);
+    if (n > total) n = total;
+    if (n > s->capacite) n = s->capacite;
+    int debut = total - n;
+    for (int i = 0; i < n; i++) {
+        int idx = (debut + i) % s->capacite;
+        train[i] = s->erreursTrain[idx];
+        if (validation) validation[i] = s->erreursValidation[idx];
+    }
+    if (premiere) *premiere = debut;
+    return n;
+}
+
+const char *nomArret(int raison) {
+    switch (raison) {
+        case ARRET_CONVERGE: return "converge";
+        case ARRET_PATIENCE: return "patience";
+        case ARRET_BUDGET: return "budget de temps";
+        default: return "epoques";
+    }
+}
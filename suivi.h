@@ -0,0 +1,61 @@
+#ifndef SUIVI_H_
+#define SUIVI_H_
+
+// raison de la fin d'un entrainement suivi.
+#define ARRET_EPOQUES 0    // toutes les époques ont été faites
+#define ARRET_CONVERGE 1   // plus aucune erreur sur les lignes d'entrainement
+#define ARRET_PATIENCE 2   // pas d'amélioration depuis patience époques
+#define ARRET_BUDGET 3     // budget de temps épuisé
+
+// controle de la convergence d'un entrainement et historique de ses erreurs.
+// les réglages sont lus au début de l'entrainement, le reste est écrit par la boucle.
+typedef struct SuiviEntrainement {
+    // arret si la mesure ne s'améliore pas pendant patience époques (0 = jamais).
+    int patience;
+    // arret après ce nombre de secondes, vérifié en fin d'époque (0 = sans limite).
+    double budgetSecondes;
+    // part des lignes du train mise de coté pour la validation (0 = aucune). la mesure
+    // suivie devient alors les erreurs de validation et les poids de la meilleure
+    // époque sont remis à la fin.
+    double partValidation;
+
+    // historique circulaire préalloué : l'époque e (à partir de 0) est rangée à
+    // l'indice e % capacite. erreursValidation vaut -1 sans validation. en multi-classe,
+    // erreursTrain est la somme des erreurs des experts et la validation compte les
+    // lignes mal classées par l'ensemble.
+    int capacite;
+    int *erreursTrain;
+    int *erreursValidation;
+    // époques terminées : publié après l'écriture de l'historique, lisible depuis un
+    // autre thread pendant l'entrainement (lireHistorique).
+    int nbEpoques;
+
+    // résultat.
+    int nValidation;
+    int meilleureEpoque;          // époque dont les poids sont gardés (la derniere si converge)
+    int meilleuresErreurs;
+    int raisonArret;
+    double duree;
+} SuiviEntrainement;
+
+// suivi avec un historique de capacite époques, sans arret anticipé par défaut.
+SuiviEntrainement *creerSuivi(int capacite);
+void libererSuivi(SuiviEntrainement *s);
+
+// remet l'historique et le résultat à zéro (les réglages sont gardés).
+void reinitialiserSuivi(SuiviEntrainement *s);
+
+// écrit une époque dans l'historique puis la publie.
+void enregistrerEpoque(SuiviEntrainement *s, int erreursTrain, int erreursValidation);
+
+// époques terminées jusqu'ici (lecture sans verrou).
+int epoquesTerminees(const SuiviEntrainement *s);
+
+// copie les n dernières époques au plus, de la plus ancienne à la plus récente.
+// validation peut etre NULL. retourne le nombre d'époques copiées et range dans
+// *premiere le numéro de la premiere (si premiere n'est pas NULL).
+int lireHistorique(const SuiviEntrainement *s, int *train, int *validation, int n, int *premiere);
+
+const char *nomArret(int raison);
+
+#endif //SUIVI_H_
@@ -1,10 +1,11 @@
 #include "visual.h"
 #include "raylib.h"
-#include <float.h>
+#include "raster.h"
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <dirent.h>
+#include <string.h>
+#include <time.h>
 
 // ==================== UTILITAIRES ====================
 
@@ -22,59 +23,6 @@ static Color classColor(int c, bool light) {
     return (Color){ base.r, base.g, base.b, 70 };
 }
 
-static double calculerSommePonderee(const Perceptron *p, const double *entree) {
-    double somme = 0;
-    for (int i = 0; i < p->nPoids; i++) {
-        somme += p->poids[i] * entree[i];
-    }
-    somme += p->biais;
-    return somme;
-}
-
-// ==================== CALCUL DU CENTRE DE MASSE ====================
-
-static double* calculerCentreMasse(const DataSet *ds) {
-    double *centerPoint = malloc(ds->nbColonne * sizeof(double));
-
-    for(int j = 0; j < ds->nbColonne; j++) {
-        double somme = 0;
-        for(int i = 0; i < ds->nTrain; i++) {
-            somme += ds->tab_Train[i][j];
-        }
-        centerPoint[j] = somme / ds->nTrain;
-    }
-
-    return centerPoint;
-}
-
-// ==================== CALCUL DES BORNES ====================
-
-static void calculerBornes(const DataSet *ds, int colX, int colY,
-                          double *minX, double *maxX, double *minY, double *maxY) {
-    *minX = DBL_MAX;
-    *maxX = -DBL_MAX;
-    *minY = DBL_MAX;
-    *maxY = -DBL_MAX;
-
-    for (int i = 0; i < ds->nTrain; i++) {
-        double valX = ds->tab_Train[i][colX];
-        double valY = ds->tab_Train[i][colY];
-
-        if (valX < *minX) *minX = valX;
-        if (valX > *maxX) *maxX = valX;
-        if (valY < *minY) *minY = valY;
-        if (valY > *maxY) *maxY = valY;
-    }
-
-    // Ajout d'une marge de 15%
-    double spanX = *maxX - *minX;
-    double spanY = *maxY - *minY;
-    *minX -= spanX * 0.15;
-    *maxX += spanX * 0.15;
-    *minY -= spanY * 0.15;
-    *maxY += spanY * 0.15;
-}
-
 // ==================== ANALYSE DES POIDS ====================
 
 static void analyserPoids(const Perceptron *p, const DataSet *ds, int colX, int colY) {
@@ -107,35 +55,24 @@ static void analyserPoids(const Perceptron *p, const DataSet *ds, int colX, int
     printf("==========================================\n\n");
 }
 
-// ==================== CALCUL ACCURACY 2D ====================
+// ==================== ERREURS SUR LA PROJECTION 2D ====================
 
-static double calculerAccuracy2D(const DataSet *ds, const Perceptron *p,
-                                 int colX, int colY, double *centerPoint, int *nbCorrect) {
-    double *inputSimule = malloc(ds->nbColonne * sizeof(double));
-    int correct = 0;
+// marque les points du train mal classés dans la projection (colX / colY réels,
+// autres colones au centre de masse) en une seule prédiction par lots.
+// retourne le nombre de points bien classés.
+static int calculerErreurs2D(const DataSet *ds, const Perceptron *p,
+                             int colX, int colY, const double *centerPoint, unsigned char *malClasses) {
+    int *pred = malloc(ds->nTrain * sizeof(int));
+    Perceptron *modele = (Perceptron *)p;
+    predireProjection(&modele, 1, colX, colY, centerPoint, ds, ds->indexSplit, ds->nTrain, pred);
 
+    int correct = 0;
     for(int i = 0; i < ds->nTrain; i++) {
-        // Initialiser avec le centre de masse
-        for(int k = 0; k < ds->nbColonne; k++) {
-            inputSimule[k] = centerPoint[k];
-        }
-
-        // Injecter les valeurs des 2 axes choisis
-        inputSimule[colX] = ds->tab_Train[i][colX];
-        inputSimule[colY] = ds->tab_Train[i][colY];
-
-        // Prédire
-        double score = calculerSommePonderee(p, inputSimule);
-        int pred = (score >= 0) ? 1 : 0;
-
-        if(pred == ds->sortieAttendue_train[i]) {
-            correct++;
-        }
+        malClasses[i] = pred[i] != ds->sortieAttendue_train[i];
+        if(!malClasses[i]) correct++;
     }
-
-    free(inputSimule);
-    *nbCorrect = correct;
-    return (double)correct / ds->nTrain * 100.0;
+    free(pred);
+    return correct;
 }
 
 // ==================== VÉRIFIER VISIBILITÉ FRONTIÈRE ====================
@@ -182,36 +119,13 @@ static bool frontiereEstVisible(const Perceptron *p, int colX, int colY,
 
 // ==================== RENDU ZONES DE DÉCISION ====================
 
-static void dessinerZonesDecision(const Perceptron *p, int colX, int colY,
-                                  double *centerPoint, int nbColonne,
-                                  double minX, double maxX, double minY, double maxY,
-                                  int W, int H) {
-    double *inputSimule = malloc(nbColonne * sizeof(double));
-
-    for (int px = 0; px < W; px += 4) {
-        for (int py = 0; py < H; py += 4) {
-            // Conversion pixel -> valeurs mathématiques
-            double xVal = minX + (maxX - minX) * px / W;
-            double yVal = maxY - (maxY - minY) * py / H;
-
-            // Initialiser avec centre de masse
-            for(int k = 0; k < nbColonne; k++) {
-                inputSimule[k] = centerPoint[k];
-            }
-
-            // Injecter les valeurs des axes
-            inputSimule[colX] = xVal;
-            inputSimule[colY] = yVal;
-
-            // Calculer la prédiction
-            double score = calculerSommePonderee(p, inputSimule);
-            int pred = (score >= 0) ? 1 : 0;
-
-            DrawRectangle(px, py, 4, 4, classColor(pred, true));
+static void dessinerZonesDecision(const ImageDecision *img, int tailleCase) {
+    for (int py = 0; py < img->hauteur; py++) {
+        const int *labels = img->labels + (size_t)py * (size_t)img->largeur;
+        for (int px = 0; px < img->largeur; px++) {
+            DrawRectangle(px * tailleCase, py * tailleCase, tailleCase, tailleCase, classColor(labels[px], true));
         }
     }
-
-    free(inputSimule);
 }
 
 // ==================== TRACÉ FRONTIÈRE ====================
@@ -273,54 +187,28 @@ static void tracerFrontiere(const Perceptron *p, int colX, int colY,
     }
 }
 
-void listerFichiersDataSet() {
-    struct dirent *lecture;
-    DIR *rep = opendir("DataSet");
-    printf("\n--- FICHIERS DISPONIBLES DANS /DataSet ---\n");
-    if (rep == NULL) {
-        printf("[!] Dossier 'DataSet' introuvable.\n");
-        return;
-    }
-    int count = 0;
-    while ((lecture = readdir(rep))) {
-        printf(" -> %s\n", lecture->d_name);
-        count++;
-    }
-    if (count == 0) printf(" (Aucun DataSet trouvé)\n");
-    printf("------------------------------------------\n");
-    closedir(rep);
-}
-
 // ==================== DESSIN DES POINTS ====================
 
-static void dessinerPoints(const DataSet *ds, const Perceptron *p,
-                          int colX, int colY, double *centerPoint,
+// au dela de ce nombre de points, le nuage est dessiné comme une grille de densité.
+#define SEUIL_POINTS_LOD 20000
+#define CASE_LOD 4
+
+static void dessinerPoints(const DataSet *ds, const unsigned char *malClasses,
+                          int colX, int colY,
                           double minX, double maxX, double minY, double maxY,
                           int W, int H) {
-    double *inputSimule = malloc(ds->nbColonne * sizeof(double));
-
     for (int i = 0; i < ds->nTrain; i++) {
         // Position écran
-        int sx = (int)((ds->tab_Train[i][colX] - minX) / (maxX - minX) * W);
-        int sy = (int)((maxY - ds->tab_Train[i][colY]) / (maxY - minY) * H);
-
-        // Vérifier si mal classé
-        for(int k = 0; k < ds->nbColonne; k++) {
-            inputSimule[k] = centerPoint[k];
-        }
-        inputSimule[colX] = ds->tab_Train[i][colX];
-        inputSimule[colY] = ds->tab_Train[i][colY];
-
-        double score = calculerSommePonderee(p, inputSimule);
-        int pred = (score >= 0) ? 1 : 0;
-        bool malClasse = (pred != ds->sortieAttendue_train[i]);
+        const double *ligne = ligneTrain(ds, i);
+        int sx = (int)((ligne[colX] - minX) / (maxX - minX) * W);
+        int sy = (int)((maxY - ligne[colY]) / (maxY - minY) * H);
 
         // Dessiner le point
         int label = ds->sortieAttendue_train[i];
         DrawCircle(sx, sy, 6, classColor(label, false));
 
         // Cercle rouge pour erreurs
-        if(malClasse) {
+        if(malClasses[i]) {
             DrawCircleLines(sx, sy, 6, RED);
             DrawCircleLines(sx, sy, 7, RED);
             DrawCircleLines(sx, sy, 8, Fade(RED, 0.5f));
@@ -328,31 +216,197 @@ static void dessinerPoints(const DataSet *ds, const Perceptron *p,
             DrawCircleLines(sx, sy, 6, BLACK);
         }
     }
+}
+
+// niveau de détail pour les gros nuages : les points sont comptés par case de
+// CASE_LOD pixels et par classe. chaque case prend la couleur de sa classe majoritaire,
+// plus opaque quand elle est dense, et un carré rouge dont l'opacité suit la part d'erreurs.
+static void dessinerDensite(const DataSet *ds, const unsigned char *malClasses,
+                            int colX, int colY,
+                            double minX, double maxX, double minY, double maxY,
+                            int W, int H) {
+    int gw = (W + CASE_LOD - 1) / CASE_LOD;
+    int gh = (H + CASE_LOD - 1) / CASE_LOD;
+    int K = compterClasses(ds);
+    int *comptes = calloc((size_t)gw * gh * K, sizeof(int));
+    int *erreurs = calloc((size_t)gw * gh, sizeof(int));
+    int *totaux = calloc((size_t)gw * gh, sizeof(int));
 
-    free(inputSimule);
+    for (int i = 0; i < ds->nTrain; i++) {
+        const double *ligne = ligneTrain(ds, i);
+        int sx = (int)((ligne[colX] - minX) / (maxX - minX) * W);
+        int sy = (int)((maxY - ligne[colY]) / (maxY - minY) * H);
+        int label = ds->sortieAttendue_train[i];
+        if (sx < 0 || sx >= W || sy < 0 || sy >= H || label < 0 || label >= K) continue;
+        size_t cellule = (size_t)(sy / CASE_LOD) * gw + (size_t)(sx / CASE_LOD);
+        comptes[cellule * K + label]++;
+        totaux[cellule]++;
+        erreurs[cellule] += malClasses[i];
+    }
+
+    int maxTotal = 1;
+    for (size_t c = 0; c < (size_t)gw * gh; c++) if (totaux[c] > maxTotal) maxTotal = totaux[c];
+    double echelle = log1p((double)maxTotal);
+
+    for (int cy = 0; cy < gh; cy++) {
+        for (int cx = 0; cx < gw; cx++) {
+            size_t cellule = (size_t)cy * gw + cx;
+            if (totaux[cellule] == 0) continue;
+            const int *parClasse = comptes + cellule * K;
+            int majoritaire = 0;
+            for (int k = 1; k < K; k++) if (parClasse[k] > parClasse[majoritaire]) majoritaire = k;
+
+            float alpha = 0.35f + 0.65f * (float)(log1p((double)totaux[cellule]) / echelle);
+            DrawRectangle(cx * CASE_LOD, cy * CASE_LOD, CASE_LOD, CASE_LOD,
+                          Fade(classColor(majoritaire, false), alpha));
+            if (erreurs[cellule] > 0) {
+                DrawRectangle(cx * CASE_LOD + 1, cy * CASE_LOD + 1, CASE_LOD - 2, CASE_LOD - 2,
+                              Fade(RED, (float)erreurs[cellule] / totaux[cellule]));
+            }
+        }
+    }
+
+    free(comptes);
+    free(erreurs);
+    free(totaux);
+}
+
+// ==================== CACHE DU RENDU ====================
+// zones, frontiere et points ne changent pas d'une image à l'autre : ils sont dessinés
+// une fois dans une texture, reconstruite seulement si le modele, les colones
+// ou la taille de la fenetre changent.
+
+typedef struct {
+    RenderTexture2D cible;
+    ImageDecision *zones;
+    int W, H;
+    int colX, colY;
+    unsigned long long empreinte;
+    bool valide;
+    // durée de la derniere reconstruction, en millisecondes.
+    double dureeReconstruction;
+    // points du train mal classés dans la projection, pour le modele d'empreinte empreinteErreurs.
+    unsigned char *malClasses;
+    int nbCorrect;
+    unsigned long long empreinteErreurs;
+} CacheRendu;
+
+// empreinte fnv-1a du biais et des poids : détecte un modele modifié sur place.
+static unsigned long long empreinteModele(const Perceptron *p) {
+    unsigned long long h = 1469598103934665603ULL;
+    const unsigned char *octets = (const unsigned char *)&p->biais;
+    for (size_t i = 0; i < sizeof(double); i++) h = (h ^ octets[i]) * 1099511628211ULL;
+    octets = (const unsigned char *)p->poids;
+    for (size_t i = 0; i < sizeof(double) * (size_t)p->nPoids; i++) h = (h ^ octets[i]) * 1099511628211ULL;
+    return h;
+}
+
+// recalcule les erreurs seulement si le modele a changé depuis le dernier calcul.
+static void mettreAJourErreurs(CacheRendu *c, const DataSet *ds, const Perceptron *p, int colX, int colY,
+                               const double *centerPoint) {
+    unsigned long long empreinte = empreinteModele(p);
+    if (c->malClasses && c->empreinteErreurs == empreinte) return;
+    if (!c->malClasses) c->malClasses = malloc(ds->nTrain);
+    c->nbCorrect = calculerErreurs2D(ds, p, colX, colY, centerPoint, c->malClasses);
+    c->empreinteErreurs = empreinte;
+}
+
+static bool cacheAJour(const CacheRendu *c, const Perceptron *p, int colX, int colY, int W, int H) {
+    return c->valide && c->W == W && c->H == H && c->colX == colX && c->colY == colY &&
+           c->empreinte == empreinteModele(p);
+}
+
+static void reconstruireCache(CacheRendu *c, const DataSet *ds, const Perceptron *p, int colX, int colY,
+                              double *centerPoint, double minX, double maxX, double minY, double maxY,
+                              int W, int H) {
+    struct timespec debut, fin;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+
+    // zones de décision en cases de 4x4 pixels.
+    const int CASE = 4;
+    if (!c->valide || c->W != W || c->H != H) {
+        if (c->valide) UnloadRenderTexture(c->cible);
+        libererImageDecision(c->zones);
+        c->cible = LoadRenderTexture(W, H);
+        c->zones = creerImageDecision((W + CASE - 1) / CASE, (H + CASE - 1) / CASE);
+    }
+    Perceptron *modele = (Perceptron *)p;
+    rasteriserDecision(c->zones, &modele, 1, colX, colY, centerPoint, minX, maxX, minY, maxY, 0);
+
+    BeginTextureMode(c->cible);
+    ClearBackground(RAYWHITE);
+    dessinerZonesDecision(c->zones, CASE);
+    tracerFrontiere(p, colX, colY, centerPoint, ds->nbColonne, minX, maxX, minY, maxY, W, H);
+    mettreAJourErreurs(c, ds, p, colX, colY, centerPoint);
+    if (ds->nTrain > SEUIL_POINTS_LOD) dessinerDensite(ds, c->malClasses, colX, colY, minX, maxX, minY, maxY, W, H);
+    else dessinerPoints(ds, c->malClasses, colX, colY, minX, maxX, minY, maxY, W, H);
+    EndTextureMode();
+
+    c->W = W;
+    c->H = H;
+    c->colX = colX;
+    c->colY = colY;
+    c->empreinte = empreinteModele(p);
+    c->valide = true;
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    c->dureeReconstruction = (double)(fin.tv_sec - debut.tv_sec) * 1e3 + (double)(fin.tv_nsec - debut.tv_nsec) * 1e-6;
+}
+
+// nombre d'époques montrées par la courbe d'apprentissage.
+#define EPOQUES_COURBE 256
+
+// erreurs par époque (train en blanc, validation en orange) lues dans l'historique du suivi,
+// chaque courbe est ramenée à la hauteur du cadre.
+static void dessinerCourbeErreurs(const SuiviEntrainement *suivi, int x, int y, int w, int h) {
+    static int train[EPOQUES_COURBE], validation[EPOQUES_COURBE];
+    int premiere;
+    int n = lireHistorique(suivi, train, validation, EPOQUES_COURBE, &premiere);
+    if (n == 0) return;
+    int maxErreurs = 1;
+    for (int i = 0; i < n; i++) {
+        if (train[i] > maxErreurs) maxErreurs = train[i];
+        if (validation[i] > maxErreurs) maxErreurs = validation[i];
+    }
+    DrawRectangle(x, y, w, h + 20, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("Erreurs par epoque (%d a %d), arret : %s", premiere + 1, premiere + n,
+                        nomArret(suivi->raisonArret)), x + 5, y + 3, 12, LIGHTGRAY);
+    int bas = y + h + 15;
+    for (int i = 1; i < n; i++) {
+        int x0 = x + 5 + (i - 1) * (w - 10) / (n > 1 ? n - 1 : 1);
+        int x1 = x + 5 + i * (w - 10) / (n > 1 ? n - 1 : 1);
+        DrawLine(x0, bas - train[i - 1] * (h - 5) / maxErreurs, x1, bas - train[i] * (h - 5) / maxErreurs, WHITE);
+        if (validation[i] >= 0) {
+            DrawLine(x0, bas - validation[i - 1] * (h - 5) / maxErreurs, x1,
+                     bas - validation[i] * (h - 5) / maxErreurs, ORANGE);
+        }
+    }
 }
 
 // ==================== FONCTION PRINCIPALE ====================
 
-void visual_run_with_model_custom(const DataSet *ds, const Perceptron *p, int colX, int colY) {
+void visual_run_with_model_custom(const DataSet *ds, const Perceptron *p, int colX, int colY,
+                                  const SuiviEntrainement *suivi) {
     if (ds->nTrain <= 0) return;
 
-    const int W = 1000, H = 700;
-    if (!IsWindowReady()) InitWindow(W, H, "Neural Engine - 2D Projection");
+    if (!IsWindowReady()) {
+        SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+        InitWindow(1000, 700, "Neural Engine - 2D Projection");
+    }
     SetTargetFPS(60);
 
     // ===== ÉTAPE 1: CALCULS PRÉPARATOIRES =====
-    double *centerPoint = calculerCentreMasse(ds);
-
+    double *centerPoint = malloc(ds->nbColonne * sizeof(double));
     double minX, maxX, minY, maxY;
-    calculerBornes(ds, colX, colY, &minX, &maxX, &minY, &maxY);
+    cadrerDecision(ds, colX, colY, centerPoint, &minX, &maxX, &minY, &maxY);
 
     // ===== ÉTAPE 2: DIAGNOSTIC =====
     analyserPoids(p, ds, colX, colY);
 
-    int nbCorrect;
-    double accuracy2D = calculerAccuracy2D(ds, p, colX, colY, centerPoint, &nbCorrect);
-    printf("Accuracy sur projection 2D: %.1f%% (%d/%d)\n\n", accuracy2D, nbCorrect, ds->nTrain);
+    CacheRendu cache;
+    memset(&cache, 0, sizeof(cache));
+    mettreAJourErreurs(&cache, ds, p, colX, colY, centerPoint);
+    printf("Accuracy sur projection 2D: %.1f%% (%d/%d)\n\n",
+           (double)cache.nbCorrect / ds->nTrain * 100.0, cache.nbCorrect, ds->nTrain);
 
     bool frontiereVisible = frontiereEstVisible(p, colX, colY, centerPoint, ds->nbColonne,
                                                 minX, maxX, minY, maxY);
@@ -368,34 +422,46 @@ void visual_run_with_model_custom(const DataSet *ds, const Perceptron *p, int co
 
     // ===== ÉTAPE 3: BOUCLE DE RENDU =====
     while (!WindowShouldClose()) {
+        int W = GetScreenWidth(), H = GetScreenHeight();
+        // fenetre réduite : rien à reconstruire tant qu'elle n'a pas de taille.
+        if (W > 0 && H > 0 && !cacheAJour(&cache, p, colX, colY, W, H)) {
+            reconstruireCache(&cache, ds, p, colX, colY, centerPoint, minX, maxX, minY, maxY, W, H);
+        }
+
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
-        // Rendu zones de décision
-        dessinerZonesDecision(p, colX, colY, centerPoint, ds->nbColonne,
-                             minX, maxX, minY, maxY, W, H);
-
-        // Tracé frontière
-        tracerFrontiere(p, colX, colY, centerPoint, ds->nbColonne,
-                       minX, maxX, minY, maxY, W, H);
-
-        // Dessin des points
-        dessinerPoints(ds, p, colX, colY, centerPoint, minX, maxX, minY, maxY, W, H);
+        // zones, frontière et points depuis le cache (texture retournée verticalement).
+        if (cache.valide) {
+            DrawTextureRec(cache.cible.texture, (Rectangle){ 0, 0, (float)cache.W, (float)-cache.H },
+                           (Vector2){ 0, 0 }, WHITE);
+        }
 
         // ===== INTERFACE =====
-        DrawRectangle(10, 10, 520, 95, Fade(BLACK, 0.75f));
+        DrawRectangle(10, 10, 520, 115, Fade(BLACK, 0.75f));
         DrawText(TextFormat("AXES: [%s] vs [%s]", ds->nomColonne[colX], ds->nomColonne[colY]),
                  20, 20, 18, WHITE);
 
+        double accuracy2D = (double)cache.nbCorrect / ds->nTrain * 100.0;
         Color accuracyColor = accuracy2D > 90 ? GREEN : (accuracy2D > 70 ? ORANGE : RED);
-        DrawText(TextFormat("Accuracy 2D: %.1f%% (%d/%d)", accuracy2D, nbCorrect, ds->nTrain),
+        DrawText(TextFormat("Accuracy 2D: %.1f%% (%d/%d)", accuracy2D, cache.nbCorrect, ds->nTrain),
                  20, 45, 18, accuracyColor);
 
         Color importanceColor = importanceVisible > 70 ? GREEN : (importanceVisible > 40 ? ORANGE : RED);
         DrawText(TextFormat("Importance visible: %.1f%%", importanceVisible),
                  20, 65, 16, importanceColor);
 
-        DrawText("Cercle rouge = mal classe", 20, 85, 14, LIGHTGRAY);
+        if (ds->nTrain > SEUIL_POINTS_LOD) {
+            DrawText(TextFormat("Densite (%d points) : rouge = part d'erreurs", ds->nTrain), 20, 85, 14, LIGHTGRAY);
+        } else {
+            DrawText("Cercle rouge = mal classe", 20, 85, 14, LIGHTGRAY);
+        }
+
+        DrawText(TextFormat("Frame: %.2f ms | Cache reconstruit en %.1f ms",
+                            GetFrameTime() * 1000.0f, cache.dureeReconstruction),
+                 20, 105, 14, LIGHTGRAY);
+
+        if (suivi) dessinerCourbeErreurs(suivi, 10, H - 110, 360, 80);
 
         if(!frontiereVisible) {
             DrawRectangle(W - 310, 10, 300, 40, Fade(RED, 0.8f));
@@ -406,6 +472,9 @@ void visual_run_with_model_custom(const DataSet *ds, const Perceptron *p, int co
     }
 
     // ===== NETTOYAGE =====
+    if (cache.valide) UnloadRenderTexture(cache.cible);
+    libererImageDecision(cache.zones);
+    free(cache.malClasses);
     free(centerPoint);
     CloseWindow();
 }
\ No newline at end of file
@@ -9,7 +9,8 @@ void visual_run(const DataSet *ds);
 
 // Scatter + frontière de décision (final)
 void visual_run_with_model(const DataSet *ds, const Perceptron *p);
-void visual_run_with_model_custom(const DataSet *ds, const Perceptron *p, int colX, int colY);
-void listerFichiersDataSet();
+// suivi peut etre NULL : sinon la courbe des erreurs du dernier entrainement est affichée.
+void visual_run_with_model_custom(const DataSet *ds, const Perceptron *p, int colX, int colY,
+                                  const SuiviEntrainement *suivi);
 
 #endif //VISUAL_H_
\ No newline at end of file